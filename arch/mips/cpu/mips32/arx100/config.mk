@@ -20,13 +20,19 @@ ifndef CONFIG_SPL_BUILD
 ifdef CONFIG_SYS_BOOT_SFSPL
 ALL-y += $(obj)u-boot.ltq.sfspl
 ALL-$(CONFIG_SPL_LZO_SUPPORT) += $(obj)u-boot.ltq.lzo.sfspl
+ALL-$(CONFIG_SPL_LZMA_SUPPORT) += $(obj)u-boot.ltq.lzma.sfspl
+ALL-$(CONFIG_SPL_GZIP_SUPPORT) += $(obj)u-boot.ltq.gz.sfspl
 endif
 ifdef CONFIG_SYS_BOOT_NORSPL
 ALL-y += $(obj)u-boot.ltq.norspl
 ALL-$(CONFIG_SPL_LZO_SUPPORT) += $(obj)u-boot.ltq.lzo.norspl
+ALL-$(CONFIG_SPL_LZMA_SUPPORT) += $(obj)u-boot.ltq.lzma.norspl
+ALL-$(CONFIG_SPL_GZIP_SUPPORT) += $(obj)u-boot.ltq.gz.norspl
 endif
 ifdef CONFIG_SYS_BOOT_NANDSPL
 ALL-y += $(obj)u-boot.ltq.nandspl
 ALL-$(CONFIG_SPL_LZO_SUPPORT) += $(obj)u-boot.ltq.lzo.nandspl
+ALL-$(CONFIG_SPL_LZMA_SUPPORT) += $(obj)u-boot.ltq.lzma.nandspl
+ALL-$(CONFIG_SPL_GZIP_SUPPORT) += $(obj)u-boot.ltq.gz.nandspl
 endif
 endif
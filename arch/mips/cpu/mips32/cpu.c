@@ -8,6 +8,8 @@
 #include <common.h>
 #include <command.h>
 #include <netdev.h>
+#include <malloc.h>
+#include <asm/addrspace.h>
 #include <asm/mipsregs.h>
 #include <asm/cacheops.h>
 #include <asm/reboot.h>
@@ -28,6 +30,7 @@ void __attribute__((weak)) _machine_restart(void)
 
 int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
+	console_flush();
 	_machine_restart();
 
 	fprintf(stderr, "*** reset failed ***\n");
@@ -70,20 +73,120 @@ static inline unsigned long dcache_line_size(void)
 
 #endif /* !CONFIG_SYS_CACHELINE_SIZE */
 
+#ifdef CONFIG_SYS_ICACHE_SIZE
+static inline unsigned long icache_size(void)
+{
+	return CONFIG_SYS_ICACHE_SIZE;
+}
+#else
+static inline unsigned long icache_size(void)
+{
+	unsigned long conf1, sets, ways;
+
+	conf1 = read_c0_config1();
+	sets = (conf1 & MIPS_CONF1_IS) >> MIPS_CONF1_IS_SHIFT;
+	sets = (sets == 7) ? 32 : 64 << sets;
+	ways = ((conf1 & MIPS_CONF1_IA) >> MIPS_CONF1_IA_SHIFT) + 1;
+
+	return sets * ways * icache_line_size();
+}
+#endif
+
+#ifdef CONFIG_SYS_DCACHE_SIZE
+static inline unsigned long dcache_size(void)
+{
+	return CONFIG_SYS_DCACHE_SIZE;
+}
+#else
+static inline unsigned long dcache_size(void)
+{
+	unsigned long conf1, sets, ways;
+
+	conf1 = read_c0_config1();
+	sets = (conf1 & MIPS_CONF1_DS) >> MIPS_CONF1_DS_SHIFT;
+	sets = (sets == 7) ? 32 : 64 << sets;
+	ways = ((conf1 & MIPS_CONF1_DA) >> MIPS_CONF1_DA_SHIFT) + 1;
+
+	return sets * ways * dcache_line_size();
+}
+#endif
+
+/*
+ * Ranges of at least this size are handled by walking the whole cache by
+ * index instead of issuing one hit operation per line of the range. By
+ * default this is the cache size, where both need the same number of
+ * cache ops; 'cachebench' shows the actual crossover.
+ */
+static inline unsigned long icache_op_threshold(void)
+{
+#ifdef CONFIG_SYS_MIPS_CACHE_OP_THRESHOLD
+	return CONFIG_SYS_MIPS_CACHE_OP_THRESHOLD;
+#else
+	return icache_size();
+#endif
+}
+
+static inline unsigned long dcache_op_threshold(void)
+{
+#ifdef CONFIG_SYS_MIPS_CACHE_OP_THRESHOLD
+	return CONFIG_SYS_MIPS_CACHE_OP_THRESHOLD;
+#else
+	return dcache_size();
+#endif
+}
+
+void invalidate_icache_all(void)
+{
+	unsigned long lsize = icache_line_size();
+	unsigned long addr = CKSEG0;
+	unsigned long aend = CKSEG0 + icache_size();
+
+	for (; addr < aend; addr += lsize)
+		cache_op(INDEX_INVALIDATE_I, addr);
+}
+
+void flush_dcache_all(void)
+{
+	unsigned long lsize = dcache_line_size();
+	unsigned long addr = CKSEG0;
+	unsigned long aend = CKSEG0 + dcache_size();
+
+	for (; addr < aend; addr += lsize)
+		cache_op(INDEX_WRITEBACK_INV_D, addr);
+}
+
+static void flush_dcache_lines(ulong start_addr, ulong stop)
+{
+	unsigned long lsize = dcache_line_size();
+	unsigned long addr = start_addr & ~(lsize - 1);
+	unsigned long aend = (stop - 1) & ~(lsize - 1);
+
+	while (1) {
+		cache_op(HIT_WRITEBACK_INV_D, addr);
+		if (addr == aend)
+			break;
+		addr += lsize;
+	}
+}
+
 void flush_cache(ulong start_addr, ulong size)
 {
 	unsigned long ilsize = icache_line_size();
 	unsigned long dlsize = dcache_line_size();
 	unsigned long addr, aend;
+	int iall, dall;
 
 	/* aend will be miscalculated when size is zero, so we return here */
 	if (size == 0)
 		return;
 
+	iall = size >= icache_op_threshold();
+	dall = size >= dcache_op_threshold();
+
 	addr = start_addr & ~(dlsize - 1);
 	aend = (start_addr + size - 1) & ~(dlsize - 1);
 
-	if (ilsize == dlsize) {
+	if (ilsize == dlsize && !iall && !dall) {
 		/* flush I-cache & D-cache simultaneously */
 		while (1) {
 			cache_op(HIT_WRITEBACK_INV_D, addr);
@@ -96,14 +199,17 @@ void flush_cache(ulong start_addr, ulong size)
 	}
 
 	/* flush D-cache */
-	while (1) {
-		cache_op(HIT_WRITEBACK_INV_D, addr);
-		if (addr == aend)
-			break;
-		addr += dlsize;
-	}
+	if (dall)
+		flush_dcache_all();
+	else
+		flush_dcache_lines(start_addr, start_addr + size);
 
 	/* flush I-cache */
+	if (iall) {
+		invalidate_icache_all();
+		return;
+	}
+
 	addr = start_addr & ~(ilsize - 1);
 	aend = (start_addr + size - 1) & ~(ilsize - 1);
 	while (1) {
@@ -116,16 +222,10 @@ void flush_cache(ulong start_addr, ulong size)
 
 void flush_dcache_range(ulong start_addr, ulong stop)
 {
-	unsigned long lsize = dcache_line_size();
-	unsigned long addr = start_addr & ~(lsize - 1);
-	unsigned long aend = (stop - 1) & ~(lsize - 1);
-
-	while (1) {
-		cache_op(HIT_WRITEBACK_INV_D, addr);
-		if (addr == aend)
-			break;
-		addr += lsize;
-	}
+	if (stop - start_addr >= dcache_op_threshold())
+		flush_dcache_all();
+	else
+		flush_dcache_lines(start_addr, stop);
 }
 
 void invalidate_dcache_range(ulong start_addr, ulong stop)
@@ -134,6 +234,17 @@ void invalidate_dcache_range(ulong start_addr, ulong stop)
 	unsigned long addr = start_addr & ~(lsize - 1);
 	unsigned long aend = (stop - 1) & ~(lsize - 1);
 
+	/*
+	 * There is no index op that only invalidates, so large ranges are
+	 * written back and invalidated like Linux does. The range must not
+	 * hold dirty lines anyway, e.g. a DMA buffer invalidated before
+	 * the transfer.
+	 */
+	if (stop - start_addr >= dcache_op_threshold()) {
+		flush_dcache_all();
+		return;
+	}
+
 	while (1) {
 		cache_op(HIT_INVALIDATE_D, addr);
 		if (addr == aend)
@@ -159,3 +270,73 @@ int cpu_eth_init(bd_t *bis)
 #endif
 	return 0;
 }
+
+#if defined(CONFIG_CMD_CACHE_BENCH) && !defined(CONFIG_SPL_BUILD)
+/*
+ * Time writing back a dirty range line by line against walking the whole
+ * D-cache by index, for ranges from one line up to 'max' bytes.
+ */
+static int do_cachebench(cmd_tbl_t *cmdtp, int flag, int argc,
+			 char * const argv[])
+{
+	unsigned long dsize = dcache_size();
+	unsigned long max = 4 * dsize;
+	unsigned long size, crossover = 0;
+	u32 start, hit, all;
+	u8 *buf;
+
+	if (argc > 1)
+		max = simple_strtoul(argv[1], NULL, 16);
+	if (!max)
+		return CMD_RET_USAGE;
+
+	if (!dsize) {
+		puts("no D-cache\n");
+		return CMD_RET_FAILURE;
+	}
+
+	buf = malloc(max);
+	if (!buf) {
+		puts("out of memory\n");
+		return CMD_RET_FAILURE;
+	}
+
+	printf("I-cache %lu KiB, %lu byte lines, threshold %lu\n",
+	       icache_size() >> 10, icache_line_size(), icache_op_threshold());
+	printf("D-cache %lu KiB, %lu byte lines, threshold %lu\n",
+	       dsize >> 10, dcache_line_size(), dcache_op_threshold());
+	puts("    size       hit     index  (CP0 count ticks)\n");
+
+	for (size = dcache_line_size(); size <= max; size <<= 1) {
+		memset(buf, size, size);
+		start = read_c0_count();
+		flush_dcache_lines((ulong)buf, (ulong)buf + size);
+		hit = read_c0_count() - start;
+
+		memset(buf, size, size);
+		start = read_c0_count();
+		flush_dcache_all();
+		all = read_c0_count() - start;
+
+		printf("%8lu %9u %9u%s\n", size, hit, all,
+		       all < hit ? "  *" : "");
+		if (!crossover && all < hit)
+			crossover = size;
+	}
+
+	free(buf);
+
+	if (crossover)
+		printf("whole-cache flush is faster from %lu bytes\n",
+		       crossover);
+
+	return 0;
+}
+
+U_BOOT_CMD(
+	cachebench,	2,	0,	do_cachebench,
+	"compare per-line and whole-cache D-cache flushes",
+	"[max] - flush dirty ranges of one line up to 'max' (hex) bytes\n"
+	"    line by line and by index, default max is 4x the D-cache"
+);
+#endif
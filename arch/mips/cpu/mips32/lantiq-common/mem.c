@@ -6,8 +6,10 @@
  */
 
 #include <common.h>
+#include <command.h>
 #include <spi_flash.h>
 #include <nand.h>
+#include <linux/stringify.h>
 #include <asm/lantiq/io.h>
 #include <asm/lantiq/mem.h>
 #include <asm/lantiq/spl.h>
@@ -356,6 +358,58 @@ void mc_tune_dump(const struct mc_tune_cfg *cfg)
 	}
 }
 
+void mc_tune_dump_stats(const struct mc_tune_stats *stats)
+{
+	unsigned int i, slice, marginal = 0;
+
+	if (!spl_has_console)
+		return;
+
+	puts("MEM: DDR Echo DLL eye:    ");
+	mc_tune_print(stats->eye[MC_TUNE_EYE_ECHO_DLL][0],
+		stats->eye[MC_TUNE_EYE_ECHO_DLL][1]);
+	puts("MEM: DDR Write DQ eye:    ");
+	mc_tune_print(stats->eye[MC_TUNE_EYE_WRITE_DQ][0],
+		stats->eye[MC_TUNE_EYE_WRITE_DQ][1]);
+	puts("MEM: DDR Read DQ eye:     ");
+	mc_tune_print(stats->eye[MC_TUNE_EYE_READ_DQ][0],
+		stats->eye[MC_TUNE_EYE_READ_DQ][1]);
+
+	for (i = 0; i < MC_TUNE_EYE_COUNT; i++)
+		for (slice = 0; slice < 2; slice++)
+			if (stats->eye[i][slice] < CONFIG_LTQ_MC_TUNE_EYE_MIN)
+				marginal = 1;
+
+	if (marginal)
+		puts("MEM: warning: marginal DDR timing\n");
+
+	if (spl_has_timing)
+		printf("MEM: DDR tuning took %u ms, %u probes, step %u\n",
+			stats->time_ms, stats->probes, stats->step);
+}
+
+/**
+ * Check for a tuning request left in RAM by the mctune command before
+ * the last reset. Returns the requested search step or 0. The request
+ * is consumed.
+ */
+unsigned int mc_tune_requested(void)
+{
+	struct mc_tune_stats *stats = mc_tune_stats_data();
+	unsigned int step;
+
+	if (stats->magic != MC_TUNE_REQUEST_MAGIC)
+		return 0;
+
+	step = stats->step;
+	stats->magic = 0;
+
+	if (step < 1 || step > MC_TUNE_STEP_MAX)
+		return 0;
+
+	return step;
+}
+
 int mc_tune_check(const struct mc_tune_cfg *cfg)
 {
 	u32 crc;
@@ -406,6 +460,11 @@ int mc_tune_store_flash(void)
 		return 0;
 	}
 
+	if (cfg.state == MC_TUNE_VALID_REQUESTED) {
+		debug("MEM:   MC tune data only valid for this boot\n");
+		return 0;
+	}
+
 	debug("MEM:   storing MC tune data to flash\n");
 
 	cfg.state = MC_TUNE_VALID_STORED;
@@ -437,3 +496,96 @@ int mc_tune_store_flash(void)
 
 	return 0;
 }
+
+#if defined(CONFIG_CMD_LTQ_MCTUNE) && !defined(CONFIG_SPL_BUILD)
+static void mc_tune_info(void)
+{
+	static const char * const names[MC_TUNE_EYE_COUNT] = {
+		"Echo DLL", "Write DQ", "Read DQ",
+	};
+	const struct mc_tune_stats *stats = mc_tune_stats_data();
+	struct mc_tune_cfg cfg;
+	unsigned int i, slice;
+	int marginal;
+
+	if (mc_tune_load_ram(&cfg)) {
+		puts("no valid MC tune data in RAM\n");
+		return;
+	}
+
+	printf("state:    %s\n", cfg.state == MC_TUNE_VALID_STORED ?
+		"stored in flash" : cfg.state == MC_TUNE_VALID_REQUESTED ?
+		"requested, not stored in flash" : cfg.state == MC_TUNE_VALID ?
+		"valid" : "invalid");
+	printf("Echo DLL: %02x/%02x\n", cfg.gate_echo_dll_l,
+		cfg.gate_echo_dll_u);
+	printf("Write DQ: %02x/%02x\n", cfg.write_dqs_delay_l,
+		cfg.write_dqs_delay_u);
+	printf("Read DQ:  %02x/%02x\n", cfg.read_dqs_delay_l,
+		cfg.read_dqs_delay_u);
+
+	if (stats->magic != MC_TUNE_STATS_MAGIC) {
+		puts("settings loaded from flash, no tuning in this boot\n");
+		return;
+	}
+
+	printf("\ntuned in %u ms, %u probes, step %u%s\n", stats->time_ms,
+		stats->probes, stats->step,
+		stats->step == 1 ? " (exhaustive)" : "");
+
+	for (i = 0; i < MC_TUNE_EYE_COUNT; i++) {
+		marginal = 0;
+		for (slice = 0; slice < 2; slice++)
+			if (stats->eye[i][slice] < CONFIG_LTQ_MC_TUNE_EYE_MIN)
+				marginal = 1;
+
+		printf("%-8s eye width: %u/%u%s\n", names[i],
+			stats->eye[i][0], stats->eye[i][1],
+			marginal ? " (marginal)" : "");
+	}
+}
+
+static int do_mctune(cmd_tbl_t *cmdtp, int flag, int argc,
+			char * const argv[])
+{
+	struct mc_tune_stats *stats = mc_tune_stats_data();
+	unsigned int step = MC_TUNE_STEP_DEFAULT;
+
+	if (argc < 2 || !strcmp(argv[1], "info")) {
+		mc_tune_info();
+		return CMD_RET_SUCCESS;
+	}
+
+	if (strcmp(argv[1], "run"))
+		return CMD_RET_USAGE;
+
+	if (argc > 2)
+		step = simple_strtoul(argv[2], NULL, 10);
+
+	if (step < 1 || step > MC_TUNE_STEP_MAX)
+		return CMD_RET_USAGE;
+
+	/*
+	 * The search halts the memory controller, so it cannot run from
+	 * U-Boot in DDR. Leave a request for the SPL and reset.
+	 */
+	printf("resetting to tune DDR SDRAM with step %u\n", step);
+	stats->magic = MC_TUNE_REQUEST_MAGIC;
+	stats->step = step;
+	cpu_sync();
+
+	return do_reset(cmdtp, flag, argc, argv);
+}
+
+U_BOOT_CMD(
+	mctune,	3,	0,	do_mctune,
+	"show or rerun Lantiq DDR SDRAM tuning",
+	"[info]\n"
+	"    - show tuned delays, eye widths and duration of the last run\n"
+	"mctune run [step]\n"
+	"    - reset and let the SPL tune again, probing every 'step'\n"
+	"      delays before locating the eye edges by bisection\n"
+	"      (default " __stringify(MC_TUNE_STEP_DEFAULT)
+	", 1 scans every delay)"
+);
+#endif
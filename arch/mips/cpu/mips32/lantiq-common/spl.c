@@ -12,12 +12,35 @@
 #include <linux/compiler.h>
 #include <lzma/LzmaDec.h>
 #include <linux/lzo.h>
+#include <malloc.h>
+#include <u-boot/zlib.h>
 #include <asm/mipsregs.h>
+#include <asm/unaligned.h>
 #include <asm/arch/nand.h>
 #include <asm/lantiq/spl.h>
 #include <asm/lantiq/cpu.h>
 #include <asm/lantiq/mem.h>
 
+#ifndef CONFIG_LTQ_SPL_LOAD_CHUNK_SIZE
+#define CONFIG_LTQ_SPL_LOAD_CHUNK_SIZE	(16 * 1024)
+#endif
+
+#if (CONFIG_LTQ_SPL_LOAD_CHUNK_SIZE < 1024)
+#error "CONFIG_LTQ_SPL_LOAD_CHUNK_SIZE too small"
+#endif
+
+#if spl_boot_nand_flash && \
+	(CONFIG_LTQ_SPL_LOAD_CHUNK_SIZE % CONFIG_SYS_NAND_PAGE_SIZE)
+#error "CONFIG_LTQ_SPL_LOAD_CHUNK_SIZE must be a multiple of the NAND page size"
+#endif
+
+/* Upper bound of a lzop header incl. a maximum length file name */
+#define SPL_LZOP_HEADER_MAX	512
+
+/* LZMA header: 5 bytes properties, 8 bytes uncompressed size */
+#define SPL_LZMA_SIZE_OFFSET	LZMA_PROPS_SIZE
+#define SPL_LZMA_DATA_OFFSET	(LZMA_PROPS_SIZE + 8)
+
 struct spl_image {
 	ulong entry_addr;
 	ulong data_size;
@@ -26,6 +49,31 @@ struct spl_image {
 	u8 comp;
 };
 
+/*
+ * State of the chunked flash loader. Each chunk is read from flash into
+ * the staging buffer, checksummed and handed to the decompressor while
+ * it is still hot in the data cache.
+ */
+struct spl_stream {
+	ulong flash_addr;	/* flash offset of next chunk */
+	ulong flash_end;	/* flash offset of payload end */
+	u8 *wp;			/* end of data read from flash */
+	const u8 *data;		/* start of payload in staging buffer */
+	const u8 *crc_pos;	/* end of checksummed data */
+	const u8 *rp;		/* decompressor read position */
+	u8 *dst;		/* decompressor write position */
+	size_t dst_left;
+	ulong crc;
+	int done;
+#if defined(CONFIG_LTQ_SPL_COMP_LZMA)
+	CLzmaDec lzma;
+	SizeT lzma_limit;
+#endif
+	ulong ticks_read;
+	ulong ticks_crc;
+	ulong ticks_decomp;
+};
+
 DECLARE_GLOBAL_DATA_PTR;
 static struct spi_flash spl_spi_flash;
 
@@ -41,7 +89,18 @@ static int spl_is_compressed(const struct spl_image *spl)
 		return 0;
 
 #if defined(CONFIG_LTQ_SPL_COMP_LZO)
-	return spl->comp == IH_COMP_LZO;
+	if (spl->comp == IH_COMP_LZO)
+		return 1;
+#endif
+
+#if defined(CONFIG_LTQ_SPL_COMP_LZMA)
+	if (spl->comp == IH_COMP_LZMA)
+		return 1;
+#endif
+
+#if defined(CONFIG_LTQ_SPL_COMP_GZIP)
+	if (spl->comp == IH_COMP_GZIP)
+		return 1;
 #endif
 
 	spl_puts("SPL: unsupported compression type\n");
@@ -90,18 +149,6 @@ static int spl_parse_image(const image_header_t *hdr, struct spl_image *spl)
 	return 0;
 }
 
-static int spl_check_data(const struct spl_image *spl, unsigned long addr)
-{
-	ulong dcrc = crc32(0, (unsigned char *)addr, spl->data_size);
-
-	if (dcrc != spl->data_crc) {
-		spl_puts("SPL: invalid data CRC\n");
-		return 0;
-	}
-
-	return 1;
-}
-
 static int spl_copy_image(struct spl_image *spl, unsigned long addr)
 {
 	spl_puts("SPL: copying U-Boot to RAM\n");
@@ -112,24 +159,23 @@ static int spl_copy_image(struct spl_image *spl, unsigned long addr)
 	return 0;
 }
 
-static int spl_uncompress(struct spl_image *spl, unsigned long addr)
+static inline ulong spl_ticks(void)
 {
-	size_t len = CONFIG_SYS_LOAD_SIZE;
-	int ret;
-
-	spl_puts("SPL: decompressing U-Boot with LZO\n");
-
-	ret = lzop_decompress(
-		(const unsigned char*)addr, spl->data_size,
-		(unsigned char *) spl->entry_addr, &len);
-
-	spl->entry_size = len;
+	return read_c0_count();
+}
 
-	return ret;
+static ulong spl_ticks_to_us(ulong ticks)
+{
+	return ticks / (CONFIG_SYS_MIPS_TIMER_FREQ / 1000000);
 }
 
 static int spl_flash_init(void)
 {
+#if spl_boot_nand_flash
+	ulong start;
+	int ret;
+#endif
+
 #if spl_boot_spi_flash
 	spl_debug("SPL: probing SPI flash\n");
 	spi_init();
@@ -139,14 +185,290 @@ static int spl_flash_init(void)
 #if spl_boot_nand_flash
 	spl_debug("SPL: initializing NAND flash\n");
 	nand_init();
+
+	/* the MC tune buffer is not used yet and holds one page */
+	start = spl_ticks();
+	ret = ltq_nand_spl_scan_bbt(spl_mc_tune_buf);
+	if (spl_has_timing)
+		printf("SPL: NAND BBT %s in %lu us\n",
+			ret ? "not found" : "loaded",
+			spl_ticks_to_us(spl_ticks() - start));
 	return 0;
 #endif
 
 	return 0;
 }
 
+static int spl_stream_read(struct spl_stream *s)
+{
+	ulong len = min((ulong)CONFIG_LTQ_SPL_LOAD_CHUNK_SIZE,
+			s->flash_end - s->flash_addr);
+	ulong start = spl_ticks();
+	int ret = 0;
+
+#if spl_boot_spi_flash
+	ret = spi_flash_read(&spl_spi_flash, s->flash_addr, len, s->wp);
+#endif
+
+#if spl_boot_nand_flash
+	/* NAND is always read page-wise, the tail is ignored */
+	len = roundup(len, CONFIG_SYS_NAND_PAGE_SIZE);
+	ret = nand_spl_load_image(s->flash_addr, len, s->wp);
+#endif
+
+	s->flash_addr += len;
+	s->wp += len;
+	s->ticks_read += spl_ticks() - start;
+
+	return ret;
+}
+
+static int spl_stream_unlzo(struct spl_stream *s, const u8 *end)
+{
+	int ret;
+
+	if (!s->rp) {
+		/* wait until the complete lzop header is available */
+		if (end - s->data < SPL_LZOP_HEADER_MAX &&
+			s->flash_addr < s->flash_end)
+			return 0;
+
+		s->rp = lzop_parse_header(s->data);
+		if (!s->rp)
+			return -1;
+	}
+
+	while (!s->done) {
+		ret = lzop_decompress_block(&s->rp, end - s->rp, &s->dst,
+			&s->dst_left);
+		if (ret == LZO_E_INPUT_OVERRUN)
+			break;
+		if (ret == LZOP_E_END)
+			s->done = 1;
+		else if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+#if defined(CONFIG_LTQ_SPL_COMP_LZMA)
+static void *spl_lzma_alloc(void *p, size_t size)
+{
+	/* LzmaDec only allocates the probability model */
+	if (size > CONFIG_LTQ_SPL_SCRATCH_SIZE)
+		return NULL;
+
+	return (void *)CONFIG_LTQ_SPL_SCRATCH_BASE;
+}
+
+static void spl_lzma_free(void *p, void *address)
+{
+}
+
+static ISzAlloc spl_lzma_allocator = {
+	.Alloc = spl_lzma_alloc,
+	.Free = spl_lzma_free,
+};
+
+static int spl_stream_unlzma(struct spl_stream *s, const u8 *end)
+{
+	ELzmaStatus status;
+	SizeT len;
+	SRes res;
+
+	if (!s->rp) {
+		if (end - s->data < SPL_LZMA_DATA_OFFSET)
+			return 0;
+
+		LzmaDec_Construct(&s->lzma);
+		res = LzmaDec_AllocateProbs(&s->lzma, s->data, LZMA_PROPS_SIZE,
+			&spl_lzma_allocator);
+		if (res != SZ_OK)
+			return -1;
+
+		/* size field is 0xffffffff if unknown, use the buffer size */
+		s->lzma_limit = min((SizeT)s->dst_left,
+			(SizeT)get_unaligned_le32(s->data +
+				SPL_LZMA_SIZE_OFFSET));
+
+		s->lzma.dic = s->dst;
+		s->lzma.dicBufSize = s->dst_left;
+		LzmaDec_Init(&s->lzma);
+
+		s->rp = s->data + SPL_LZMA_DATA_OFFSET;
+	}
+
+	len = end - s->rp;
+	res = LzmaDec_DecodeToDic(&s->lzma, s->lzma_limit, s->rp, &len,
+		LZMA_FINISH_ANY, &status);
+	s->rp += len;
+	s->dst = s->lzma.dic + s->lzma.dicPos;
+
+	if (res != SZ_OK)
+		return -1;
+
+	if (status == LZMA_STATUS_FINISHED_WITH_MARK ||
+		s->lzma.dicPos == s->lzma_limit)
+		s->done = 1;
+
+	return 0;
+}
+#endif
+
+#if defined(CONFIG_LTQ_SPL_COMP_GZIP)
+static int spl_stream_gunzip(struct spl_stream *s, const u8 *end)
+{
+	unsigned long len = end - s->data;
+	int ret;
+
+	/* gunzip() is not incremental, wait for the complete payload */
+	if (s->flash_addr < s->flash_end)
+		return 0;
+
+	mem_malloc_init(CONFIG_LTQ_SPL_SCRATCH_BASE,
+		CONFIG_LTQ_SPL_SCRATCH_SIZE);
+
+	ret = gunzip(s->dst, s->dst_left, (unsigned char *)s->data, &len);
+	if (ret)
+		return ret;
+
+	s->rp = end;
+	s->dst += len;
+	s->done = 1;
+
+	return 0;
+}
+#endif
+
+static int spl_stream_uncompress(struct spl_stream *s,
+				const struct spl_image *spl, const u8 *end)
+{
+	switch (spl->comp) {
+#if defined(CONFIG_LTQ_SPL_COMP_LZO)
+	case IH_COMP_LZO:
+		return spl_stream_unlzo(s, end);
+#endif
+#if defined(CONFIG_LTQ_SPL_COMP_LZMA)
+	case IH_COMP_LZMA:
+		return spl_stream_unlzma(s, end);
+#endif
+#if defined(CONFIG_LTQ_SPL_COMP_GZIP)
+	case IH_COMP_GZIP:
+		return spl_stream_gunzip(s, end);
+#endif
+	default:
+		return -1;
+	}
+}
+
+static int spl_stream_process(struct spl_stream *s,
+				const struct spl_image *spl)
+{
+	const u8 *end = min(s->data + spl->data_size, (const u8 *)s->wp);
+	ulong start, mid;
+	int ret = 0;
+
+	start = spl_ticks();
+
+	if (end > s->crc_pos) {
+		s->crc = crc32(s->crc, s->crc_pos, end - s->crc_pos);
+		s->crc_pos = end;
+	}
+
+	mid = spl_ticks();
+
+	if (spl_is_compressed(spl) > 0 && !s->done)
+		ret = spl_stream_uncompress(s, spl, end);
+
+	s->ticks_crc += mid - start;
+	s->ticks_decomp += spl_ticks() - mid;
+
+	return ret;
+}
+
+static int spl_stream_load(struct spl_stream *s, struct spl_image *spl)
+{
+	int ret;
+
+	while (s->flash_addr < s->flash_end) {
+		ret = spl_stream_read(s);
+		if (ret)
+			return ret;
+
+		ret = spl_stream_process(s, spl);
+		if (ret) {
+			spl_puts("SPL: decompression failed\n");
+			return ret;
+		}
+	}
+
+	if (s->crc != spl->data_crc) {
+		spl_puts("SPL: invalid data CRC\n");
+		return -1;
+	}
+
+	if (spl_is_compressed(spl) > 0) {
+		if (!s->done) {
+			spl_puts("SPL: truncated compressed data\n");
+			return -1;
+		}
+
+		spl->entry_size = s->dst - (u8 *)spl->entry_addr;
+	} else {
+		spl->entry_size = spl->data_size;
+	}
+
+	if (spl_has_timing)
+		printf("SPL: %s: read %lu bytes in %lu us, crc %lu us, "
+			"decompress %lu bytes in %lu us\n",
+			genimg_get_comp_name(spl->comp), spl->data_size,
+			spl_ticks_to_us(s->ticks_read),
+			spl_ticks_to_us(s->ticks_crc), spl->entry_size,
+			spl_ticks_to_us(s->ticks_decomp));
+
+	return 0;
+}
+
+static void spl_stream_init(struct spl_stream *s, const struct spl_image *spl,
+				void *buf)
+{
+	memset(s, 0, sizeof(*s));
+	s->wp = buf;
+	s->data = buf;
+	s->crc_pos = buf;
+	s->dst = (u8 *)spl->entry_addr;
+	s->dst_left = CONFIG_SYS_LOAD_SIZE;
+}
+
+static int spl_uncompress(struct spl_image *spl, unsigned long addr)
+{
+	struct spl_stream s;
+	int ret;
+
+	spl_debug("SPL: decompressing U-Boot with %s\n",
+		genimg_get_comp_name(spl->comp));
+	spl_puts("SPL: decompressing U-Boot\n");
+
+	/* the whole payload is already accessible */
+	spl_stream_init(&s, spl, (void *)addr);
+	s.wp += spl->data_size;
+
+	ret = spl_stream_uncompress(&s, spl, s.wp);
+	if (ret)
+		return ret;
+
+	if (!s.done)
+		return -1;
+
+	spl->entry_size = s.dst - (u8 *)spl->entry_addr;
+
+	return 0;
+}
+
 static int spl_load_spi_flash(struct spl_image *spl)
 {
+	struct spl_stream s;
 	image_header_t hdr;
 	int ret;
 	unsigned long loadaddr;
@@ -170,7 +492,11 @@ static int spl_load_spi_flash(struct spl_image *spl)
 	if (ret)
 		return ret;
 
-	if (spl_is_compressed(spl))
+	ret = spl_is_compressed(spl);
+	if (ret < 0)
+		return ret;
+
+	if (ret)
 		loadaddr = CONFIG_LOADADDR;
 	else
 		loadaddr = spl->entry_addr;
@@ -179,18 +505,12 @@ static int spl_load_spi_flash(struct spl_image *spl)
 
 	/* skip U-Boot mkimage header */
 	addr += image_get_header_size();
-	ret = spi_flash_read(&spl_spi_flash, addr, spl->data_size,
-		(void *)loadaddr);
-	if (ret)
-		return ret;
-
-	if (!spl_check_data(spl, loadaddr))
-		return -1;
 
-	if (spl_is_compressed(spl))
-		ret = spl_uncompress(spl, loadaddr);
+	spl_stream_init(&s, spl, (void *)loadaddr);
+	s.flash_addr = addr;
+	s.flash_end = addr + spl->data_size;
 
-	return ret;
+	return spl_stream_load(&s, spl);
 }
 
 static int spl_load_nor_flash(struct spl_image *spl)
@@ -233,6 +553,7 @@ static int spl_load_nor_flash(struct spl_image *spl)
 
 static int spl_load_nand_flash(struct spl_image *spl)
 {
+	struct spl_stream s;
 	const image_header_t *hdr;
 	int ret;
 	unsigned long loadaddr = CONFIG_LOADADDR;
@@ -251,23 +572,45 @@ static int spl_load_nand_flash(struct spl_image *spl)
 	 */
 	spl_puts("SPL: loading U-Boot to RAM\n");
 
-	nand_spl_load_image(CONFIG_SPL_U_BOOT_OFFS,
-		CONFIG_SPL_U_BOOT_SIZE, (void *)loadaddr);
+	/* first chunk contains the U-Boot mkimage header */
+	memset(&s, 0, sizeof(s));
+	s.wp = (u8 *)loadaddr;
+	s.flash_addr = CONFIG_SPL_U_BOOT_OFFS;
+	s.flash_end = CONFIG_SPL_U_BOOT_OFFS + CONFIG_SPL_U_BOOT_SIZE;
+
+	ret = spl_stream_read(&s);
+	if (ret)
+		return ret;
 
 	hdr = (const image_header_t *)loadaddr;
 	ret = spl_parse_image(hdr, spl);
 	if (ret)
 		return ret;
 
+	ret = spl_is_compressed(spl);
+	if (ret < 0)
+		return ret;
+
 	/* skip U-Boot mkimage header */
 	loadaddr += image_get_header_size();
 
-	if (!spl_check_data(spl, loadaddr))
-		return 1;
+	s.data = (const u8 *)loadaddr;
+	s.crc_pos = s.data;
+	s.dst = (u8 *)spl->entry_addr;
+	s.dst_left = CONFIG_SYS_LOAD_SIZE;
+	s.flash_end = CONFIG_SPL_U_BOOT_OFFS + image_get_header_size() +
+			spl->data_size;
 
-	if (spl_is_compressed(spl))
-		ret = spl_uncompress(spl, loadaddr);
-	else
+	/* process the payload part of the first chunk */
+	ret = spl_stream_process(&s, spl);
+	if (ret)
+		return ret;
+
+	ret = spl_stream_load(&s, spl);
+	if (ret)
+		return ret;
+
+	if (!spl_is_compressed(spl))
 		ret = spl_copy_image(spl, loadaddr);
 
 	return ret;
@@ -324,8 +667,10 @@ void __noreturn spl_lantiq_init(void)
 	void (*uboot)(void) __noreturn;
 	struct spl_image spl;
 	struct mc_tune_cfg *mc_tune_cfg;
+	struct mc_tune_stats *mc_tune_stats;
+	unsigned int step;
 	gd_t gd_data;
-	int ret;
+	int ret, err;
 
 	gd = &gd_data;
 	barrier();
@@ -344,13 +689,34 @@ void __noreturn spl_lantiq_init(void)
 
 	if (spl_mc_tune) {
 		mc_tune_cfg = (struct mc_tune_cfg *)spl_mc_tune_buf;
+		mc_tune_stats = mc_tune_stats_data();
+		step = mc_tune_requested();
 		ret = spl_load_mem_ctrl_cfg();
-		if (ret) {
+		if (ret || step) {
 			spl_puts("SPL: tuning DDR SDRAM\n");
-			mc_tune_perform(mc_tune_cfg);
+			mc_tune_stats->step = step ? step : MC_TUNE_STEP_DEFAULT;
+			err = mc_tune_perform(mc_tune_cfg, mc_tune_stats);
+			mc_tune_stats->magic = MC_TUNE_STATS_MAGIC;
+			mc_tune_dump_stats(mc_tune_stats);
+
+			/*
+			 * A requested run only applies to this boot and never
+			 * replaces the settings in flash, which are restored
+			 * if it fails.
+			 */
+			if (!ret) {
+				if (err) {
+					mc_tune_apply(mc_tune_cfg);
+					mc_tune_cfg->state = MC_TUNE_VALID_STORED;
+				} else {
+					mc_tune_cfg->state =
+						MC_TUNE_VALID_REQUESTED;
+				}
+			}
 		} else {
 			spl_puts("SPL: applying tuned DDR SDRAM settings\n");
 			mc_tune_apply(mc_tune_cfg);
+			mc_tune_stats->magic = 0;
 		}
 		mc_tune_dump(mc_tune_cfg);
 		mc_tune_store_ram(mc_tune_cfg);
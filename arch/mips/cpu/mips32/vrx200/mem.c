@@ -359,151 +359,305 @@ static __always_inline void mc_wr_dq_writel(unsigned int slice,
 	mc_ccr_write(offset, val);
 }
 
-int mc_tune_perform(struct mc_tune_cfg *cfg)
+enum mc_tune_param {
+	MC_TUNE_ECHO_DLL,
+	MC_TUNE_WRITE_DQ,
+	MC_TUNE_READ_DQ,
+};
+
+struct mc_tune_ctx {
+	phys_size_t sdram_size;
+	unsigned int probes;
+	u8 test[2][128];
+};
+
+/* Window of passing delays per slice, empty if max < min */
+struct mc_eye {
+	int min[2];
+	int max[2];
+};
+
+static void mc_tune_set(enum mc_tune_param param, const int *delay)
 {
-	const phys_size_t sdram_size = mc_sdram_size();
-	const unsigned int read_max_q = 0x2b;
-	const unsigned int read_min_q = 0x15;
-	const unsigned int read_max = 0x3f;
-	const unsigned int read_min = 0x00;
-	const unsigned int write_q = 0x55;
-	const unsigned int write_max = 0x7f;
-	const unsigned int write_min = 0x40;
-	const unsigned int echo_dll_size = 0x80;
-	const unsigned int echo_dll_init = 0x20;
-	unsigned int i, dq;
-	unsigned int read_dq_l, read_dq_u, write_dq_l, write_dq_u;
-	unsigned int echo_dll_l, echo_dll_u;
-	unsigned int min_l, max_l, min_u, max_u;
-	u8 test_u[128], test_l[128];
-	int ret;
-
-#if 0
-	ltq_mc_ccr_dump(3);
-	ltq_mc_ccr_dump(11);
-	ltq_mc_ccr_dump(39);
-	ltq_mc_ccr_dump(40);
-	ltq_mc_ccr_dump(43);
-	ltq_mc_ccr_dump(44);
-	ltq_mc_ccr_dump(53);
-	ltq_mc_ccr_dump(54);
-#endif
+	switch (param) {
+	case MC_TUNE_ECHO_DLL:
+		mc_ddr_echo_dll_writel(0, delay[0]);
+		mc_ddr_echo_dll_writel(1, delay[1]);
+		cpu_sync();
+		break;
+	case MC_TUNE_WRITE_DQ:
+		mc_halt();
+		mc_wr_dq_writel(0, delay[0]);
+		mc_wr_dq_writel(1, delay[1]);
+		mc_start();
+		__udelay(100);
+		break;
+	case MC_TUNE_READ_DQ:
+		mc_halt();
+		mc_rd_dq_writel(0, delay[0]);
+		mc_rd_dq_writel(1, delay[1]);
+		mc_start();
+		__udelay(100);
+		break;
+	}
+}
+
+/* Apply one delay per slice and return the mask of passing slices */
+static unsigned int mc_tune_probe(struct mc_tune_ctx *ctx,
+				enum mc_tune_param param, const int *delay,
+				int quick)
+{
+	unsigned int slice, pass = 0;
+
+	mc_tune_set(param, delay);
+	ctx->probes++;
+
+	for (slice = 0; slice < 2; slice++) {
+		if (ltq_mem_test_tune(ctx->sdram_size, slice, quick))
+			continue;
+
+		pass |= 1 << slice;
+
+		if (spl_mc_tune_debug)
+			ctx->test[slice][delay[slice]] = 1;
+	}
+
+	return pass;
+}
+
+/*
+ * Do one bisection step on each slice whose edge between the passing
+ * delay good[] and the failing delay bad[] is not yet located. Both
+ * slices are probed at once. Returns 0 when both edges are found.
+ */
+static int mc_eye_bisect(struct mc_tune_ctx *ctx, enum mc_tune_param param,
+			int quick, int *good, int *bad)
+{
+	unsigned int slice, pass, busy = 0;
+	int delay[2];
+
+	for (slice = 0; slice < 2; slice++) {
+		if (abs(good[slice] - bad[slice]) > 1) {
+			delay[slice] = (good[slice] + bad[slice]) / 2;
+			busy |= 1 << slice;
+		} else {
+			delay[slice] = good[slice];
+		}
+	}
+
+	if (!busy)
+		return 0;
+
+	pass = mc_tune_probe(ctx, param, delay, quick);
+
+	for (slice = 0; slice < 2; slice++) {
+		if (!(busy & (1 << slice)))
+			continue;
+
+		if (pass & (1 << slice))
+			good[slice] = delay[slice];
+		else
+			bad[slice] = delay[slice];
+	}
+
+	return 1;
+}
+
+/*
+ * Find the eye of passing delays in [first, end) for both slices.
+ *
+ * The range is probed every step delays. Then each edge is located by
+ * bisection between the outermost passing coarse point and the failing
+ * one next to it. This needs the eye to be a single window, which holds
+ * for the DQ and echo DLL delays. A step of 1 probes every delay, like
+ * the exhaustive scan. If the coarse grid misses the eye of a slice
+ * completely, the range is scanned again delay by delay.
+ */
+static void mc_eye_search(struct mc_tune_ctx *ctx, enum mc_tune_param param,
+			int first, int end, int step, int quick,
+			struct mc_eye *eye)
+{
+	unsigned int slice, pass;
+	int d, delay[2], good[2], bad[2];
+
+	for (slice = 0; slice < 2; slice++) {
+		eye->min[slice] = end;
+		eye->max[slice] = first - 1;
+	}
+
+	for (d = first; d < end; d += step) {
+		delay[0] = d;
+		delay[1] = d;
+		pass = mc_tune_probe(ctx, param, delay, quick);
+
+		for (slice = 0; slice < 2; slice++) {
+			if (!(pass & (1 << slice)))
+				continue;
+
+			if (eye->min[slice] > d)
+				eye->min[slice] = d;
+
+			if (eye->max[slice] < d)
+				eye->max[slice] = d;
+		}
+	}
+
+	if (step == 1)
+		return;
+
+	if (eye->max[0] < eye->min[0] || eye->max[1] < eye->min[1]) {
+		mc_eye_search(ctx, param, first, end, 1, quick, eye);
+		return;
+	}
+
+	/* lower edges */
+	for (slice = 0; slice < 2; slice++) {
+		good[slice] = eye->min[slice];
+		bad[slice] = max(eye->min[slice] - step, first - 1);
+	}
+
+	while (mc_eye_bisect(ctx, param, quick, good, bad))
+		;
+
+	for (slice = 0; slice < 2; slice++)
+		eye->min[slice] = good[slice];
+
+	/* upper edges */
+	for (slice = 0; slice < 2; slice++) {
+		good[slice] = eye->max[slice];
+		bad[slice] = min(eye->max[slice] + step, end);
+	}
+
+	while (mc_eye_bisect(ctx, param, quick, good, bad))
+		;
+
+	for (slice = 0; slice < 2; slice++)
+		eye->max[slice] = good[slice];
+}
+
+/* Centre of the eye of a slice, or -1 if it is too narrow */
+static int mc_eye_center(const struct mc_eye *eye, unsigned int slice)
+{
+	if (eye->max[slice] > eye->min[slice])
+		return (eye->min[slice] + eye->max[slice]) >> 1;
+
+	return -1;
+}
+
+static void mc_eye_width(const struct mc_eye *eye, u8 *width)
+{
+	unsigned int slice;
+
+	for (slice = 0; slice < 2; slice++) {
+		if (eye->max[slice] < eye->min[slice])
+			width[slice] = 0;
+		else
+			width[slice] = eye->max[slice] - eye->min[slice] + 1;
+	}
+}
+
+int mc_tune_perform(struct mc_tune_cfg *cfg, struct mc_tune_stats *stats)
+{
+	const int read_max_q = 0x2b;
+	const int read_min_q = 0x15;
+	const int read_max = 0x3f;
+	const int read_min = 0x00;
+	const int write_q = 0x55;
+	const int write_max = 0x7f;
+	const int write_min = 0x40;
+	const int echo_dll_size = 0x80;
+	const int echo_dll_init = 0x20;
+	const int step = stats->step;
+	const ulong start = get_timer(0);
+	struct mc_tune_ctx ctx;
+	struct mc_eye eye, init;
+	u8 width[MC_TUNE_EYE_COUNT][2];
+	int read_dq_l, read_dq_u, write_dq_l, write_dq_u;
+	int echo_dll_l, echo_dll_u;
+	unsigned int slice;
+	int i;
+
+	ctx.sdram_size = mc_sdram_size();
+	ctx.probes = 0;
+	memset(width, 0, sizeof(width));
 
 	ltq_writel(&mc_global_regs->ddr_echo_dll0, echo_dll_init);
 	ltq_writel(&mc_global_regs->ddr_echo_dll1, echo_dll_init);
 
-	/* initial read DQ delay tuning */
-	min_l = read_max_q;
-	max_l = read_min_q;
-	min_u = read_max_q;
-	max_u = read_min_q;
+	/*
+	 * initial read DQ delay tuning: union of the read eyes over a
+	 * range of write DQ delays. Only every step-th write delay is
+	 * tried. The union just has to yield a read delay that works well
+	 * enough to tune the echo DLL and the write DQ delay, the read
+	 * eye itself is searched again at the end with the tuned write
+	 * delay.
+	 */
+	for (slice = 0; slice < 2; slice++) {
+		init.min[slice] = read_max_q;
+		init.max[slice] = read_min_q;
+	}
 
-	for (i = 0; i < 15; i++) {
+	for (i = 0; i < 15; i += step) {
 		mc_halt();
 		mc_wr_dq_writel(0, write_q + i);
 		mc_wr_dq_writel(1, write_q + i);
 
-		for (dq = read_min_q; dq < read_max_q; dq++) {
-			mc_halt();
-			mc_rd_dq_writel(0, dq);
-			mc_rd_dq_writel(1, dq);
-			mc_start();
-			__udelay(100);
-
-			ret = ltq_mem_test_tune(sdram_size, 0, 1);
-			if (ret == 0) {
-				if (min_l > dq)
-					min_l = dq;
-
-				if (max_l < dq)
-					max_l = dq;
-			}
-
-			ret = ltq_mem_test_tune(sdram_size, 1, 1);
-			if (ret == 0) {
-				if (min_u > dq)
-					min_u = dq;
-
-				if (max_u < dq)
-					max_u = dq;
-			}
+		mc_eye_search(&ctx, MC_TUNE_READ_DQ, read_min_q, read_max_q,
+			step, 1, &eye);
+
+		for (slice = 0; slice < 2; slice++) {
+			if (eye.max[slice] < eye.min[slice])
+				continue;
+
+			init.min[slice] = min(init.min[slice], eye.min[slice]);
+			init.max[slice] = max(init.max[slice], eye.max[slice]);
 		}
 	}
 
-	if (max_l > min_l) {
-		read_dq_l = (min_l + max_l) >> 1;
-	} else {
+	read_dq_l = mc_eye_center(&init, 0);
+	if (read_dq_l < 0) {
 		spl_puts("MEM: failed to determine a suitable initial read DQS delay for slice #0\n");
 		goto err;
 	}
 
-	if (max_u > min_u) {
-		read_dq_u = (min_u + max_u) >> 1;
-	} else {
+	read_dq_u = mc_eye_center(&init, 1);
+	if (read_dq_u < 0) {
 		spl_puts("MEM: failed to determine a suitable initial read DQS delay for slice #1\n");
 		goto err;
 	}
 
 	/* gate echo DLL tuning */
-	min_l = echo_dll_size;
-	max_l = 0;
-	min_u = echo_dll_size;
-	max_u = 0;
-
-	if (spl_mc_tune_debug) {
-		memset(test_l, 0, sizeof(test_l));
-		memset(test_u, 0, sizeof(test_u));
-	}
-
-	for (i = 0; i < echo_dll_size; i++) {
-		ltq_writel(&mc_global_regs->ddr_echo_dll0, i);
-		ltq_writel(&mc_global_regs->ddr_echo_dll1, i);
-		cpu_sync();
-
-		ret = ltq_mem_test_tune(sdram_size, 0, 0);
-		if (ret == 0) {
-			if (min_l > i)
-				min_l = i;
-
-			if (max_l < i)
-				max_l = i;
-
-			if (spl_mc_tune_debug)
-				test_l[i] = 1;
-		}
-
-		ret = ltq_mem_test_tune(sdram_size, 1, 0);
-		if (ret == 0) {
-			if (min_u > i)
-				min_u = i;
+	mc_halt();
+	mc_wr_dq_writel(0, write_q);
+	mc_wr_dq_writel(1, write_q);
+	mc_rd_dq_writel(0, read_dq_l);
+	mc_rd_dq_writel(1, read_dq_u);
+	mc_start();
+	__udelay(100);
 
-			if (max_u < i)
-				max_u = i;
+	if (spl_mc_tune_debug)
+		memset(ctx.test, 0, sizeof(ctx.test));
 
-			if (spl_mc_tune_debug)
-				test_u[i] = 1;
-		}
-	}
+	mc_eye_search(&ctx, MC_TUNE_ECHO_DLL, 0, echo_dll_size, step, 0, &eye);
+	mc_eye_width(&eye, width[MC_TUNE_EYE_ECHO_DLL]);
 
-	if (max_l > min_l) {
-		echo_dll_l = (min_l + max_l) >> 1;
-	} else {
+	echo_dll_l = mc_eye_center(&eye, 0);
+	if (echo_dll_l < 0) {
 		spl_puts("MEM: failed to determine a suitable echo DLL delay for slice #0\n");
 		goto err;
 	}
 
-	if (max_u > min_u) {
-		echo_dll_u = (min_u + max_u) >> 1;
-	} else {
+	echo_dll_u = mc_eye_center(&eye, 1);
+	if (echo_dll_u < 0) {
 		spl_puts("MEM: failed to determine a suitable echo DLL delay for slice #1\n");
 		goto err;
 	}
 
 	if (spl_mc_tune_debug) {
 		printf("\nEcho DLL delay slice 0: %02x\n", echo_dll_l);
-		test_dump(test_l, 0, echo_dll_size);
+		test_dump(ctx.test[0], 0, echo_dll_size);
 		printf("\nEcho DLL delay slice 1: %02x\n", echo_dll_u);
-		test_dump(test_u, 0, echo_dll_size);
+		test_dump(ctx.test[1], 0, echo_dll_size);
 	}
 
 	ltq_writel(&mc_global_regs->ddr_echo_dll0, echo_dll_l);
@@ -511,139 +665,65 @@ int mc_tune_perform(struct mc_tune_cfg *cfg)
 	cpu_sync();
 
 	/* write data eye tuning */
-	min_l = write_max;
-	max_l = write_min;
-	min_u = write_max;
-	max_u = write_min;
-
-	if (spl_mc_tune_debug) {
-		memset(test_l, 0, sizeof(test_l));
-		memset(test_u, 0, sizeof(test_u));
-	}
+	if (spl_mc_tune_debug)
+		memset(ctx.test, 0, sizeof(ctx.test));
 
 	mc_halt();
 	mc_rd_dq_writel(0, read_dq_l);
 	mc_rd_dq_writel(1, read_dq_u);
 
-	for (dq = write_min; dq < write_max; dq++) {
-		mc_halt();
-		mc_wr_dq_writel(0, dq);
-		mc_wr_dq_writel(1, dq);
-		mc_start();
-		__udelay(100);
-
-		ret = ltq_mem_test_tune(sdram_size, 0, 0);
-		if (ret == 0) {
-			if (min_l > dq)
-				min_l = dq;
-
-			if (max_l < dq)
-				max_l = dq;
-
-			if (spl_mc_tune_debug)
-				test_l[dq] = 1;
-		}
+	mc_eye_search(&ctx, MC_TUNE_WRITE_DQ, write_min, write_max, step, 0,
+		&eye);
+	mc_eye_width(&eye, width[MC_TUNE_EYE_WRITE_DQ]);
 
-		ret = ltq_mem_test_tune(sdram_size, 1, 0);
-		if (ret == 0) {
-			if (min_u > dq)
-				min_u = dq;
-
-			if (max_u < dq)
-				max_u = dq;
-
-			if (spl_mc_tune_debug)
-				test_u[dq] = 1;
-		}
-	}
-
-	if (max_l > min_l) {
-		write_dq_l = (min_l + max_l) >> 1;
-	} else {
+	write_dq_l = mc_eye_center(&eye, 0);
+	if (write_dq_l < 0) {
 		spl_puts("MEM: failed to determine a suitable write DQS delay for slice #0\n");
 		goto err;
 	}
 
-	if (max_u > min_u) {
-		write_dq_u = (min_u + max_u) >> 1;
-	} else {
+	write_dq_u = mc_eye_center(&eye, 1);
+	if (write_dq_u < 0) {
 		spl_puts("MEM: failed to determine a suitable write DQS delay for slice #1\n");
 		goto err;
 	}
 
 	if (spl_mc_tune_debug) {
 		printf("\nWrite DQ delay slice 0: %02x\n", write_dq_l);
-		test_dump(test_l, write_min, write_max + 1);
+		test_dump(ctx.test[0], write_min, write_max + 1);
 		printf("\nWrite DQ delay slice 1: %02x\n", write_dq_u);
-		test_dump(test_u, write_min, write_max + 1);
+		test_dump(ctx.test[1], write_min, write_max + 1);
 	}
 
 	/* read data eye tuning */
-	min_l = read_max;
-	max_l = read_min;
-	min_u = read_max;
-	max_u = read_min;
-
-	if (spl_mc_tune_debug) {
-		memset(test_l, 0, sizeof(test_l));
-		memset(test_u, 0, sizeof(test_u));
-	}
+	if (spl_mc_tune_debug)
+		memset(ctx.test, 0, sizeof(ctx.test));
 
 	mc_halt();
 	mc_wr_dq_writel(0, write_dq_l);
 	mc_wr_dq_writel(1, write_dq_u);
 
-	for (dq = read_min_q; dq < read_max_q; dq++) {
-		mc_halt();
-		mc_rd_dq_writel(0, dq);
-		mc_rd_dq_writel(1, dq);
-		mc_start();
-		__udelay(100);
-
-		ret = ltq_mem_test_tune(sdram_size, 0, 0);
-		if (ret == 0) {
-			if (min_l > dq)
-				min_l = dq;
-
-			if (max_l < dq)
-				max_l = dq;
-
-			if (spl_mc_tune_debug)
-				test_l[dq] = 1;
-		}
-
-		ret = ltq_mem_test_tune(sdram_size, 1, 0);
-		if (ret == 0) {
-			if (min_u > dq)
-				min_u = dq;
+	mc_eye_search(&ctx, MC_TUNE_READ_DQ, read_min_q, read_max_q, step, 0,
+		&eye);
+	mc_eye_width(&eye, width[MC_TUNE_EYE_READ_DQ]);
 
-			if (max_u < dq)
-				max_u = dq;
-
-			if (spl_mc_tune_debug)
-				test_u[dq] = 1;
-		}
-	}
-
-	if (max_l > min_l) {
-		read_dq_l = (min_l + max_l) >> 1;
-	} else {
+	read_dq_l = mc_eye_center(&eye, 0);
+	if (read_dq_l < 0) {
 		spl_puts("MEM: failed to determine a suitable read DQS delay for slice #0\n");
 		goto err;
 	}
 
-	if (max_u > min_u) {
-		read_dq_u = (min_u + max_u) >> 1;
-	} else {
+	read_dq_u = mc_eye_center(&eye, 1);
+	if (read_dq_u < 0) {
 		spl_puts("MEM: failed to determine a suitable read DQS delay for slice #1\n");
 		goto err;
 	}
 
 	if (spl_mc_tune_debug) {
 		printf("\nRead DQ delay slice 0: %02x\n", read_dq_l);
-		test_dump(test_l, read_min, read_max + 1);
+		test_dump(ctx.test[0], read_min, read_max + 1);
 		printf("\nRead DQ delay slice 1: %02x\n", read_dq_u);
-		test_dump(test_u, read_min, read_max + 1);
+		test_dump(ctx.test[1], read_min, read_max + 1);
 	}
 
 	mc_halt();
@@ -659,6 +739,14 @@ int mc_tune_perform(struct mc_tune_cfg *cfg)
 	cfg->read_dqs_delay_u = read_dq_u;
 	cfg->state = MC_TUNE_VALID;
 
+	/*
+	 * The statistics live in SDRAM, only write them once the tuned
+	 * delays are active
+	 */
+	memcpy(stats->eye, width, sizeof(width));
+	stats->probes = ctx.probes;
+	stats->time_ms = get_timer(start);
+
 	return 0;
 
 err:
@@ -673,6 +761,10 @@ err:
 	ltq_writel(&mc_global_regs->ddr_echo_dll1, DEFAULT_GATE_ECHO_DLL);
 	mc_start();
 
+	memcpy(stats->eye, width, sizeof(width));
+	stats->probes = ctx.probes;
+	stats->time_ms = get_timer(start);
+
 	return 1;
 }
 
@@ -684,7 +776,7 @@ void mc_tune_apply(const struct mc_tune_cfg *cfg)
 	mc_wr_dq_writel(0, cfg->write_dqs_delay_l);
 	mc_wr_dq_writel(1, cfg->write_dqs_delay_u);
 	mc_rd_dq_writel(0, cfg->read_dqs_delay_l);
-	mc_rd_dq_writel(1, cfg->read_dqs_delay_l);
+	mc_rd_dq_writel(1, cfg->read_dqs_delay_u);
 	mc_start();
 }
 
@@ -115,18 +115,23 @@
 #define CONFIG_MTD_NAND_VERIFY_WRITE
 
 #define CONFIG_CMD_NAND
+#define CONFIG_CMD_NAND_BENCH
 #endif
 
 #if defined(CONFIG_LTQ_SUPPORT_ETHERNET)
 #define CONFIG_LANTIQ_DMA
 #define CONFIG_LANTIQ_ARX100_SWITCH
 
+#ifndef CONFIG_SYS_RX_ETH_BUFFER
+#define CONFIG_SYS_RX_ETH_BUFFER	32
+#endif
 #define CONFIG_PHYLIB
 #define CONFIG_MII
 #define CONFIG_UDP_CHECKSUM
 
 #define CONFIG_CMD_MII
 #define CONFIG_CMD_NET
+#define CONFIG_CMD_LTQ_DMA
 #endif
 
 #define CONFIG_SPL_MAX_SIZE		(32 * 1024)
@@ -103,6 +103,7 @@
 #define CONFIG_SYS_NAND_BASE		0xB4000000
 
 #define CONFIG_CMD_NAND
+#define CONFIG_CMD_NAND_BENCH
 #endif
 
 #if defined(CONFIG_LTQ_SUPPORT_ETHERNET)
@@ -110,12 +111,16 @@
 #define CONFIG_LANTIQ_VRX200_SWITCH
 #define CONFIG_PHY_LANTIQ
 
+#ifndef CONFIG_SYS_RX_ETH_BUFFER
+#define CONFIG_SYS_RX_ETH_BUFFER	32
+#endif
 #define CONFIG_PHYLIB
 #define CONFIG_MII
 #define CONFIG_UDP_CHECKSUM
 
 #define CONFIG_CMD_MII
 #define CONFIG_CMD_NET
+#define CONFIG_CMD_LTQ_DMA
 #endif
 
 #define CONFIG_SPL_MAX_SIZE		(32 * 1024)
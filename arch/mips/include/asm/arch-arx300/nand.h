@@ -9,5 +9,6 @@
 
 struct nand_chip;
 int ltq_nand_init(struct nand_chip *nand);
+int ltq_nand_spl_scan_bbt(void *buf);
 
 #endif /* __ARX300_NAND_H__ */
@@ -120,6 +120,7 @@
 #define CONFIG_MTD_NAND_VERIFY_WRITE
 
 #define CONFIG_CMD_NAND
+#define CONFIG_CMD_NAND_BENCH
 #endif
 
 #if defined(CONFIG_LTQ_SUPPORT_ETHERNET)
@@ -127,13 +128,16 @@
 #define CONFIG_LANTIQ_VRX200_SWITCH
 #define CONFIG_PHY_LANTIQ
 
-#define CONFIG_SYS_RX_ETH_BUFFER	8
+#ifndef CONFIG_SYS_RX_ETH_BUFFER
+#define CONFIG_SYS_RX_ETH_BUFFER	32
+#endif
 #define CONFIG_PHYLIB
 #define CONFIG_MII
 #define CONFIG_UDP_CHECKSUM
 
 #define CONFIG_CMD_MII
 #define CONFIG_CMD_NET
+#define CONFIG_CMD_LTQ_DMA
 #endif
 
 #define CONFIG_SPL_MAX_SIZE		(32 * 1024)
@@ -147,6 +151,10 @@
 #define CONFIG_SPL_MC_TUNE_BASE		(CONFIG_SYS_SDRAM_BASE_UC + \
 					CONFIG_SYS_INIT_SP_OFFSET)
 
+#if defined(CONFIG_LTQ_SPL_MC_TUNE)
+#define CONFIG_CMD_LTQ_MCTUNE
+#endif
+
 #if defined(CONFIG_SYS_BOOT_RAM)
 #define CONFIG_SYS_TEXT_BASE		0xA0100000
 #define CONFIG_SKIP_LOWLEVEL_INIT
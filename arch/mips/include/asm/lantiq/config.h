@@ -13,6 +13,29 @@
 #define CONFIG_SYS_MALLOC_LEN		1024*1024
 #define CONFIG_SYS_BOOTPARAMS_LEN	128*1024
 
+/* Optimised memcpy/memmove/memset from arch/mips/lib */
+#define CONFIG_USE_ARCH_MEMCPY
+#define CONFIG_USE_ARCH_MEMSET
+
+/* Slice-by-8 CRC32 in U-Boot, the SPL keeps the 1 KiB byte table */
+#define CONFIG_CRC32_SLICES		8
+
+/* Hash TFTP downloads on the fly, see tftphash/filehash */
+#define CONFIG_TFTP_HASH
+
+/* Queue console output and feed the ASC TX FIFO in the background */
+#define CONFIG_CONSOLE_TX_BUFFER
+
+/* Decompress kernels in NOR flash through a cached bounce buffer */
+#if defined(CONFIG_LTQ_SUPPORT_NOR_FLASH)
+#define CONFIG_BOOTM_PREFETCH
+#endif
+
+/* Attach UBI from the Linux fastmap instead of scanning all PEBs */
+#if defined(CONFIG_CMD_UBI)
+#define CONFIG_MTD_UBI_FASTMAP
+#endif
+
 /* Command line */
 #define CONFIG_SYS_PROMPT		CONFIG_MACH_TYPE " # "
 #define CONFIG_SYS_CBSIZE		512
@@ -32,6 +55,9 @@
 #define CONFIG_CMDLINE_EDITING
 #endif
 
+/* Apply the "dmaprofile" variable to the DMA driver when it changes */
+#define CONFIG_ENV_CALLBACK_LIST_STATIC	"dmaprofile:dmaprofile,"
+
 /* SPI flash SPL */
 #if defined(CONFIG_LTQ_SUPPORT_SPL_SPI_FLASH) && defined(CONFIG_SYS_BOOT_SFSPL)
 #define CONFIG_SPL
@@ -40,6 +66,12 @@
 #define CONFIG_SPI_SPL_SIMPLE
 #endif
 
+/* DMA for SPI flash reads in U-Boot and SPL */
+#if defined(CONFIG_LTQ_SPI_DMA)
+#define CONFIG_LANTIQ_DMA
+#define CONFIG_SPL_DMA_SUPPORT
+#endif
+
 /*
  * NAND flash SPL
  * BOOT CFG 06 only (address cycle based probing, 2KB or 512B page size)
@@ -79,6 +111,28 @@
 #define CONFIG_SPL_LZO_SUPPORT
 #endif
 
+#if defined(CONFIG_LTQ_SPL_COMP_LZMA)
+#define CONFIG_LZMA
+#define CONFIG_SPL_LZMA_SUPPORT
+#endif
+
+#if defined(CONFIG_LTQ_SPL_COMP_GZIP)
+#if !defined(CONFIG_LTQ_SPL_CONSOLE)
+#error "CONFIG_LTQ_SPL_COMP_GZIP needs malloc from CONFIG_LTQ_SPL_CONSOLE"
+#endif
+#define CONFIG_SPL_GZIP_SUPPORT
+#endif
+
+/*
+ * DDR scratch area for decompressor state (LZMA probabilities,
+ * zlib heap), located right below the SPL load buffer
+ */
+#if defined(CONFIG_LTQ_SPL_COMP_LZMA) || defined(CONFIG_LTQ_SPL_COMP_GZIP)
+#define CONFIG_LTQ_SPL_SCRATCH_SIZE	(256 * 1024)
+#define CONFIG_LTQ_SPL_SCRATCH_BASE	(CONFIG_SYS_LOAD_ADDR - \
+					CONFIG_LTQ_SPL_SCRATCH_SIZE)
+#endif
+
 /* Basic commands */
 #define CONFIG_CMD_BDI
 #define CONFIG_CMD_EDITENV
@@ -132,7 +186,8 @@
 	"load-uboot-nor=tftpboot u-boot.bin\0"				\
 	"load-uboot-norspl=tftpboot u-boot.ltq.norspl\0"		\
 	"load-uboot-norspl-lzo=tftpboot u-boot.ltq.lzo.norspl\0"	\
-	"load-uboot-norspl-lzma=tftpboot u-boot.ltq.lzma.norspl\0"
+	"load-uboot-norspl-lzma=tftpboot u-boot.ltq.lzma.norspl\0"	\
+	"load-uboot-norspl-gz=tftpboot u-boot.ltq.gz.norspl\0"
 #else
 #define CONFIG_ENV_WRITE_UBOOT_NOR
 #define CONFIG_ENV_LOAD_UBOOT_NOR
@@ -152,7 +207,8 @@
 #define CONFIG_ENV_LOAD_UBOOT_SF					\
 	"load-uboot-sfspl=tftpboot u-boot.ltq.sfspl\0"			\
 	"load-uboot-sfspl-lzo=tftpboot u-boot.ltq.lzo.sfspl\0"		\
-	"load-uboot-sfspl-lzma=tftpboot u-boot.ltq.lzma.sfspl\0"
+	"load-uboot-sfspl-lzma=tftpboot u-boot.ltq.lzma.sfspl\0"	\
+	"load-uboot-sfspl-gz=tftpboot u-boot.ltq.gz.sfspl\0"
 #else
 #define CONFIG_ENV_SF_PROBE
 #define CONFIG_ENV_WRITE_UBOOT_SF
@@ -168,7 +224,8 @@
 #define CONFIG_ENV_LOAD_UBOOT_NAND						\
 	"load-uboot-nandspl=tftpboot u-boot.ltq.nandspl\0"			\
 	"load-uboot-nandspl-lzo=tftpboot u-boot.ltq.lzo.nandspl\0"		\
-	"load-uboot-nandspl-lzma=tftpboot u-boot.ltq.lzma.nandspl\0"
+	"load-uboot-nandspl-lzma=tftpboot u-boot.ltq.lzma.nandspl\0"		\
+	"load-uboot-nandspl-gz=tftpboot u-boot.ltq.gz.nandspl\0"
 #else
 #define CONFIG_ENV_WRITE_UBOOT_NAND
 #define CONFIG_ENV_LOAD_UBOOT_NAND
@@ -20,11 +20,32 @@ enum ltq_dma_burst_len {
 	LTQ_DMA_BURST_8WORDS = 3,
 };
 
+/* Global DMA tuning, see ltq_dma_profile_set() */
+struct ltq_dma_profile {
+	u16 poll_cnt;		/* descriptor polling interval */
+	u8 pktarb;		/* packet arbitration */
+	u8 drb;			/* descriptor read back */
+	u8 burst;		/* enum ltq_dma_burst_len, 0 keeps client value */
+	int class;		/* channel class, -1 keeps client value */
+	u8 tx_weight;		/* channel TX weight */
+};
+
 struct ltq_dma_desc {
 	u32 ctl;
 	u32 addr;
 };
 
+struct ltq_dma_stats {
+	u32 submitted;		/* descriptors passed to hardware */
+	u32 completed;		/* descriptors returned by hardware */
+	u32 stalls;		/* waits on descriptors owned by hardware */
+	u32 timeouts;
+	u32 dropped;		/* RX descriptors completed without data */
+	u32 overruns;		/* RX descriptor underruns latched by hardware */
+	u64 bytes;
+	u64 cache_cycles;	/* CP0 count cycles in cache maintenance */
+};
+
 struct ltq_dma_channel {
 	struct ltq_dma_device *dev;
 	u8 chan_no;
@@ -33,6 +54,17 @@ struct ltq_dma_channel {
 	struct ltq_dma_desc *desc_base;
 	void *mem_base;
 	u32 dma_addr;
+
+	/* TX ring state, see ltq_dma_tx_ring_init() */
+	u16 head;		/* next descriptor to fill */
+	u16 tail;		/* oldest descriptor owned by hardware */
+	u16 pending;		/* descriptors owned by hardware */
+	void *buf_base;		/* bounce buffers, one per descriptor */
+	unsigned int buf_size;
+	u32 pps_base;
+	unsigned long timebase;
+
+	struct ltq_dma_stats stats;
 };
 
 struct ltq_dma_device {
@@ -43,6 +75,7 @@ struct ltq_dma_device {
 	struct ltq_dma_channel rx_chan;
 	struct ltq_dma_channel tx_chan;
 	u8 port;
+	const char *name;
 };
 
 /**
@@ -57,6 +90,21 @@ void ltq_dma_init(void);
  */
 int ltq_dma_register(struct ltq_dma_device *dev);
 
+/**
+ * Get or change the global DMA profile. Polling and arbitration take
+ * effect immediately, burst length, class and weight the next time a
+ * client enables its channels. In U-Boot proper the profile can also be
+ * set with the "dmaprofile" environment variable, e.g.
+ * "poll=8,pktarb=1,drb=1,burst=8,class=1,weight=3".
+ */
+void ltq_dma_profile_get(struct ltq_dma_profile *profile);
+void ltq_dma_profile_set(const struct ltq_dma_profile *profile);
+
+/**
+ * Clear the statistics of all channels of given DMA client
+ */
+void ltq_dma_stats_reset(struct ltq_dma_device *dev);
+
 /**
  * Reset and halt all channels related to given DMA client
  */
@@ -80,6 +128,22 @@ int ltq_dma_rx_poll(struct ltq_dma_device *dev, int index);
 
 int ltq_dma_rx_length(struct ltq_dma_device *dev, int index);
 
+/**
+ * Invalidate the first @len bytes of a completed RX buffer, i.e. the
+ * received frame, before the CPU reads it.
+ */
+void ltq_dma_rx_sync(struct ltq_dma_device *dev, void *data, int len);
+
+/**
+ * Give a completed RX descriptor back to hardware. Only the first @used
+ * bytes of the buffer could have been touched by the CPU, thus only
+ * these are invalidated.
+ *
+ * @returns 0 on success, negative value otherwise
+ */
+int ltq_dma_rx_release(struct ltq_dma_device *dev, int index, void *data,
+			int len, int used);
+
 /**
  * Map TX DMA descriptor to memory region
  *
@@ -91,4 +155,39 @@ int ltq_dma_tx_map(struct ltq_dma_device *dev, int index, void *data, int len,
 int ltq_dma_tx_wait(struct ltq_dma_device *dev, int index,
 			unsigned long timeout);
 
+/**
+ * Allocate one bounce buffer of given size per TX descriptor. Must be
+ * called after ltq_dma_register().
+ *
+ * @returns 0 on success, negative value otherwise
+ */
+int ltq_dma_tx_ring_init(struct ltq_dma_device *dev, unsigned int buf_size);
+
+/**
+ * Drop all queued TX descriptors and clear the TX counters. Must be
+ * called while the TX channel is disabled.
+ */
+void ltq_dma_tx_ring_reset(struct ltq_dma_device *dev);
+
+/**
+ * Reclaim all TX descriptors completed by hardware
+ *
+ * @returns number of reclaimed descriptors
+ */
+int ltq_dma_tx_ring_reclaim(struct ltq_dma_device *dev);
+
+/**
+ * Copy packet to the next free TX slot and pass it to hardware. Only
+ * waits if the ring is full.
+ *
+ * @returns 0 on success, negative value otherwise
+ */
+int ltq_dma_tx_ring_send(struct ltq_dma_device *dev, const void *data,
+			int len, unsigned long timeout);
+
+/**
+ * @returns packets per second sent since last ltq_dma_tx_ring_reset()
+ */
+unsigned int ltq_dma_tx_ring_pps(struct ltq_dma_device *dev);
+
 #endif /* __LANTIQ_DMA_H__ */
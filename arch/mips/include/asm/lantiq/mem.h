@@ -98,6 +98,8 @@ enum mc_tune_state {
 	MC_TUNE_INVALID,
 	MC_TUNE_VALID,
 	MC_TUNE_VALID_STORED,
+	/* tuned on request for this boot only, flash holds other values */
+	MC_TUNE_VALID_REQUESTED,
 };
 
 #define MC_TUNE_MAGIC	0x4d435455
@@ -119,8 +121,48 @@ static inline struct mc_tune_cfg *mc_tune_data(void)
 	return (struct mc_tune_cfg *)CONFIG_SPL_MC_TUNE_BASE;
 }
 
+enum mc_tune_eye {
+	MC_TUNE_EYE_ECHO_DLL,
+	MC_TUNE_EYE_WRITE_DQ,
+	MC_TUNE_EYE_READ_DQ,
+	MC_TUNE_EYE_COUNT,
+};
+
+#define MC_TUNE_STATS_MAGIC	0x4d435453
+#define MC_TUNE_REQUEST_MAGIC	0x4d435452
+
+/* Coarse step of the eye search, 1 probes every delay */
+#define MC_TUNE_STEP_DEFAULT	4
+#define MC_TUNE_STEP_MAX	16
+
+/* Eyes narrower than this many delay steps are reported as marginal */
+#ifndef CONFIG_LTQ_MC_TUNE_EYE_MIN
+#define CONFIG_LTQ_MC_TUNE_EYE_MIN	6
+#endif
+
+/*
+ * Results of the last tuning run, passed from SPL to U-Boot next to
+ * struct mc_tune_cfg but never stored in flash. With magic set to
+ * MC_TUNE_REQUEST_MAGIC, U-Boot asks the SPL to tune again with the
+ * given step after the next reset.
+ */
+struct mc_tune_stats {
+	u32 magic;
+	u32 step;
+	u32 probes;
+	u32 time_ms;
+	u8 eye[MC_TUNE_EYE_COUNT][2];
+};
+
+static inline struct mc_tune_stats *mc_tune_stats_data(void)
+{
+	return (struct mc_tune_stats *)(CONFIG_SPL_MC_TUNE_BASE + 32);
+}
+
 void mc_tune_dump(const struct mc_tune_cfg *cfg);
-int mc_tune_perform(struct mc_tune_cfg *cfg);
+void mc_tune_dump_stats(const struct mc_tune_stats *stats);
+unsigned int mc_tune_requested(void);
+int mc_tune_perform(struct mc_tune_cfg *cfg, struct mc_tune_stats *stats);
 void mc_tune_apply(const struct mc_tune_cfg *cfg);
 int mc_tune_check(const struct mc_tune_cfg *cfg);
 int mc_tune_load_ram(struct mc_tune_cfg *cfg);
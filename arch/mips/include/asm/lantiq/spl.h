@@ -23,10 +23,17 @@
 #define spl_mc_tune_debug	0
 #endif
 
+#if defined(CONFIG_LTQ_SPL_TIMING)
+#define spl_has_timing		1
+#else
+#define spl_has_timing		0
+#endif
+
 #else
 #define spl_has_console		0
 #define spl_has_debug		0
 #define spl_mc_tune_debug	0
+#define spl_has_timing		0
 #endif
 
 #define spl_debug(fmt, args...)			\
@@ -62,6 +62,26 @@ void arch_lmb_reserve(struct lmb *lmb)
 	lmb_reserve(lmb, sp, CONFIG_SYS_SDRAM_BASE + gd->ram_size - sp);
 }
 
+#if defined(CONFIG_BOOTM_PREFETCH)
+/*
+ * Read flash in KSEG1 through its cached KSEG0 alias, so that every
+ * access fills a whole cache line in one burst. Flash is only written
+ * through KSEG1, drop stale lines of the alias to keep it coherent.
+ */
+const void *image_prefetch_map(ulong addr, ulong len)
+{
+	ulong kseg0;
+
+	if (KSEGX(addr) != KSEG1)
+		return (const void *)addr;
+
+	kseg0 = CKSEG0ADDR(addr);
+	invalidate_dcache_range(kseg0, kseg0 + len);
+
+	return (const void *)kseg0;
+}
+#endif
+
 static int boot_setup_linux(bootm_headers_t *images)
 {
 	int ret;
@@ -317,6 +337,9 @@ static void boot_jump_linux(bootm_headers_t *images)
 	bootstage_report();
 #endif
 
+	/* Linux takes over the UART, pass it all buffered output first */
+	console_flush();
+
 	if (images->ft_len)
 		kernel(-2, (ulong)images->ft_addr, 0, 0);
 	else
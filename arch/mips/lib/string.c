@@ -0,0 +1,179 @@
+/*
+ * Optimised string functions for MIPS32
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifdef USE_HOSTCC
+#include <stddef.h>
+#include <stdint.h>
+typedef uint8_t u8;
+typedef uint32_t u32;
+typedef unsigned long ulong;
+#define __packed	__attribute__((packed))
+#else
+#include <common.h>
+#include <linux/compiler.h>
+#endif
+
+/*
+ * Loads through this type are emitted as lwl/lwr pairs, which fetch a
+ * whole word from an unaligned address in two instructions.
+ */
+struct mips_una_u32 {
+	u32 x;
+} __packed;
+
+#ifndef mips_prefetch
+#define mips_prefetch(p)	__builtin_prefetch(p, 0, 0)
+#endif
+
+/* Prefetch distance in words, two cache lines */
+#define MIPS_PREF_AHEAD		16
+
+/*
+ * Fetch the source two cache lines ahead, but only while the whole line
+ * is still part of the copy. A line past the end could belong to a
+ * buffer that a DMA engine is about to fill, which must not be cached.
+ */
+static inline void mips_pref_load(const void *p, size_t words)
+{
+	if (words >= MIPS_PREF_AHEAD + 8)
+		mips_prefetch((const u32 *)p + MIPS_PREF_AHEAD);
+}
+
+#define MIPS_BLOCK_SIZE		(8 * sizeof(u32))
+
+#ifdef CONFIG_USE_ARCH_MEMCPY
+/*
+ * Forward copy of whole words to an aligned destination. Each block of
+ * eight words is loaded completely before it is stored, so the copy is
+ * also safe for overlapping areas as long as dst is below src.
+ */
+static u32 *mips_copy_words(u32 *dst, const u8 *src, size_t words)
+{
+	u32 a0, a1, a2, a3, a4, a5, a6, a7;
+
+	if (((ulong)src & 3) == 0) {
+		const u32 *s = (const u32 *)src;
+
+		for (; words >= 8; words -= 8, s += 8, dst += 8) {
+			mips_pref_load(s, words);
+			a0 = s[0]; a1 = s[1]; a2 = s[2]; a3 = s[3];
+			a4 = s[4]; a5 = s[5]; a6 = s[6]; a7 = s[7];
+			dst[0] = a0; dst[1] = a1; dst[2] = a2; dst[3] = a3;
+			dst[4] = a4; dst[5] = a5; dst[6] = a6; dst[7] = a7;
+		}
+
+		for (; words; words--)
+			*dst++ = *s++;
+	} else {
+		const struct mips_una_u32 *s = (const struct mips_una_u32 *)src;
+
+		for (; words >= 8; words -= 8, s += 8, dst += 8) {
+			mips_pref_load(s, words);
+			a0 = s[0].x; a1 = s[1].x; a2 = s[2].x; a3 = s[3].x;
+			a4 = s[4].x; a5 = s[5].x; a6 = s[6].x; a7 = s[7].x;
+			dst[0] = a0; dst[1] = a1; dst[2] = a2; dst[3] = a3;
+			dst[4] = a4; dst[5] = a5; dst[6] = a6; dst[7] = a7;
+		}
+
+		for (; words; words--)
+			*dst++ = (s++)->x;
+	}
+
+	return dst;
+}
+
+void *memcpy(void *dest, const void *src, size_t count)
+{
+	u8 *d = dest;
+	const u8 *s = src;
+	size_t words;
+
+	if (src == dest)
+		return dest;
+
+	if (count >= 2 * sizeof(u32)) {
+		/* align the destination, the source is fetched by lwl/lwr */
+		for (; (ulong)d & 3; count--)
+			*d++ = *s++;
+
+		words = count / sizeof(u32);
+		d = (u8 *)mips_copy_words((u32 *)d, s, words);
+		s += words * sizeof(u32);
+		count &= sizeof(u32) - 1;
+	}
+
+	while (count--)
+		*d++ = *s++;
+
+	return dest;
+}
+
+void *memmove(void *dest, const void *src, size_t count)
+{
+	u8 *d = dest;
+	const u8 *s = src;
+	u32 *dw;
+	const struct mips_una_u32 *sw;
+
+	if (d <= s || d >= s + count)
+		return memcpy(dest, src, count);
+
+	/* Overlapping with dest above src: copy backwards */
+	d += count;
+	s += count;
+
+	if (count >= 2 * sizeof(u32)) {
+		for (; (ulong)d & 3; count--)
+			*--d = *--s;
+
+		dw = (u32 *)d;
+		sw = (const struct mips_una_u32 *)s;
+		for (; count >= sizeof(u32); count -= sizeof(u32))
+			*--dw = (--sw)->x;
+
+		d = (u8 *)dw;
+		s = (const u8 *)sw;
+	}
+
+	while (count--)
+		*--d = *--s;
+
+	return dest;
+}
+#endif /* CONFIG_USE_ARCH_MEMCPY */
+
+#ifdef CONFIG_USE_ARCH_MEMSET
+void *memset(void *s, int c, size_t count)
+{
+	u8 *d = s;
+	u32 *dw, v;
+
+	if (count >= 2 * sizeof(u32)) {
+		for (; (ulong)d & 3; count--)
+			*d++ = c;
+
+		v = c & 0xff;
+		v |= v << 8;
+		v |= v << 16;
+
+		for (dw = (u32 *)d; count >= MIPS_BLOCK_SIZE;
+		     count -= MIPS_BLOCK_SIZE, dw += 8) {
+			dw[0] = v; dw[1] = v; dw[2] = v; dw[3] = v;
+			dw[4] = v; dw[5] = v; dw[6] = v; dw[7] = v;
+		}
+
+		for (; count >= sizeof(u32); count -= sizeof(u32))
+			*dw++ = v;
+
+		d = (u8 *)dw;
+	}
+
+	while (count--)
+		*d++ = c;
+
+	return s;
+}
+#endif /* CONFIG_USE_ARCH_MEMSET */
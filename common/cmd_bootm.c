@@ -365,6 +365,50 @@ static int bootm_find_other(cmd_tbl_t *cmdtp, int flag, int argc,
 #define BOOTM_ERR_RESET		-1
 #define BOOTM_ERR_OVERLAP	-2
 #define BOOTM_ERR_UNIMPLEMENTED	-3
+
+#ifdef CONFIG_BOOTM_PREFETCH
+/*
+ * Decompress a kernel from flash through the prefetching reader. If the
+ * data CRC has been deferred by boot_get_kernel(), it is computed from
+ * the same reads instead of a separate pass over flash.
+ */
+static int bootm_load_os_prefetch(bootm_headers_t *images, void *load_buf,
+		ulong unc_len, ulong *load_end, int boot_progress)
+{
+	image_info_t *os = &images->os;
+	ulong size;
+	u32 crc = 0;
+	int ret;
+
+	printf("   Uncompressing %s%s ... ", genimg_get_type_name(os->type),
+		images->verify_deferred ? " and verifying checksum" : "");
+
+	ret = image_prefetch_uncompress(os->comp, os->image_start,
+			os->image_len, load_buf, unc_len, &size,
+			images->verify_deferred ? &crc : NULL);
+
+	if (images->verify_deferred &&
+	    crc != image_get_dcrc(&images->legacy_hdr_os_copy)) {
+		puts("Bad Data CRC - must RESET board to recover\n");
+		bootstage_error(BOOTSTAGE_ID_CHECK_CHECKSUM);
+		return BOOTM_ERR_RESET;
+	}
+
+	if (ret) {
+		printf("%s: uncompress or overwrite error %d "
+			"- must RESET board to recover\n",
+			genimg_get_comp_name(os->comp), ret);
+		if (boot_progress)
+			bootstage_error(BOOTSTAGE_ID_DECOMP_IMAGE);
+		return BOOTM_ERR_RESET;
+	}
+
+	*load_end = os->load + size;
+
+	return 0;
+}
+#endif /* CONFIG_BOOTM_PREFETCH */
+
 static int bootm_load_os(bootm_headers_t *images, unsigned long *load_end,
 		int boot_progress)
 {
@@ -386,6 +430,17 @@ static int bootm_load_os(bootm_headers_t *images, unsigned long *load_end,
 
 	load_buf = map_sysmem(load, unc_len);
 	image_buf = map_sysmem(image_start, image_len);
+
+#ifdef CONFIG_BOOTM_PREFETCH
+	if (images->verify_deferred ||
+	    image_prefetch_wanted(comp, image_start, image_len)) {
+		if (bootm_load_os_prefetch(images, load_buf, unc_len, load_end,
+					   boot_progress))
+			return BOOTM_ERR_RESET;
+		goto loaded;
+	}
+#endif
+
 	switch (comp) {
 	case IH_COMP_NONE:
 		if (load == blob_start || load == image_start) {
@@ -475,6 +530,9 @@ static int bootm_load_os(bootm_headers_t *images, unsigned long *load_end,
 		return BOOTM_ERR_UNIMPLEMENTED;
 	}
 
+#ifdef CONFIG_BOOTM_PREFETCH
+loaded:
+#endif
 	flush_cache(load, (*load_end - load) * sizeof(ulong));
 
 	puts("OK\n");
@@ -541,6 +599,7 @@ static int boot_selected_os(int argc, char * const argv[], int state,
 		bootm_headers_t *images, boot_os_fn *boot_fn)
 {
 	arch_preboot_os();
+	console_flush();
 	boot_fn(state, argc, argv, images);
 
 	/* Stand-alone may return when 'autostart' is 'no' */
@@ -889,6 +948,38 @@ static image_header_t *image_get_kernel(ulong img_addr, int verify)
 	return hdr;
 }
 
+#ifdef CONFIG_BOOTM_PREFETCH
+/*
+ * Kernels read by the prefetching reader are checksummed while they are
+ * decompressed, see bootm_load_os_prefetch(). Only single component
+ * images qualify, the data CRC of multi images covers all components.
+ */
+static int boot_verify_kernel(bootm_headers_t *images,
+		const image_header_t *hdr)
+{
+	images->verify_deferred = 0;
+	if (!images->verify)
+		return 0;
+
+	switch (image_get_type(hdr)) {
+	case IH_TYPE_KERNEL:
+	case IH_TYPE_KERNEL_NOLOAD:
+		images->verify_deferred = image_prefetch_wanted(
+			image_get_comp(hdr), image_get_data(hdr),
+			image_get_data_size(hdr));
+		break;
+	}
+
+	return !images->verify_deferred;
+}
+#else
+static inline int boot_verify_kernel(bootm_headers_t *images,
+		const image_header_t *hdr)
+{
+	return images->verify;
+}
+#endif
+
 /**
  * boot_get_kernel - find kernel image
  * @os_data: pointer to a ulong variable, will hold os data start address
@@ -946,7 +1037,8 @@ static const void *boot_get_kernel(cmd_tbl_t *cmdtp, int flag, int argc,
 	case IMAGE_FORMAT_LEGACY:
 		printf("## Booting kernel from Legacy Image at %08lx ...\n",
 				img_addr);
-		hdr = image_get_kernel(img_addr, images->verify);
+		hdr = image_get_kernel(img_addr,
+				boot_verify_kernel(images, buf));
 		if (!hdr)
 			return NULL;
 		bootstage_mark(BOOTSTAGE_ID_CHECK_IMAGETYPE);
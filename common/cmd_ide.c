@@ -951,6 +951,8 @@ ulong ide_write(int device, lbaint_t blknr, lbaint_t blkcnt, const void *buffer)
 	}
 #endif
 
+	dev_changed(&ide_dev_desc[device]);
+
 	ide_led(DEVICE_LED(device), 1);	/* LED on       */
 
 	/* Select device
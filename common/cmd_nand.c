@@ -27,6 +27,8 @@
 #include <asm/byteorder.h>
 #include <jffs2/jffs2.h>
 #include <nand.h>
+#include <div64.h>
+#include <linux/mtd/nand_ecc.h>
 
 #if defined(CONFIG_CMD_MTDPARTS)
 
@@ -462,6 +464,67 @@ static void adjust_size_for_badblocks(loff_t *size, loff_t offset, int dev)
 	}
 }
 
+#ifdef CONFIG_CMD_NAND_BENCH
+static ulong nand_bench_kbps(unsigned long long bytes, ulong time_ms)
+{
+	if (!time_ms)
+		return 0;
+
+	bytes *= 1000;
+	do_div(bytes, time_ms * 1024);
+
+	return bytes;
+}
+
+/*
+ * Measure the read throughput of the NAND flash including ECC and, for
+ * software ECC, the share of the ECC calculation alone.
+ */
+static int nand_bench(nand_info_t *nand, u_char *buf, loff_t off, size_t size,
+		      loff_t maxsize, ulong count)
+{
+	struct nand_chip *chip = nand->priv;
+	size_t rwsize;
+	ulong i, time_ms;
+	u_char ecc[3];
+	int ret;
+
+	time_ms = get_timer(0);
+	for (i = 0; i < count; i++) {
+		rwsize = size;
+		ret = nand_read_skip_bad(nand, off, &rwsize, NULL, maxsize,
+					 buf);
+		if (ret && !mtd_is_bitflip(ret)) {
+			printf("NAND bench: read failed at 0x%llx, ret %d\n",
+			       (long long)off, ret);
+			return 1;
+		}
+	}
+	time_ms = get_timer(time_ms);
+
+	printf("NAND bench: %zu bytes x %lu in %lu ms, %lu KiB/s\n",
+	       size, count, time_ms,
+	       nand_bench_kbps((unsigned long long)size * count, time_ms));
+
+	if (chip->ecc.mode != NAND_ECC_SOFT)
+		return 0;
+
+	time_ms = get_timer(0);
+	for (i = 0; i < count; i++) {
+		size_t pos;
+
+		for (pos = 0; pos + 256 <= size; pos += 256)
+			nand_calculate_ecc(nand, buf + pos, ecc);
+	}
+	time_ms = get_timer(time_ms);
+
+	printf("NAND bench: soft ECC %lu KiB/s\n",
+	       nand_bench_kbps((unsigned long long)size * count, time_ms));
+
+	return 0;
+}
+#endif
+
 static int do_nand(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	int i, ret = 0;
@@ -740,6 +803,27 @@ static int do_nand(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 		return ret == 0 ? 0 : 1;
 	}
 
+#ifdef CONFIG_CMD_NAND_BENCH
+	if (strcmp(cmd, "bench") == 0) {
+		ulong count = 1;
+
+		if (argc < 5)
+			goto usage;
+
+		addr = (ulong)simple_strtoul(argv[2], NULL, 16);
+		if (arg_off_size(2, argv + 3, &dev, &off, &size, &maxsize))
+			return 1;
+
+		if (argc > 5 && (!str2long(argv[5], &count) || !count)) {
+			printf("'%s' is not a valid count\n", argv[5]);
+			return 1;
+		}
+
+		return nand_bench(&nand_info[dev], (u_char *)addr, off, size,
+				  maxsize, count);
+	}
+#endif
+
 #ifdef CONFIG_CMD_NAND_TORTURE
 	if (strcmp(cmd, "torture") == 0) {
 		if (argc < 3)
@@ -872,6 +956,10 @@ static char nand_help_text[] =
 	"nand dump[.oob] off - dump page\n"
 #ifdef CONFIG_CMD_NAND_TORTURE
 	"nand torture off - torture block at offset\n"
+#endif
+#ifdef CONFIG_CMD_NAND_BENCH
+	"nand bench addr off|partition size [count] - measure read\n"
+	"    throughput of 'size' bytes at 'off', 'count' times\n"
 #endif
 	"nand scrub [-y] off size | scrub.part partition | scrub.chip\n"
 	"    really clean NAND erasing bad blocks (UNSAFE)\n"
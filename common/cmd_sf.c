@@ -488,6 +488,75 @@ static int do_spi_flash_test(int argc, char * const argv[])
 }
 #endif /* CONFIG_CMD_SF_TEST */
 
+#ifdef CONFIG_CMD_SF_BENCH
+/**
+ * Measure the read throughput of the SPI flash
+ *
+ * Reads the same range repeatedly so that the result reflects the bus
+ * and the read command picked by the probe rather than timer jitter.
+ */
+static int do_spi_flash_bench(int argc, char * const argv[])
+{
+	unsigned long addr, offset, len, count = 1, i;
+	unsigned long long bytes;
+	ulong time_ms, kbps;
+	char *endp;
+	void *buf;
+
+	if (argc < 4)
+		return -1;
+
+	addr = simple_strtoul(argv[1], &endp, 16);
+	if (*argv[1] == 0 || *endp != 0)
+		return -1;
+	offset = simple_strtoul(argv[2], &endp, 16);
+	if (*argv[2] == 0 || *endp != 0)
+		return -1;
+	len = simple_strtoul(argv[3], &endp, 16);
+	if (*argv[3] == 0 || *endp != 0)
+		return -1;
+	if (argc > 4) {
+		count = simple_strtoul(argv[4], &endp, 10);
+		if (*argv[4] == 0 || *endp != 0 || !count)
+			return -1;
+	}
+
+	if (offset + len > flash->size) {
+		printf("ERROR: attempting read past flash size (%#x)\n",
+		       flash->size);
+		return 1;
+	}
+
+	printf("SF: read cmd %#02x, %d dummy byte(s)\n", flash->read_cmd,
+	       flash->dummy_byte);
+
+	buf = map_physmem(addr, len, MAP_WRBACK);
+	time_ms = get_timer(0);
+	for (i = 0; i < count; i++) {
+		if (spi_flash_read(flash, offset, len, buf)) {
+			unmap_physmem(buf, len);
+			printf("SF: read failed\n");
+			return 1;
+		}
+	}
+	time_ms = get_timer(time_ms);
+	unmap_physmem(buf, len);
+
+	bytes = (unsigned long long)len * count;
+	kbps = 0;
+	if (time_ms) {
+		bytes *= 1000;
+		do_div(bytes, time_ms * 1024);
+		kbps = bytes;
+	}
+
+	printf("SF: %lu x %lu bytes in %lu ms, %lu KiB/s\n", count, len,
+	       time_ms, kbps);
+
+	return 0;
+}
+#endif /* CONFIG_CMD_SF_BENCH */
+
 static int do_spi_flash(cmd_tbl_t *cmdtp, int flag, int argc,
 			char * const argv[])
 {
@@ -521,6 +590,10 @@ static int do_spi_flash(cmd_tbl_t *cmdtp, int flag, int argc,
 #ifdef CONFIG_CMD_SF_TEST
 	else if (!strcmp(cmd, "test"))
 		ret = do_spi_flash_test(argc, argv);
+#endif
+#ifdef CONFIG_CMD_SF_BENCH
+	else if (!strcmp(cmd, "bench"))
+		ret = do_spi_flash_bench(argc, argv);
 #endif
 	else
 		ret = -1;
@@ -540,8 +613,15 @@ usage:
 #define SF_TEST_HELP
 #endif
 
+#ifdef CONFIG_CMD_SF_BENCH
+#define SF_BENCH_HELP "\nsf bench addr offset len [count]	" \
+		"- measure read throughput"
+#else
+#define SF_BENCH_HELP
+#endif
+
 U_BOOT_CMD(
-	sf,	5,	1,	do_spi_flash,
+	sf,	6,	1,	do_spi_flash,
 	"SPI flash sub-system",
 	"probe [[bus:]cs] [hz] [mode]	- init flash device on given SPI bus\n"
 	"				  and chip select\n"
@@ -554,4 +634,5 @@ U_BOOT_CMD(
 	"sf update addr offset len	- erase and write `len' bytes from memory\n"
 	"				  at `addr' to flash at `offset'"
 	SF_TEST_HELP
+	SF_BENCH_HELP
 );
@@ -38,6 +38,7 @@ static int ubi_initialized;
 
 struct selected_dev {
 	char part_name[80];
+	char vid_header_offset[16];
 	int selected;
 	int nr;
 	struct mtd_info *mtd_info;
@@ -167,6 +168,40 @@ bad:
 	return err;
 }
 
+#ifdef CONFIG_MTD_UBI_FASTMAP
+/*
+ * A device attached from the fastmap written by Linux is read-only, as
+ * U-Boot cannot update the fastmap. Attach it again by scanning before
+ * anything is changed.
+ */
+static int ubi_make_writable(void)
+{
+	char part_name[sizeof(ubi_dev.part_name)];
+	char vid_header_offset[sizeof(ubi_dev.vid_header_offset)];
+	int err;
+
+	if (!ubi->fm_attached)
+		return 0;
+
+	printf("UBI attached from fastmap, scanning for write access\n");
+
+	strcpy(part_name, ubi_dev.part_name);
+	strcpy(vid_header_offset, ubi_dev.vid_header_offset);
+
+	ubi_fastmap_disabled = 1;
+	err = ubi_part(part_name, vid_header_offset[0] ?
+		       vid_header_offset : NULL);
+	ubi_fastmap_disabled = 0;
+
+	return err;
+}
+#else
+static inline int ubi_make_writable(void)
+{
+	return 0;
+}
+#endif
+
 static int ubi_create_vol(char *volume, int64_t size, int dynamic)
 {
 	struct ubi_mkvol_req req;
@@ -308,6 +343,10 @@ int ubi_volume_begin_write(char *volume, void *buf, size_t size,
 	int rsvd_bytes = 0;
 	struct ubi_volume *vol;
 
+	err = ubi_make_writable();
+	if (err)
+		return err;
+
 	vol = ubi_find_volume(volume);
 	if (vol == NULL)
 		return ENODEV;
@@ -501,6 +540,10 @@ int ubi_part(char *part_name, const char *vid_header_offset)
 	ubi_dev.selected = 1;
 
 	strcpy(ubi_dev.part_name, part_name);
+	ubi_dev.vid_header_offset[0] = '\0';
+	if (vid_header_offset)
+		strncat(ubi_dev.vid_header_offset, vid_header_offset,
+			sizeof(ubi_dev.vid_header_offset) - 1);
 	err = ubi_dev_scan(ubi_dev.mtd_info, ubi_dev.part_name,
 			vid_header_offset);
 	if (err) {
@@ -558,6 +601,13 @@ static int do_ubi(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 		return ubi_info(layout);
 	}
 
+	if (strncmp(argv[1], "create", 6) == 0 ||
+	    strncmp(argv[1], "remove", 6) == 0) {
+		int err = ubi_make_writable();
+		if (err)
+			return err;
+	}
+
 	if (strncmp(argv[1], "create", 6) == 0) {
 		int dynamic = 1;	/* default: dynamic volume */
 
@@ -89,6 +89,32 @@ int do_ubifs_umount(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 	return 0;
 }
 
+int do_ubifs_info(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+{
+	struct ubifs_info *c;
+
+	if (!ubifs_mounted) {
+		printf("UBIFS not mounted, use ubifsmount to mount volume first!\n");
+		return -1;
+	}
+
+	c = ubifs_sb->s_fs_info;
+	printf("Volume:     %s\n", c->vi.name);
+	printf("TNC cache:  %ld KiB", c->tnc_cache_sz >> 10);
+	if (c->tnc_cache_max)
+		printf(" of %ld KiB", c->tnc_cache_max >> 10);
+	printf(", znode %lu/%lu hits, leaf %lu/%lu hits\n",
+	       c->zn_hits, c->zn_hits + c->zn_misses,
+	       c->lnc_hits, c->lnc_hits + c->lnc_misses);
+	if (c->bulk_read)
+		printf("Bulk-read:  %lu reads, %lu data nodes\n",
+		       c->bu_reads, c->bu_nodes);
+	else
+		printf("Bulk-read:  disabled\n");
+
+	return 0;
+}
+
 int do_ubifs_ls(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	char *filename = "/";
@@ -163,6 +189,12 @@ U_BOOT_CMD(
 	"    - unmount current volume"
 );
 
+U_BOOT_CMD(
+	ubifsinfo, 1, 0, do_ubifs_info,
+	"print UBIFS cache statistics",
+	"    - print TNC cache usage and hit rates of the mounted volume"
+);
+
 U_BOOT_CMD(
 	ubifsls, 2, 0, do_ubifs_ls,
 	"list files in a directory",
@@ -96,6 +96,125 @@ extern int overwrite_console(void);
 
 #endif /* CONFIG_SYS_CONSOLE_IS_IN_ENV */
 
+#if defined(CONFIG_CONSOLE_TX_BUFFER) && !defined(CONFIG_SPL_BUILD)
+/** Buffered console output ***********************************************/
+
+#ifndef CONFIG_CONSOLE_TX_BUFFER_SIZE
+#define CONFIG_CONSOLE_TX_BUFFER_SIZE	4096
+#endif
+
+#define TX_BUF_IDX(idx) ((idx) % (unsigned int)CONFIG_CONSOLE_TX_BUFFER_SIZE)
+
+/*
+ * Output to devices with a write_nb() method is queued here and handed
+ * to the device whenever it can take more without waiting, e.g. when
+ * the UART FIFO has room again. Head and tail are free running.
+ */
+static char console_tx_buf[CONFIG_CONSOLE_TX_BUFFER_SIZE];
+static unsigned int console_tx_head;
+static unsigned int console_tx_tail;
+static struct stdio_dev *console_tx_dev;
+
+static inline int console_tx_pending(void)
+{
+	return console_tx_head != console_tx_tail;
+}
+
+/* Pass as much queued output to the device as it takes right now */
+static void console_tx_drain(void)
+{
+	unsigned int idx, len, n;
+
+	while (console_tx_pending()) {
+		idx = TX_BUF_IDX(console_tx_tail);
+		len = min(console_tx_head - console_tx_tail,
+			  CONFIG_CONSOLE_TX_BUFFER_SIZE - idx);
+
+		n = console_tx_dev->write_nb(console_tx_buf + idx, len);
+		if (!n)
+			break;
+
+		console_tx_tail += n;
+	}
+}
+
+void console_flush(void)
+{
+	/* hang() and panic() may get here before the devices are set up */
+	if (!(gd->flags & GD_FLG_DEVINIT))
+		return;
+
+	while (console_tx_pending())
+		console_tx_drain();
+}
+
+static void console_tx_write(struct stdio_dev *dev, const char *s,
+			     unsigned int len)
+{
+	unsigned int n;
+
+	/* the queue only ever holds output for one device */
+	if (dev != console_tx_dev) {
+		console_flush();
+		console_tx_dev = dev;
+	}
+
+	console_tx_drain();
+
+	/* nothing queued, pass what fits directly to the device */
+	if (!console_tx_pending()) {
+		n = dev->write_nb(s, len);
+		s += n;
+		len -= n;
+	}
+
+	while (len) {
+		/* only wait for the device if the queue is full */
+		if (console_tx_head - console_tx_tail ==
+		    CONFIG_CONSOLE_TX_BUFFER_SIZE) {
+			console_tx_drain();
+			continue;
+		}
+
+		console_tx_buf[TX_BUF_IDX(console_tx_head++)] = *s++;
+		len--;
+	}
+}
+
+static void console_dev_putc(struct stdio_dev *dev, const char c)
+{
+	if (dev->write_nb)
+		console_tx_write(dev, &c, 1);
+	else
+		dev->putc(c);
+}
+
+static void console_dev_puts(struct stdio_dev *dev, const char *s)
+{
+	if (dev->write_nb)
+		console_tx_write(dev, s, strlen(s));
+	else
+		dev->puts(s);
+}
+#else
+static inline int console_tx_pending(void)
+{
+	return 0;
+}
+
+static inline void console_tx_drain(void) {}
+
+static inline void console_dev_putc(struct stdio_dev *dev, const char c)
+{
+	dev->putc(c);
+}
+
+static inline void console_dev_puts(struct stdio_dev *dev, const char *s)
+{
+	dev->puts(s);
+}
+#endif /* CONFIG_CONSOLE_TX_BUFFER */
+
 static int console_setfile(int file, struct stdio_dev * dev)
 {
 	int error = 0;
@@ -103,6 +222,9 @@ static int console_setfile(int file, struct stdio_dev * dev)
 	if (dev == NULL)
 		return -1;
 
+	/* Keep the order of output across the switch */
+	console_flush();
+
 	switch (file) {
 	case stdin:
 	case stdout:
@@ -194,7 +316,7 @@ static void console_putc(int file, const char c)
 	for (i = 0; i < cd_count[file]; i++) {
 		dev = console_devices[file][i];
 		if (dev->putc != NULL)
-			dev->putc(c);
+			console_dev_putc(dev, c);
 	}
 }
 
@@ -206,7 +328,7 @@ static void console_puts(int file, const char *s)
 	for (i = 0; i < cd_count[file]; i++) {
 		dev = console_devices[file][i];
 		if (dev->puts != NULL)
-			dev->puts(s);
+			console_dev_puts(dev, s);
 	}
 }
 
@@ -232,12 +354,12 @@ static inline int console_tstc(int file)
 
 static inline void console_putc(int file, const char c)
 {
-	stdio_devices[file]->putc(c);
+	console_dev_putc(stdio_devices[file], c);
 }
 
 static inline void console_puts(int file, const char *s)
 {
-	stdio_devices[file]->puts(s);
+	console_dev_puts(stdio_devices[file], s);
 }
 
 static inline void console_printdevs(int file)
@@ -267,6 +389,8 @@ int serial_printf(const char *fmt, ...)
 	i = vscnprintf(printbuffer, sizeof(printbuffer), fmt, args);
 	va_end(args);
 
+	/* Bypasses the console, keep the order of output */
+	console_flush();
 	serial_puts(printbuffer);
 	return i;
 }
@@ -274,6 +398,10 @@ int serial_printf(const char *fmt, ...)
 int fgetc(int file)
 {
 	if (file < MAX_FILES) {
+		/* Keep queued output going while waiting for input */
+		while (console_tx_pending() && !console_tstc(file))
+			console_tx_drain();
+
 #if defined(CONFIG_CONSOLE_MUX)
 		/*
 		 * Effectively poll for input wherever it may be available.
@@ -304,8 +432,10 @@ int fgetc(int file)
 
 int ftstc(int file)
 {
-	if (file < MAX_FILES)
+	if (file < MAX_FILES) {
+		console_tx_drain();
 		return console_tstc(file);
+	}
 
 	return -1;
 }
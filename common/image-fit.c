@@ -16,6 +16,8 @@
 #else
 #include <common.h>
 #include <errno.h>
+#include <hash.h>
+#include <watchdog.h>
 #include <asm/io.h>
 DECLARE_GLOBAL_DATA_PTR;
 #endif /* !USE_HOSTCC*/
@@ -870,9 +872,54 @@ int fit_set_timestamp(void *fit, int noffset, time_t timestamp)
  *     0, on success
  *    -1, when algo is unsupported
  */
+#if !defined(USE_HOSTCC) && !defined(CONFIG_SPL_BUILD)
+/*
+ * Hash the data in watchdog sized chunks through the progressive interface
+ * of common/hash.c.
+ */
+static int calculate_hash_progressive(struct hash_algo *hash, const void *data,
+				      int data_len, uint8_t *value,
+				      int *value_len)
+{
+	const uint8_t *p = data;
+	void *ctx;
+	int chunk, ret;
+
+	ret = hash->hash_init(hash, &ctx);
+	if (ret)
+		return ret;
+
+	do {
+		chunk = min(data_len, hash->chunk_size);
+		data_len -= chunk;
+		ret = hash->hash_update(hash, ctx, p, chunk, data_len == 0);
+		if (ret)
+			return ret;
+		p += chunk;
+		WATCHDOG_RESET();
+	} while (data_len > 0);
+
+	ret = hash->hash_finish(hash, ctx, value, FIT_MAX_HASH_LEN);
+	if (ret)
+		return ret;
+	*value_len = hash->digest_size;
+
+	return 0;
+}
+#endif
+
 int calculate_hash(const void *data, int data_len, const char *algo,
 			uint8_t *value, int *value_len)
 {
+#if !defined(USE_HOSTCC) && !defined(CONFIG_SPL_BUILD)
+	struct hash_algo *hash;
+
+	if (!hash_progressive_lookup_algo(algo, &hash) &&
+	    hash->digest_size <= FIT_MAX_HASH_LEN)
+		return calculate_hash_progressive(hash, data, data_len, value,
+						  value_len);
+#endif
+
 	if (IMAGE_ENABLE_CRC32 && strcmp(algo, "crc32") == 0) {
 		*((uint32_t *)value) = crc32_wd(0, data, data_len,
 							CHUNKSZ_CRC32);
@@ -0,0 +1,364 @@
+/*
+ * Prefetching reader for compressed images in memory-mapped flash
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <watchdog.h>
+#include <image.h>
+#include <malloc.h>
+#include <u-boot/zlib.h>
+#include <asm/io.h>
+#include <asm/unaligned.h>
+#include <linux/compiler.h>
+
+#ifdef CONFIG_LZMA
+#include <lzma/LzmaTypes.h>
+#include <lzma/LzmaDec.h>
+#endif
+
+#ifdef CONFIG_LZO
+#include <linux/lzo.h>
+#endif
+
+/* Bytes fetched from flash per step, should fit into the D-cache */
+#ifndef CONFIG_BOOTM_PREFETCH_SIZE
+#define CONFIG_BOOTM_PREFETCH_SIZE	(16 * 1024)
+#endif
+
+/* An lzop block is decoded in one go and has at most 256 KiB */
+#define PREFETCH_LZO_BLOCK_MAX		(256 * 1024 + 12)
+
+/* LZMA header: 5 bytes properties, 8 bytes uncompressed size */
+#define PREFETCH_LZMA_SIZE_OFFSET	LZMA_PROPS_SIZE
+#define PREFETCH_LZMA_DATA_OFFSET	(LZMA_PROPS_SIZE + 8)
+
+/*
+ * State of the reader. Flash is copied in sequential chunks behind the
+ * input the decompressor has not consumed yet, checksummed and then
+ * decompressed while it is still hot in the data cache.
+ */
+struct image_prefetch {
+	const u8 *src;		/* next byte to fetch from flash */
+	ulong left;		/* bytes not fetched yet */
+	u8 *buf;		/* bounce buffer */
+	ulong size;		/* size of bounce buffer */
+	const u8 *rp;		/* decompressor read position */
+	u8 *wp;			/* end of fetched data */
+	u32 crc;
+	int verify;
+};
+
+/*
+ * Map the image for reading. Architectures override this to read
+ * uncached flash through a cached alias.
+ */
+__weak const void *image_prefetch_map(ulong addr, ulong len)
+{
+	return map_sysmem(addr, len);
+}
+
+int image_prefetch_wanted(uint8_t comp, ulong addr, ulong len)
+{
+	switch (comp) {
+#ifdef CONFIG_GZIP
+	case IH_COMP_GZIP:
+#endif
+#ifdef CONFIG_LZMA
+	case IH_COMP_LZMA:
+#endif
+#ifdef CONFIG_LZO
+	case IH_COMP_LZO:
+#endif
+		break;
+	default:
+		return 0;
+	}
+
+	if (getenv_yesno("bootm_prefetch") == 0)
+		return 0;
+
+#ifndef CONFIG_SYS_NO_FLASH
+	/* images in RAM are fast enough already */
+	return addr2info(addr) != NULL;
+#else
+	return 0;
+#endif
+}
+
+static int prefetch_fill(struct image_prefetch *p)
+{
+	ulong keep = p->wp - p->rp;
+	ulong len = min3(p->left, (ulong)CONFIG_BOOTM_PREFETCH_SIZE,
+			 p->size - keep);
+
+	if (!len)
+		return -1;
+
+	if (p->rp != p->buf) {
+		memmove(p->buf, p->rp, keep);
+		p->rp = p->buf;
+		p->wp = p->buf + keep;
+	}
+
+	bootstage_start(BOOTSTAGE_ID_ACCUM_BOOTM_READ, "bootm_read");
+	memcpy(p->wp, p->src, len);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_BOOTM_READ);
+
+	if (p->verify) {
+		bootstage_start(BOOTSTAGE_ID_ACCUM_BOOTM_CRC, "bootm_crc");
+		p->crc = crc32(p->crc, p->wp, len);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_BOOTM_CRC);
+	}
+
+	p->src += len;
+	p->left -= len;
+	p->wp += len;
+	WATCHDOG_RESET();
+
+	return 0;
+}
+
+#ifdef CONFIG_GZIP
+static int prefetch_gunzip(struct image_prefetch *p, void *dst,
+			   ulong dst_len, ulong *out_len)
+{
+	z_stream s;
+	int offset, r;
+
+	if (prefetch_fill(p))
+		return -1;
+
+	offset = gzip_parse_header(p->rp, p->wp - p->rp);
+	if (offset < 0)
+		return offset;
+	p->rp += offset;
+
+	s.zalloc = gzalloc;
+	s.zfree = gzfree;
+
+	r = inflateInit2(&s, -MAX_WBITS);
+	if (r != Z_OK)
+		return r;
+
+	s.next_out = dst;
+	s.avail_out = dst_len;
+	for (;;) {
+		s.next_in = (u8 *)p->rp;
+		s.avail_in = p->wp - p->rp;
+
+		bootstage_start(BOOTSTAGE_ID_ACCUM_BOOTM_DECOMP,
+				"bootm_decomp");
+		r = inflate(&s, Z_NO_FLUSH);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_BOOTM_DECOMP);
+		p->rp = s.next_in;
+
+		if (r == Z_STREAM_END) {
+			r = Z_OK;
+			break;
+		}
+
+		/* Z_BUF_ERROR only means that all input has been consumed */
+		if (r != Z_OK && r != Z_BUF_ERROR)
+			break;
+
+		/* output buffer full before the end of the stream */
+		if (!s.avail_out) {
+			r = Z_BUF_ERROR;
+			break;
+		}
+
+		if (prefetch_fill(p)) {
+			r = Z_BUF_ERROR;
+			break;
+		}
+	}
+
+	*out_len = s.next_out - (u8 *)dst;
+	inflateEnd(&s);
+
+	return r;
+}
+#endif /* CONFIG_GZIP */
+
+#ifdef CONFIG_LZMA
+static void *prefetch_lzma_alloc(void *p, size_t size)
+{
+	return malloc(size);
+}
+
+static void prefetch_lzma_free(void *p, void *address)
+{
+	free(address);
+}
+
+static ISzAlloc prefetch_lzma_allocator = {
+	.Alloc = prefetch_lzma_alloc,
+	.Free = prefetch_lzma_free,
+};
+
+static int prefetch_unlzma(struct image_prefetch *p, void *dst,
+			   ulong dst_len, ulong *out_len)
+{
+	ELzmaStatus status = LZMA_STATUS_NOT_SPECIFIED;
+	CLzmaDec lzma;
+	SizeT limit, len;
+	u32 size_hi;
+	int known = 1;
+	SRes res;
+
+	if (prefetch_fill(p) || p->wp - p->rp < PREFETCH_LZMA_DATA_OFFSET)
+		return SZ_ERROR_INPUT_EOF;
+
+	/* the size field is all ones if unknown, use the buffer size */
+	limit = get_unaligned_le32(p->rp + PREFETCH_LZMA_SIZE_OFFSET);
+	size_hi = get_unaligned_le32(p->rp + PREFETCH_LZMA_SIZE_OFFSET + 4);
+	if (size_hi == 0xffffffff && limit == 0xffffffff) {
+		limit = dst_len;
+		known = 0;
+	} else if (size_hi) {
+		return SZ_ERROR_DATA;
+	} else if (limit > dst_len) {
+		return SZ_ERROR_OUTPUT_EOF;
+	}
+
+	LzmaDec_Construct(&lzma);
+	res = LzmaDec_AllocateProbs(&lzma, p->rp, LZMA_PROPS_SIZE,
+				    &prefetch_lzma_allocator);
+	if (res != SZ_OK)
+		return res;
+
+	lzma.dic = dst;
+	lzma.dicBufSize = dst_len;
+	LzmaDec_Init(&lzma);
+	p->rp += PREFETCH_LZMA_DATA_OFFSET;
+
+	for (;;) {
+		len = p->wp - p->rp;
+
+		bootstage_start(BOOTSTAGE_ID_ACCUM_BOOTM_DECOMP,
+				"bootm_decomp");
+		res = LzmaDec_DecodeToDic(&lzma, limit, p->rp, &len,
+					  LZMA_FINISH_ANY, &status);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_BOOTM_DECOMP);
+		p->rp += len;
+
+		if (res != SZ_OK || status == LZMA_STATUS_FINISHED_WITH_MARK ||
+		    lzma.dicPos == limit)
+			break;
+
+		if (prefetch_fill(p)) {
+			res = SZ_ERROR_INPUT_EOF;
+			break;
+		}
+	}
+
+	/* without a size only the end marker finishes the stream */
+	if (res == SZ_OK && !known && status != LZMA_STATUS_FINISHED_WITH_MARK)
+		res = SZ_ERROR_OUTPUT_EOF;
+
+	*out_len = lzma.dicPos;
+	LzmaDec_FreeProbs(&lzma, &prefetch_lzma_allocator);
+
+	return res;
+}
+#endif /* CONFIG_LZMA */
+
+#ifdef CONFIG_LZO
+static int prefetch_unlzo(struct image_prefetch *p, void *dst,
+			  ulong dst_len, ulong *out_len)
+{
+	u8 *op = dst;
+	size_t left = dst_len;
+	int r;
+
+	if (prefetch_fill(p))
+		return LZO_E_INPUT_OVERRUN;
+
+	p->rp = lzop_parse_header(p->rp);
+	if (!p->rp)
+		return LZO_E_ERROR;
+
+	for (;;) {
+		bootstage_start(BOOTSTAGE_ID_ACCUM_BOOTM_DECOMP,
+				"bootm_decomp");
+		r = lzop_decompress_block(&p->rp, p->wp - p->rp, &op, &left);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_BOOTM_DECOMP);
+
+		if (r == LZOP_E_END) {
+			r = LZO_E_OK;
+			break;
+		}
+
+		if (r == LZO_E_OK)
+			continue;
+
+		/* fetch until the whole block is in the buffer */
+		if (r != LZO_E_INPUT_OVERRUN || prefetch_fill(p))
+			break;
+	}
+
+	*out_len = op - (u8 *)dst;
+
+	return r;
+}
+#endif /* CONFIG_LZO */
+
+int image_prefetch_uncompress(uint8_t comp, ulong src, ulong src_len,
+			      void *dst, ulong dst_len, ulong *out_len,
+			      uint32_t *crc)
+{
+	struct image_prefetch p;
+	int ret;
+
+	memset(&p, 0, sizeof(p));
+	p.size = CONFIG_BOOTM_PREFETCH_SIZE;
+#ifdef CONFIG_LZO
+	if (comp == IH_COMP_LZO)
+		p.size += PREFETCH_LZO_BLOCK_MAX;
+#endif
+
+	p.buf = malloc(p.size);
+	if (!p.buf)
+		return -1;
+
+	p.src = image_prefetch_map(src, src_len);
+	p.left = src_len;
+	p.rp = p.buf;
+	p.wp = p.buf;
+	p.verify = crc != NULL;
+	*out_len = 0;
+
+	switch (comp) {
+#ifdef CONFIG_GZIP
+	case IH_COMP_GZIP:
+		ret = prefetch_gunzip(&p, dst, dst_len, out_len);
+		break;
+#endif
+#ifdef CONFIG_LZMA
+	case IH_COMP_LZMA:
+		ret = prefetch_unlzma(&p, dst, dst_len, out_len);
+		break;
+#endif
+#ifdef CONFIG_LZO
+	case IH_COMP_LZO:
+		ret = prefetch_unlzo(&p, dst, dst_len, out_len);
+		break;
+#endif
+	default:
+		ret = -1;
+		break;
+	}
+
+	/* the checksum also covers data after the end of the stream */
+	if (p.verify) {
+		for (p.rp = p.wp; !prefetch_fill(&p); p.rp = p.wp)
+			;
+		*crc = p.crc;
+	}
+
+	free(p.buf);
+
+	return ret;
+}
@@ -67,6 +67,7 @@ static void drv_system_init (void)
 	dev.flags = DEV_FLAGS_OUTPUT | DEV_FLAGS_INPUT | DEV_FLAGS_SYSTEM;
 	dev.putc = serial_putc;
 	dev.puts = serial_puts;
+	dev.write_nb = serial_write_nb;
 	dev.getc = serial_getc;
 	dev.tstc = serial_tstc;
 	stdio_register (&dev);
@@ -1125,6 +1125,7 @@ unsigned long usb_stor_write(int device, lbaint_t blknr,
 		return 0;
 
 	device &= 0xff;
+	dev_changed(&usb_dev_desc[device]);
 	/* Setup  device */
 	debug("\nusb_write: dev %d \n", device);
 	dev = NULL;
@@ -51,6 +51,20 @@ static const struct block_drvr block_drvr[] = {
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/*
+ * Give the device a new generation number after it was (re)initialized
+ * or written to behind the back of the file systems. Anything cached
+ * under the old number, like the FAT mount cache, is stale. The counter
+ * is global so that a descriptor that is cleared and set up again never
+ * gets an old number back.
+ */
+void dev_changed(block_dev_desc_t *dev_desc)
+{
+	static unsigned long gen;
+
+	dev_desc->gen = ++gen;
+}
+
 #ifdef HAVE_BLOCK_DEVICE
 block_dev_desc_t *get_dev(const char *ifname, int dev)
 {
@@ -219,6 +233,8 @@ void dev_print (block_dev_desc_t *dev_desc)
 
 void init_part (block_dev_desc_t * dev_desc)
 {
+	dev_changed(dev_desc);
+
 #ifdef CONFIG_ISO_PARTITION
 	if (test_part_iso(dev_desc) == 0) {
 		dev_desc->part_type = PART_TYPE_ISO;
@@ -5,7 +5,9 @@
  */
 
 #include <common.h>
+#include <environment.h>
 #include <malloc.h>
+#include <net.h>
 #include <watchdog.h>
 #include <linux/compiler.h>
 #include <asm/lantiq/io.h>
@@ -13,7 +15,11 @@
 #include <asm/lantiq/pm.h>
 #include <asm/lantiq/reset.h>
 #include <asm/arch/soc.h>
+#include <asm/mipsregs.h>
 #include <asm/processor.h>
+#include <div64.h>
+
+DECLARE_GLOBAL_DATA_PTR;
 
 #define DMA_CTRL_PKTARB			(1 << 31)
 #define DMA_CTRL_MBRSTARB		(1 << 30)
@@ -33,6 +39,8 @@
 #define DMA_CCTRL_RST			(1 << 1)
 #define DMA_CCTRL_ONOFF			(1 << 0)
 
+#define DMA_CIS_DUR			(1 << 2)	/* descriptor underrun */
+
 #define DMA_PCTRL_TXBL_SHIFT		4
 #define DMA_PCTRL_TXBL_2WORDS		(1 << DMA_PCTRL_TXBL_SHIFT)
 #define DMA_PCTRL_TXBL_4WORDS		(2 << DMA_PCTRL_TXBL_SHIFT)
@@ -83,6 +91,82 @@ struct ltq_dma_regs {
 static struct ltq_dma_regs *ltq_dma_regs =
 	(struct ltq_dma_regs *) CKSEG1ADDR(LTQ_DMA_BASE);
 
+static int ltq_dma_initialized;
+
+/* Defaults match the former hard-coded setup */
+#define LTQ_DMA_PROFILE_DEFAULT {	\
+	.poll_cnt = 4,			\
+	.pktarb = 0,			\
+	.drb = 0,			\
+	.burst = 0,			\
+	.class = -1,			\
+	.tx_weight = 3,			\
+}
+
+static struct ltq_dma_profile ltq_dma_profile = LTQ_DMA_PROFILE_DEFAULT;
+
+#ifndef CONFIG_SPL_BUILD
+/* Registered clients, only needed for the dma command */
+#define LTQ_DMA_MAX_DEVICES	4
+
+static struct ltq_dma_device *ltq_dma_devices[LTQ_DMA_MAX_DEVICES];
+
+static void ltq_dma_add_device(struct ltq_dma_device *dev)
+{
+	int i;
+
+	for (i = 0; i < LTQ_DMA_MAX_DEVICES; i++) {
+		if (!ltq_dma_devices[i] || ltq_dma_devices[i] == dev) {
+			ltq_dma_devices[i] = dev;
+			return;
+		}
+	}
+}
+#else
+static inline void ltq_dma_add_device(struct ltq_dma_device *dev)
+{
+}
+#endif
+
+#ifdef CONFIG_SPL_BUILD
+/*
+ * There is no malloc in the SPL. The only DMA client in the SPL is the
+ * SPI flash driver with a few descriptors per channel. Thus we take the
+ * descriptor memory from a small pool in BSS.
+ */
+#define LTQ_DMA_SPL_POOL_SIZE	256
+
+static u8 ltq_dma_spl_pool[LTQ_DMA_SPL_POOL_SIZE];
+static unsigned int ltq_dma_spl_pool_used;
+
+static void *ltq_dma_desc_alloc(size_t size)
+{
+	void *mem;
+
+	if (ltq_dma_spl_pool_used + size > LTQ_DMA_SPL_POOL_SIZE)
+		return NULL;
+
+	mem = &ltq_dma_spl_pool[ltq_dma_spl_pool_used];
+	ltq_dma_spl_pool_used += size;
+
+	return mem;
+}
+
+static void ltq_dma_desc_free(void *mem)
+{
+}
+#else
+static void *ltq_dma_desc_alloc(size_t size)
+{
+	return malloc(size);
+}
+
+static void ltq_dma_desc_free(void *mem)
+{
+	free(mem);
+}
+#endif
+
 static inline unsigned long ltq_dma_addr_to_virt(u32 dma_addr)
 {
 	return KSEG0ADDR(dma_addr);
@@ -107,28 +191,80 @@ static inline int ltq_dma_burst_align(enum ltq_dma_burst_len burst_len)
 	return 0;
 }
 
+static inline enum ltq_dma_burst_len ltq_dma_rx_burst(
+					struct ltq_dma_device *dev)
+{
+	if (ltq_dma_profile.burst)
+		return ltq_dma_profile.burst;
+
+	return dev->rx_burst_len;
+}
+
+static inline enum ltq_dma_burst_len ltq_dma_tx_burst(
+					struct ltq_dma_device *dev)
+{
+	if (ltq_dma_profile.burst)
+		return ltq_dma_profile.burst;
+
+	return dev->tx_burst_len;
+}
+
 static inline void ltq_dma_sync(void)
 {
 	__asm__ __volatile__("sync");
 }
 
-static inline void ltq_dma_dcache_wb_inv(const void *ptr, size_t size)
+static inline void ltq_dma_dcache_wb_inv(struct ltq_dma_channel *chan,
+					const void *ptr, size_t size)
 {
 	unsigned long addr = (unsigned long) ptr;
+	u32 start = read_c0_count();
 
 	flush_dcache_range(addr, addr + size);
 	ltq_dma_sync();
+
+	chan->stats.cache_cycles += read_c0_count() - start;
 }
 
-static inline void ltq_dma_dcache_inv(const void *ptr, size_t size)
+static inline void ltq_dma_dcache_inv(struct ltq_dma_channel *chan,
+					const void *ptr, size_t size)
 {
 	unsigned long addr = (unsigned long) ptr;
+	u32 start = read_c0_count();
 
 	invalidate_dcache_range(addr, addr + size);
+
+	chan->stats.cache_cycles += read_c0_count() - start;
+}
+
+static void ltq_dma_global_setup(void)
+{
+	const struct ltq_dma_profile *profile = &ltq_dma_profile;
+	u32 ctrl;
+
+	/* Packet arbitration and descriptor read back */
+	ctrl = ltq_readl(&ltq_dma_regs->ctrl);
+	ctrl &= ~(DMA_CTRL_PKTARB | DMA_CTRL_DRB | DMA_CTRL_RESET);
+	if (profile->pktarb)
+		ctrl |= DMA_CTRL_PKTARB;
+	if (profile->drb)
+		ctrl |= DMA_CTRL_DRB;
+	ltq_writel(&ltq_dma_regs->ctrl, ctrl);
+
+	/* Enable polling for descriptor fetching for all channels */
+	ltq_writel(&ltq_dma_regs->cpoll, DMA_CPOLL_EN |
+		((profile->poll_cnt << DMA_CPOLL_CNT_SHIFT) &
+		DMA_CPOLL_CNT_MASK));
 }
 
 void ltq_dma_init(void)
 {
+	/* DMA is shared by several clients, only reset it once */
+	if (ltq_dma_initialized)
+		return;
+
+	ltq_dma_initialized = 1;
+
 	/* Power up DMA */
 	ltq_pm_enable(LTQ_PM_DMA);
 
@@ -139,19 +275,20 @@ void ltq_dma_init(void)
 	ltq_writel(&ltq_dma_regs->irnen, 0);
 	ltq_writel(&ltq_dma_regs->irncr, 0xFFFFF);
 
-#if 0
-	/* Enable packet arbitration */
-	ltq_setbits(&ltq_dma_regs->ctrl, DMA_CTRL_PKTARB);
-#endif
+	ltq_dma_global_setup();
+}
 
-#if 0
-	/* Enable descriptor read back */
-	ltq_setbits(&ltq_dma_regs->ctrl, DMA_CTRL_DRB);
-#endif
+void ltq_dma_profile_get(struct ltq_dma_profile *profile)
+{
+	*profile = ltq_dma_profile;
+}
 
-	/* Enable polling for descriptor fetching for all channels */
-	ltq_writel(&ltq_dma_regs->cpoll, DMA_CPOLL_EN |
-		(4 << DMA_CPOLL_CNT_SHIFT));
+void ltq_dma_profile_set(const struct ltq_dma_profile *profile)
+{
+	ltq_dma_profile = *profile;
+
+	if (ltq_dma_initialized)
+		ltq_dma_global_setup();
 }
 
 static void ltq_dma_channel_reset(struct ltq_dma_channel *chan)
@@ -162,8 +299,19 @@ static void ltq_dma_channel_reset(struct ltq_dma_channel *chan)
 
 static void ltq_dma_channel_enable(struct ltq_dma_channel *chan)
 {
+	const struct ltq_dma_profile *profile = &ltq_dma_profile;
+	unsigned int class = chan->class;
+
+	if (profile->class >= 0)
+		class = profile->class;
+
 	ltq_writel(&ltq_dma_regs->cs, chan->chan_no);
-	ltq_setbits(&ltq_dma_regs->cctrl, DMA_CCTRL_ONOFF);
+	ltq_clrsetbits(&ltq_dma_regs->cctrl,
+		DMA_CCTRL_TXWGT_MASK | DMA_CCTRL_CLASS_MASK,
+		((profile->tx_weight << DMA_CCTRL_TXWGT_SHIFT) &
+		DMA_CCTRL_TXWGT_MASK) |
+		((class << DMA_CCTRL_CLASS_SHIFT) & DMA_CCTRL_CLASS_MASK) |
+		DMA_CCTRL_ONOFF);
 }
 
 static void ltq_dma_channel_disable(struct ltq_dma_channel *chan)
@@ -178,8 +326,8 @@ static void ltq_dma_port_init(struct ltq_dma_device *dev)
 
 	pctrl = dev->tx_endian_swap << DMA_PCTRL_TXENDI_SHIFT;
 	pctrl |= dev->rx_endian_swap << DMA_PCTRL_RXENDI_SHIFT;
-	pctrl |= dev->tx_burst_len << DMA_PCTRL_TXBL_SHIFT;
-	pctrl |= dev->rx_burst_len << DMA_PCTRL_RXBL_SHIFT;
+	pctrl |= ltq_dma_tx_burst(dev) << DMA_PCTRL_TXBL_SHIFT;
+	pctrl |= ltq_dma_rx_burst(dev) << DMA_PCTRL_RXBL_SHIFT;
 
 	ltq_writel(&ltq_dma_regs->ps, dev->port);
 	ltq_writel(&ltq_dma_regs->pctrl, pctrl);
@@ -194,12 +342,12 @@ static int ltq_dma_alloc_descriptors(struct ltq_dma_device *dev,
 	size = ALIGN(sizeof(struct ltq_dma_desc) * chan->num_desc +
 			ARCH_DMA_MINALIGN, ARCH_DMA_MINALIGN);
 
-	chan->mem_base = malloc(size);
+	chan->mem_base = ltq_dma_desc_alloc(size);
 	if (!chan->mem_base)
 		return 1;
 
 	memset(chan->mem_base, 0, size);
-	ltq_dma_dcache_wb_inv(chan->mem_base, size);
+	ltq_dma_dcache_wb_inv(chan, chan->mem_base, size);
 
 	desc_base = PTR_ALIGN(chan->mem_base, ARCH_DMA_MINALIGN);
 
@@ -231,7 +379,7 @@ static void ltq_dma_free_descriptors(struct ltq_dma_channel *chan)
 
 	ltq_dma_channel_reset(chan);
 
-	free(chan->mem_base);
+	ltq_dma_desc_free(chan->mem_base);
 }
 
 int ltq_dma_register(struct ltq_dma_device *dev)
@@ -250,9 +398,18 @@ int ltq_dma_register(struct ltq_dma_device *dev)
 		return ret;
 	}
 
+	ltq_dma_add_device(dev);
+
 	return 0;
 }
 
+void ltq_dma_stats_reset(struct ltq_dma_device *dev)
+{
+	memset(&dev->rx_chan.stats, 0, sizeof(dev->rx_chan.stats));
+	memset(&dev->tx_chan.stats, 0, sizeof(dev->tx_chan.stats));
+	dev->tx_chan.pps_base = 0;
+}
+
 void ltq_dma_reset(struct ltq_dma_device *dev)
 {
 	ltq_dma_channel_reset(&dev->rx_chan);
@@ -261,6 +418,18 @@ void ltq_dma_reset(struct ltq_dma_device *dev)
 
 void ltq_dma_enable(struct ltq_dma_device *dev)
 {
+	/* Pick up profile changes */
+	ltq_dma_port_init(dev);
+
+	/*
+	 * Latch RX descriptor underruns, i.e. frames hardware had to drop
+	 * because the ring was full. The interrupt node stays disabled,
+	 * the status is polled by ltq_dma_rx_poll().
+	 */
+	ltq_writel(&ltq_dma_regs->cs, dev->rx_chan.chan_no);
+	ltq_setbits(&ltq_dma_regs->cie, DMA_CIS_DUR);
+	ltq_writel(&ltq_dma_regs->cis, DMA_CIS_DUR);
+
 	ltq_dma_channel_enable(&dev->rx_chan);
 	ltq_dma_channel_enable(&dev->tx_chan);
 }
@@ -278,9 +447,9 @@ int ltq_dma_rx_map(struct ltq_dma_device *dev, int index, void *data, int len)
 	u32 dma_addr = ltq_virt_to_dma_addr(data);
 	unsigned int offset;
 
-	offset = dma_addr % ltq_dma_burst_align(dev->rx_burst_len);
+	offset = dma_addr % ltq_dma_burst_align(ltq_dma_rx_burst(dev));
 
-	ltq_dma_dcache_inv(data, len);
+	ltq_dma_dcache_inv(chan, data, len);
 
 #if 0
 	printf("%s: index %d, data %p, dma_addr %08x, offset %u, len %d\n",
@@ -291,6 +460,7 @@ int ltq_dma_rx_map(struct ltq_dma_device *dev, int index, void *data, int len)
 	desc->addr = dma_addr - offset;
 	desc->ctl = DMA_DESC_OWN | DMA_DESC_RX_OFFSET(offset) |
 			DMA_DESC_LENGTH(len);
+	chan->stats.submitted++;
 
 #if 0
 	printf("%s: index %d, desc %p, desc->ctl %08x\n",
@@ -310,11 +480,21 @@ int ltq_dma_rx_poll(struct ltq_dma_device *dev, int index)
 		__func__, index, desc, desc->ctl);
 #endif
 
-	if (desc->ctl & DMA_DESC_OWN)
+	if (desc->ctl & DMA_DESC_OWN) {
+		/* ring drained, check if hardware ran out of descriptors */
+		ltq_writel(&ltq_dma_regs->cs, chan->chan_no);
+		if (ltq_readl(&ltq_dma_regs->cis) & DMA_CIS_DUR) {
+			ltq_writel(&ltq_dma_regs->cis, DMA_CIS_DUR);
+			chan->stats.overruns++;
+		}
 		return 0;
+	}
 
-	if (desc->ctl & DMA_DESC_C)
+	if (desc->ctl & DMA_DESC_C) {
+		chan->stats.completed++;
+		chan->stats.bytes += DMA_DESC_LENGTH(desc->ctl);
 		return 1;
+	}
 
 	return 0;
 }
@@ -327,6 +507,40 @@ int ltq_dma_rx_length(struct ltq_dma_device *dev, int index)
 	return DMA_DESC_LENGTH(desc->ctl);
 }
 
+void ltq_dma_rx_sync(struct ltq_dma_device *dev, void *data, int len)
+{
+	ltq_dma_dcache_inv(&dev->rx_chan, data, len);
+}
+
+int ltq_dma_rx_release(struct ltq_dma_device *dev, int index, void *data,
+			int len, int used)
+{
+	struct ltq_dma_channel *chan = &dev->rx_chan;
+	struct ltq_dma_desc *desc = &chan->desc_base[index];
+	u32 dma_addr = ltq_virt_to_dma_addr(data);
+	unsigned int offset;
+
+	if (used <= 0 || used > len)
+		chan->stats.dropped++;
+
+	offset = dma_addr % ltq_dma_burst_align(ltq_dma_rx_burst(dev));
+
+	/*
+	 * The network stack may build replies in place, discard those
+	 * dirty lines before hardware writes the next frame. Clean lines
+	 * are dropped by ltq_dma_rx_sync() once the next frame is in.
+	 */
+	if (used > 0)
+		ltq_dma_dcache_inv(chan, data, min(used, len));
+
+	desc->addr = dma_addr - offset;
+	desc->ctl = DMA_DESC_OWN | DMA_DESC_RX_OFFSET(offset) |
+			DMA_DESC_LENGTH(len);
+	chan->stats.submitted++;
+
+	return 0;
+}
+
 int ltq_dma_tx_map(struct ltq_dma_device *dev, int index, void *data, int len,
 			unsigned long timeout)
 {
@@ -336,6 +550,9 @@ int ltq_dma_tx_map(struct ltq_dma_device *dev, int index, void *data, int len,
 	unsigned long timebase = get_timer(0);
 	u32 dma_addr = ltq_virt_to_dma_addr(data);
 
+	if (desc->ctl & DMA_DESC_OWN)
+		chan->stats.stalls++;
+
 	while (desc->ctl & DMA_DESC_OWN) {
 		WATCHDOG_RESET();
 
@@ -344,22 +561,25 @@ int ltq_dma_tx_map(struct ltq_dma_device *dev, int index, void *data, int len,
 			printf("%s: timeout: index %d, desc %p, desc->ctl %08x\n",
 				__func__, index, desc, desc->ctl);
 #endif
+			chan->stats.timeouts++;
 			return -1;
 		}
 	}
 
-	offset = dma_addr % ltq_dma_burst_align(dev->rx_burst_len);
+	offset = dma_addr % ltq_dma_burst_align(ltq_dma_tx_burst(dev));
 
 #if 0
 	printf("%s: index %d, desc %p, data %p, dma_addr %08x, offset %u, len %d\n",
 		__func__, index, desc, data, dma_addr, offset, len);
 #endif
 
-	ltq_dma_dcache_wb_inv(data, len);
+	ltq_dma_dcache_wb_inv(chan, data, len);
 
 	desc->addr = dma_addr - offset;
 	desc->ctl = DMA_DESC_OWN | DMA_DESC_SOP | DMA_DESC_EOP |
 			DMA_DESC_TX_OFFSET(offset) | DMA_DESC_LENGTH(len);
+	chan->stats.submitted++;
+	chan->stats.bytes += len;
 
 #if 0
 	printf("%s: index %d, desc %p, desc->ctl %08x\n",
@@ -376,12 +596,482 @@ int ltq_dma_tx_wait(struct ltq_dma_device *dev, int index,
 	struct ltq_dma_desc *desc = &chan->desc_base[index];
 	unsigned long timebase = get_timer(0);
 
+	if ((desc->ctl & (DMA_DESC_OWN | DMA_DESC_C)) != DMA_DESC_C)
+		chan->stats.stalls++;
+
 	while ((desc->ctl & (DMA_DESC_OWN | DMA_DESC_C)) != DMA_DESC_C) {
 		WATCHDOG_RESET();
 
-		if (get_timer(timebase) >= timeout)
+		if (get_timer(timebase) >= timeout) {
+			chan->stats.timeouts++;
 			return -1;
+		}
 	}
 
+	chan->stats.completed++;
+
+	return 0;
+}
+
+#ifndef CONFIG_SPL_BUILD
+int ltq_dma_tx_ring_init(struct ltq_dma_device *dev, unsigned int buf_size)
+{
+	struct ltq_dma_channel *chan = &dev->tx_chan;
+
+	chan->buf_size = ALIGN(buf_size, ARCH_DMA_MINALIGN);
+	chan->buf_base = memalign(ARCH_DMA_MINALIGN,
+				chan->buf_size * chan->num_desc);
+	if (!chan->buf_base)
+		return -1;
+
+	ltq_dma_tx_ring_reset(dev);
+
 	return 0;
 }
+
+void ltq_dma_tx_ring_reset(struct ltq_dma_device *dev)
+{
+	struct ltq_dma_channel *chan = &dev->tx_chan;
+	int i;
+
+	/* Hardware restarts at first descriptor after channel reset */
+	for (i = 0; i < chan->num_desc; i++)
+		chan->desc_base[i].ctl = 0;
+
+	chan->head = 0;
+	chan->tail = 0;
+	chan->pending = 0;
+	chan->pps_base = chan->stats.submitted;
+	chan->timebase = get_timer(0);
+}
+
+int ltq_dma_tx_ring_reclaim(struct ltq_dma_device *dev)
+{
+	struct ltq_dma_channel *chan = &dev->tx_chan;
+	struct ltq_dma_desc *desc;
+	int done = 0;
+
+	while (chan->pending) {
+		desc = &chan->desc_base[chan->tail];
+		if ((desc->ctl & (DMA_DESC_OWN | DMA_DESC_C)) != DMA_DESC_C)
+			break;
+
+		desc->ctl = 0;
+		chan->tail = (chan->tail + 1) % chan->num_desc;
+		chan->pending--;
+		done++;
+	}
+
+	chan->stats.completed += done;
+
+	return done;
+}
+
+int ltq_dma_tx_ring_send(struct ltq_dma_device *dev, const void *data,
+			int len, unsigned long timeout)
+{
+	struct ltq_dma_channel *chan = &dev->tx_chan;
+	struct ltq_dma_desc *desc;
+	unsigned long timebase;
+	void *buf;
+
+	if (len > chan->buf_size)
+		return -1;
+
+	ltq_dma_tx_ring_reclaim(dev);
+
+	if (chan->pending == chan->num_desc) {
+		chan->stats.stalls++;
+		timebase = get_timer(0);
+
+		while (!ltq_dma_tx_ring_reclaim(dev)) {
+			WATCHDOG_RESET();
+
+			if (get_timer(timebase) >= timeout) {
+				chan->stats.timeouts++;
+				return -1;
+			}
+		}
+	}
+
+	/*
+	 * The network stack reuses its TX buffer as soon as we return,
+	 * so the packet must be copied to a buffer owned by the ring.
+	 */
+	desc = &chan->desc_base[chan->head];
+	buf = chan->buf_base + chan->head * chan->buf_size;
+	memcpy(buf, data, len);
+	ltq_dma_dcache_wb_inv(chan, buf, len);
+
+	desc->addr = ltq_virt_to_dma_addr(buf);
+	desc->ctl = DMA_DESC_OWN | DMA_DESC_SOP | DMA_DESC_EOP |
+			DMA_DESC_LENGTH(len);
+
+	chan->head = (chan->head + 1) % chan->num_desc;
+	chan->pending++;
+	chan->stats.submitted++;
+	chan->stats.bytes += len;
+
+	return 0;
+}
+
+unsigned int ltq_dma_tx_ring_pps(struct ltq_dma_device *dev)
+{
+	struct ltq_dma_channel *chan = &dev->tx_chan;
+	unsigned long elapsed = get_timer(chan->timebase);
+	u64 pps;
+
+	if (!elapsed)
+		return 0;
+
+	pps = (u64) (chan->stats.submitted - chan->pps_base) * 1000;
+	do_div(pps, elapsed);
+
+	return pps;
+}
+
+static int ltq_dma_burst_parse(unsigned long words)
+{
+	switch (words) {
+	case 2:
+		return LTQ_DMA_BURST_2WORDS;
+	case 4:
+		return LTQ_DMA_BURST_4WORDS;
+	case 8:
+		return LTQ_DMA_BURST_8WORDS;
+	}
+
+	return -1;
+}
+
+/*
+ * Parse a profile string like "poll=8,pktarb=1,drb=0,burst=4,class=1".
+ * Keys not given keep the default value.
+ */
+static int ltq_dma_profile_parse(const char *str,
+					struct ltq_dma_profile *profile)
+{
+	const char *p = str;
+	const char *eq;
+	unsigned long val;
+	char *endp;
+	int len;
+
+	while (*p) {
+		eq = strchr(p, '=');
+		if (!eq)
+			return -1;
+		len = eq - p;
+
+		val = simple_strtoul(p + len + 1, &endp, 0);
+		if (endp == p + len + 1 || (*endp && *endp != ','))
+			return -1;
+
+		if (!strncmp(p, "poll", len) && len == 4) {
+			if (!val || val > 0xfff)
+				return -1;
+			profile->poll_cnt = val;
+		} else if (!strncmp(p, "pktarb", len) && len == 6) {
+			profile->pktarb = !!val;
+		} else if (!strncmp(p, "drb", len) && len == 3) {
+			profile->drb = !!val;
+		} else if (!strncmp(p, "burst", len) && len == 5) {
+			if (ltq_dma_burst_parse(val) < 0)
+				return -1;
+			profile->burst = ltq_dma_burst_parse(val);
+		} else if (!strncmp(p, "class", len) && len == 5) {
+			if (val > 3)
+				return -1;
+			profile->class = val;
+		} else if (!strncmp(p, "weight", len) && len == 6) {
+			if (val > 3)
+				return -1;
+			profile->tx_weight = val;
+		} else {
+			return -1;
+		}
+
+		p = *endp ? endp + 1 : endp;
+	}
+
+	return 0;
+}
+
+static const struct ltq_dma_profile ltq_dma_profile_default =
+	LTQ_DMA_PROFILE_DEFAULT;
+
+static int on_dmaprofile(const char *name, const char *value, enum env_op op,
+	int flags)
+{
+	struct ltq_dma_profile profile = ltq_dma_profile_default;
+
+	switch (op) {
+	case env_op_create:
+	case env_op_overwrite:
+		if (ltq_dma_profile_parse(value, &profile)) {
+			printf("## Invalid DMA profile '%s'\n", value);
+			return 1;
+		}
+		ltq_dma_profile_set(&profile);
+		break;
+	case env_op_delete:
+		ltq_dma_profile_set(&profile);
+		break;
+	}
+
+	return 0;
+}
+U_BOOT_ENV_CALLBACK(dmaprofile, on_dmaprofile);
+
+#ifdef CONFIG_CMD_LTQ_DMA
+static void ltq_dma_show_channel(const char *dir, struct ltq_dma_channel *chan,
+					int verbose)
+{
+	struct ltq_dma_stats *stats = &chan->stats;
+	u64 cache_us = stats->cache_cycles;
+	u32 cdptnrd;
+	int i;
+
+	ltq_writel(&ltq_dma_regs->cs, chan->chan_no);
+	cdptnrd = ltq_readl(&ltq_dma_regs->cdptnrd);
+	do_div(cache_us, CONFIG_SYS_MIPS_TIMER_FREQ / 1000000);
+
+	printf("  %s: chan %u, class %u, %u desc at %08x, hw desc %d\n",
+		dir, chan->chan_no, chan->class, chan->num_desc,
+		chan->dma_addr, (int)(cdptnrd - chan->dma_addr) /
+		(int)sizeof(struct ltq_dma_desc));
+	if (chan->buf_base)
+		printf("      ring: head %u, tail %u, pending %u\n",
+			chan->head, chan->tail, chan->pending);
+	printf("      submitted %u, completed %u, stalls %u, timeouts %u\n",
+		stats->submitted, stats->completed, stats->stalls,
+		stats->timeouts);
+	printf("      dropped %u, overruns %u, bytes %llu\n",
+		stats->dropped, stats->overruns, stats->bytes);
+	printf("      cache maintenance %llu cycles (%llu us)\n",
+		stats->cache_cycles, cache_us);
+
+	if (!verbose)
+		return;
+
+	for (i = 0; i < chan->num_desc; i++)
+		printf("      %3d: ctl %08x addr %08x\n", i,
+			chan->desc_base[i].ctl, chan->desc_base[i].addr);
+}
+
+static void ltq_dma_show_profile(const struct ltq_dma_profile *profile)
+{
+	printf("poll=%u,pktarb=%u,drb=%u,burst=%d,class=%d,weight=%u",
+		profile->poll_cnt, profile->pktarb, profile->drb,
+		profile->burst ? ltq_dma_burst_align(profile->burst) / 4 : 0,
+		profile->class, profile->tx_weight);
+}
+
+#ifdef CONFIG_CMD_NET
+#define LTQ_DMA_BENCH_FRAME_LEN		1514
+#define LTQ_DMA_BENCH_ETHERTYPE		0x88b5	/* local experimental */
+
+/* Profiles swept by 'dma bench' */
+static const struct ltq_dma_profile ltq_dma_bench_profiles[] = {
+	{ .poll_cnt = 4, .burst = 0, .class = -1, .tx_weight = 3 },
+	{ .poll_cnt = 1, .burst = 0, .class = -1, .tx_weight = 3 },
+	{ .poll_cnt = 16, .burst = 0, .class = -1, .tx_weight = 3 },
+	{ .poll_cnt = 4, .pktarb = 1, .burst = 0, .class = -1, .tx_weight = 3 },
+	{ .poll_cnt = 4, .drb = 1, .burst = 0, .class = -1, .tx_weight = 3 },
+	{ .poll_cnt = 4, .burst = LTQ_DMA_BURST_4WORDS, .class = -1,
+		.tx_weight = 3 },
+	{ .poll_cnt = 4, .burst = LTQ_DMA_BURST_8WORDS, .class = -1,
+		.tx_weight = 3 },
+	{ .poll_cnt = 1, .pktarb = 1, .drb = 1,
+		.burst = LTQ_DMA_BURST_8WORDS, .class = -1, .tx_weight = 3 },
+};
+
+static struct ltq_dma_device *ltq_dma_find_device(const char *name)
+{
+	int i;
+
+	for (i = 0; i < LTQ_DMA_MAX_DEVICES; i++) {
+		if (ltq_dma_devices[i] && ltq_dma_devices[i]->name &&
+		    !strcmp(ltq_dma_devices[i]->name, name))
+			return ltq_dma_devices[i];
+	}
+
+	return NULL;
+}
+
+/*
+ * Send a burst of broadcast frames with every profile and count how
+ * many come back. Without a loopback plug or a PHY in loopback mode
+ * only the TX rate is meaningful.
+ */
+static int ltq_dma_bench(unsigned long count)
+{
+	struct ltq_dma_profile saved;
+	struct ltq_dma_device *dev;
+	struct eth_device *eth = eth_get_dev();
+	unsigned long i, time_ms, rx;
+	u64 kbps;
+	u8 *frame;
+	int p, ret = 0;
+
+	if (!eth)
+		return CMD_RET_FAILURE;
+
+	dev = ltq_dma_find_device(eth->name);
+	if (!dev) {
+		printf("No DMA client for %s\n", eth->name);
+		return CMD_RET_FAILURE;
+	}
+
+	frame = malloc(LTQ_DMA_BENCH_FRAME_LEN);
+	if (!frame)
+		return CMD_RET_FAILURE;
+
+	memset(frame, 0xff, 6);
+	memcpy(frame + 6, eth->enetaddr, 6);
+	frame[12] = LTQ_DMA_BENCH_ETHERTYPE >> 8;
+	frame[13] = LTQ_DMA_BENCH_ETHERTYPE & 0xff;
+	for (i = 14; i < LTQ_DMA_BENCH_FRAME_LEN; i++)
+		frame[i] = i;
+
+	ltq_dma_profile_get(&saved);
+
+	for (p = 0; p < ARRAY_SIZE(ltq_dma_bench_profiles); p++) {
+		ltq_dma_profile_set(&ltq_dma_bench_profiles[p]);
+
+		if (eth_init(gd->bd) < 0) {
+			ret = CMD_RET_FAILURE;
+			break;
+		}
+
+		rx = dev->rx_chan.stats.completed;
+		time_ms = get_timer(0);
+
+		for (i = 0; i < count; i++) {
+			if (eth_send(frame, LTQ_DMA_BENCH_FRAME_LEN) < 0)
+				break;
+			eth_rx();
+
+			if (ctrlc())
+				break;
+		}
+
+		/* Collect frames still in flight */
+		while (ltq_dma_tx_ring_reclaim(dev) || dev->tx_chan.pending) {
+			eth_rx();
+			if (get_timer(time_ms) > 10000)
+				break;
+		}
+		eth_rx();
+
+		time_ms = get_timer(time_ms);
+		rx = dev->rx_chan.stats.completed - rx;
+		eth_halt();
+
+		kbps = (u64) i * LTQ_DMA_BENCH_FRAME_LEN * 8;
+		if (time_ms)
+			do_div(kbps, time_ms);
+		else
+			kbps = 0;
+
+		ltq_dma_show_profile(&ltq_dma_bench_profiles[p]);
+		printf(": tx %lu rx %lu in %lu ms, %llu kbit/s\n", i, rx,
+			time_ms, kbps);
+
+		if (i < count)
+			break;
+	}
+
+	ltq_dma_profile_set(&saved);
+	free(frame);
+
+	return ret;
+}
+#endif
+
+static int do_ltq_dma(cmd_tbl_t *cmdtp, int flag, int argc,
+			char * const argv[])
+{
+	struct ltq_dma_device *dev;
+	struct ltq_dma_profile profile;
+	int i, verbose = 0, reset = 0;
+
+	if (argc > 3)
+		return CMD_RET_USAGE;
+
+	if (argc >= 2 && !strcmp(argv[1], "profile")) {
+		if (argc == 3) {
+			profile = ltq_dma_profile_default;
+			if (ltq_dma_profile_parse(argv[2], &profile))
+				return CMD_RET_USAGE;
+			ltq_dma_profile_set(&profile);
+		}
+
+		ltq_dma_profile_get(&profile);
+		ltq_dma_show_profile(&profile);
+		puts("\n");
+
+		return CMD_RET_SUCCESS;
+	}
+
+#ifdef CONFIG_CMD_NET
+	if (argc >= 2 && !strcmp(argv[1], "bench"))
+		return ltq_dma_bench(argc == 3 ?
+			simple_strtoul(argv[2], NULL, 0) : 10000);
+#endif
+
+	if (argc == 3)
+		return CMD_RET_USAGE;
+
+	if (argc == 2) {
+		if (!strcmp(argv[1], "desc"))
+			verbose = 1;
+		else if (!strcmp(argv[1], "reset"))
+			reset = 1;
+		else
+			return CMD_RET_USAGE;
+	}
+
+	for (i = 0; i < LTQ_DMA_MAX_DEVICES; i++) {
+		dev = ltq_dma_devices[i];
+		if (!dev)
+			break;
+
+		if (reset) {
+			ltq_dma_stats_reset(dev);
+			continue;
+		}
+
+		printf("%s: port %u\n", dev->name ? dev->name : "unknown",
+			dev->port);
+		ltq_dma_show_channel("rx", &dev->rx_chan, verbose);
+		ltq_dma_show_channel("tx", &dev->tx_chan, verbose);
+	}
+
+	return CMD_RET_SUCCESS;
+}
+
+#ifdef CONFIG_CMD_NET
+#define LTQ_DMA_BENCH_HELP \
+	"\ndma bench [count]\n" \
+	"    - send count frames on the current Ethernet device with\n" \
+	"      a set of profiles and report the throughput"
+#else
+#define LTQ_DMA_BENCH_HELP
+#endif
+
+U_BOOT_CMD(
+	dma,	3,	1,	do_ltq_dma,
+	"show Lantiq DMA ring state and statistics",
+	"\n"
+	"    - show state and counters of all DMA clients\n"
+	"dma desc\n"
+	"    - additionally dump all descriptors\n"
+	"dma reset\n"
+	"    - clear counters of all DMA clients\n"
+	"dma profile [poll=n,pktarb=0|1,drb=0|1,burst=2|4|8,class=n,weight=n]\n"
+	"    - show or set the DMA tuning profile"
+	LTQ_DMA_BENCH_HELP
+);
+#endif /* CONFIG_CMD_LTQ_DMA */
+#endif /* !CONFIG_SPL_BUILD */
@@ -568,6 +568,11 @@ int mmc_switch_part(int dev_num, unsigned int part_num)
 	if (ret)
 		return ret;
 
+#if !defined(CONFIG_SPL_BUILD) || defined(CONFIG_SPL_LIBDISK_SUPPORT)
+	/* Another hardware partition shows up behind the same device */
+	dev_changed(&mmc->block_dev);
+#endif
+
 	return mmc_set_capacity(mmc, part_num);
 }
 
@@ -58,6 +58,23 @@ struct ltq_nand_regs {
 static struct ltq_nand_regs *ltq_nand_regs =
 	(struct ltq_nand_regs *) CKSEG1ADDR(LTQ_EBU_NAND_BASE);
 
+/*
+ * Flash based bad block table, 2 bits per block. The main table and its
+ * mirror live in the last good blocks of the chip and are identified by
+ * a pattern and a version byte in the OOB area of their first page. The
+ * layout is spelled out here because the SPL looks the table up as well.
+ */
+#define LTQ_NAND_BBT_OFFS	8
+#define LTQ_NAND_BBT_LEN	4
+#define LTQ_NAND_BBT_VEROFFS	12
+#define LTQ_NAND_BBT_MAXBLOCKS	4
+
+#if defined(CONFIG_SYS_NAND_USE_FLASH_BBT) && (!defined(CONFIG_SPL_BUILD) || \
+	(defined(CONFIG_SYS_BOOT_NANDSPL) && defined(CONFIG_SYS_NAND_SIZE)))
+static u8 ltq_nand_bbt_pattern[] = { 'B', 'b', 't', '0' };
+static u8 ltq_nand_mirror_pattern[] = { '1', 't', 'b', 'B' };
+#endif
+
 static void ltq_nand_wait_ready(void)
 {
 	while ((ltq_readl(&ltq_nand_regs->wait) & NAND_WAIT_WR_C) == 0)
@@ -105,15 +122,81 @@ static void ltq_nand_cmd_ctrl(struct mtd_info *mtd, int cmd, unsigned int ctrl)
 	}
 }
 
+/*
+ * Bulk read from the NAND data port. The bulk of the data is stored as
+ * aligned 32-bit words, each gathered from four byte accesses because
+ * the EBU region of the NAND flash is 8-bit wide.
+ */
+static inline void ltq_nand_readsb(const void __iomem *io_addr, u8 *buf,
+					unsigned int len)
+{
+	u32 *p, w;
+
+	while (len && ((unsigned long)buf & 3)) {
+		*buf++ = ltq_readb(io_addr);
+		len--;
+	}
+
+	for (p = (u32 *)buf; len >= 4; len -= 4) {
+		w = ltq_readb(io_addr) << 24;
+		w |= ltq_readb(io_addr) << 16;
+		w |= ltq_readb(io_addr) << 8;
+		w |= ltq_readb(io_addr);
+		w = cpu_to_be32(w);
+		*p++ = w;
+	}
+
+	for (buf = (u8 *)p; len; len--)
+		*buf++ = ltq_readb(io_addr);
+}
+
 static void ltq_nand_read_buf(struct mtd_info *mtd, uint8_t *buf, int len)
 {
-	int i;
 	struct nand_chip *chip = mtd->priv;
 
-	for (i = 0; i < len; i++)
-		buf[i] = readb(chip->IO_ADDR_R);
+	ltq_nand_readsb(chip->IO_ADDR_R, buf, len);
 }
 
+#if defined(CONFIG_SYS_NAND_USE_FLASH_BBT) && !defined(CONFIG_SPL_BUILD)
+static struct nand_bbt_descr ltq_nand_bbt_main = {
+	.options = NAND_BBT_LASTBLOCK | NAND_BBT_CREATE | NAND_BBT_WRITE |
+		NAND_BBT_2BIT | NAND_BBT_VERSION | NAND_BBT_PERCHIP,
+	.offs = LTQ_NAND_BBT_OFFS,
+	.len = LTQ_NAND_BBT_LEN,
+	.veroffs = LTQ_NAND_BBT_VEROFFS,
+	.maxblocks = LTQ_NAND_BBT_MAXBLOCKS,
+	.pattern = ltq_nand_bbt_pattern,
+};
+
+static struct nand_bbt_descr ltq_nand_bbt_mirror = {
+	.options = NAND_BBT_LASTBLOCK | NAND_BBT_CREATE | NAND_BBT_WRITE |
+		NAND_BBT_2BIT | NAND_BBT_VERSION | NAND_BBT_PERCHIP,
+	.offs = LTQ_NAND_BBT_OFFS,
+	.len = LTQ_NAND_BBT_LEN,
+	.veroffs = LTQ_NAND_BBT_VEROFFS,
+	.maxblocks = LTQ_NAND_BBT_MAXBLOCKS,
+	.pattern = ltq_nand_mirror_pattern,
+};
+
+/*
+ * Reads the table from flash, or scans all blocks once and writes a new
+ * table if there is none yet. Only the latter should ever take long.
+ */
+static int ltq_nand_scan_bbt(struct mtd_info *mtd)
+{
+	ulong start = get_timer(0);
+	int ret;
+
+	bootstage_start(BOOTSTAGE_ID_ACCUM_NAND_BBT, "nand_bbt");
+	ret = nand_default_bbt(mtd);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_NAND_BBT);
+
+	debug("NAND: bad block table ready in %lu ms\n", get_timer(start));
+
+	return ret;
+}
+#endif
+
 int ltq_nand_init(struct nand_chip *nand)
 {
 	/* Enable NAND, set NAND CS to EBU CS1, enable EBU CS mux */
@@ -127,8 +210,11 @@ int ltq_nand_init(struct nand_chip *nand)
 
 	nand->ecc.mode = NAND_ECC_SOFT;
 
-#ifdef CONFIG_SYS_NAND_USE_FLASH_BBT
+#if defined(CONFIG_SYS_NAND_USE_FLASH_BBT) && !defined(CONFIG_SPL_BUILD)
 	nand->bbt_options |= NAND_BBT_USE_FLASH;
+	nand->bbt_td = &ltq_nand_bbt_main;
+	nand->bbt_md = &ltq_nand_bbt_mirror;
+	nand->scan_bbt = ltq_nand_scan_bbt;
 #endif
 
 	return 0;
@@ -158,6 +244,33 @@ static const u8 spl_nand_eccpos[] = {
 #error "unsupported NAND OOB size"
 #endif
 
+#if (CONFIG_SYS_NAND_PAGE_SIZE > 512)
+#define SPL_NAND_BADBLOCK_POS	NAND_LARGE_BADBLOCK_POS
+#else
+#define SPL_NAND_BADBLOCK_POS	NAND_SMALL_BADBLOCK_POS
+#endif
+
+/*
+ * The SPL looks up the flash BBT written by U-Boot if the chip size is
+ * known and caches it. Otherwise or if there is no table, it checks the
+ * bad block marker in the OOB area of each block.
+ */
+#if defined(CONFIG_SYS_NAND_USE_FLASH_BBT) && defined(CONFIG_SYS_NAND_SIZE)
+#define SPL_NAND_BLOCKS		(CONFIG_SYS_NAND_SIZE / CONFIG_SYS_NAND_BLOCK_SIZE)
+#define SPL_NAND_BBT_SIZE	(SPL_NAND_BLOCKS / 4)
+
+#if (SPL_NAND_BBT_SIZE > CONFIG_SYS_NAND_PAGE_SIZE)
+#error "NAND flash BBT does not fit into one page"
+#endif
+
+static u8 spl_nand_bbt[SPL_NAND_BBT_SIZE];
+static int spl_nand_bbt_valid;
+#endif
+
+/* Last logical to physical block translation, images are read in order */
+static unsigned int spl_nand_lblock;
+static unsigned int spl_nand_pblock;
+
 static noinline void spl_nand_write(unsigned int cmd, unsigned int addr)
 {
 	unsigned long base_addr = CONFIG_SYS_NAND_BASE + NAND_CMD_CS;
@@ -166,7 +279,8 @@ static noinline void spl_nand_write(unsigned int cmd, unsigned int addr)
 	ltq_nand_wait_ready();
 }
 
-static noinline void spl_nand_command(int block, int page, unsigned int cmd)
+static noinline void spl_nand_command(int block, int page,
+					unsigned int column, unsigned int cmd)
 {
 	int page_addr = page + block * CONFIG_SYS_NAND_PAGE_COUNT;
 
@@ -174,9 +288,9 @@ static noinline void spl_nand_command(int block, int page, unsigned int cmd)
 	spl_nand_write(cmd, NAND_CMD_CLE);
 
 	/* column address */
-	spl_nand_write(0, NAND_CMD_ALE);
+	spl_nand_write(column & 0xff, NAND_CMD_ALE);
 #if (CONFIG_SYS_NAND_PAGE_SIZE > 512)
-	spl_nand_write(0, NAND_CMD_ALE);
+	spl_nand_write((column >> 8) & 0xff, NAND_CMD_ALE);
 #endif
 
 	/* row address */
@@ -203,24 +317,34 @@ static noinline void spl_nand_command(int block, int page, unsigned int cmd)
 static noinline void spl_nand_read_buf(u8 *buf, unsigned int len)
 {
 	void __iomem *io_addr = (void __iomem *)(CONFIG_SYS_NAND_BASE + NAND_CMD_CS);
-	unsigned int i;
 
-	for (i = 0; i < len; i++)
-		buf[i] = ltq_readb(io_addr);
+	ltq_nand_readsb(io_addr, buf, len);
 }
 
-static noinline int spl_nand_read_page(int block, int page, void *dst)
+static noinline void spl_nand_read_oob(int block, int page, u8 *oob)
+{
+#if (CONFIG_SYS_NAND_PAGE_SIZE > 512)
+	spl_nand_command(block, page, CONFIG_SYS_NAND_PAGE_SIZE,
+		NAND_CMD_READ0);
+#else
+	spl_nand_command(block, page, 0, NAND_CMD_READOOB);
+#endif
+	spl_nand_read_buf(oob, CONFIG_SYS_NAND_OOBSIZE);
+}
+
+static noinline int spl_nand_read_page(int block, int page, void *dst,
+					u8 *oob_data)
 {
 	u8 ecc_calc[ECCTOTAL];
 	u8 ecc_code[ECCTOTAL];
-	u8 oob_data[CONFIG_SYS_NAND_OOBSIZE];
 	int i;
 	int eccsize = ECCSIZE;
 	int eccbytes = ECCBYTES;
 	int eccsteps = ECCSTEPS;
 	u8 *p = dst;
+	int ret = 0;
 
-	spl_nand_command(block, page, NAND_CMD_READ0);
+	spl_nand_command(block, page, 0, NAND_CMD_READ0);
 	spl_nand_read_buf(p, CONFIG_SYS_NAND_PAGE_SIZE);
 	spl_nand_read_buf(oob_data, CONFIG_SYS_NAND_OOBSIZE);
 
@@ -234,9 +358,111 @@ static noinline int spl_nand_read_page(int block, int page, void *dst)
 	p = dst;
 
 	for (i = 0 ; eccsteps; eccsteps--, i += eccbytes, p += eccsize)
-		nand_correct_data(NULL, p, &ecc_code[i], &ecc_calc[i]);
+		if (nand_correct_data(NULL, p, &ecc_code[i], &ecc_calc[i]) < 0)
+			ret = -1;
+
+	return ret;
+}
+
+/*
+ * Look for the main and mirror BBT in the last blocks of the chip in the
+ * same way as nand_bbt.c does and cache the newer one, or the other one
+ * if the newer has an uncorrectable ECC error. @buf must hold one page.
+ * Returns 0 if a table has been loaded.
+ */
+int ltq_nand_spl_scan_bbt(void *buf)
+{
+#if defined(CONFIG_SYS_NAND_USE_FLASH_BBT) && defined(CONFIG_SYS_NAND_SIZE)
+	u8 oob[CONFIG_SYS_NAND_OOBSIZE];
+	int block, i, main = -1, mirror = -1, first, second;
+	u8 main_ver = 0, mirror_ver = 0;
+
+	for (i = 0; i < LTQ_NAND_BBT_MAXBLOCKS; i++) {
+		block = SPL_NAND_BLOCKS - 1 - i;
+		spl_nand_read_oob(block, 0, oob);
+
+		if (main < 0 && !memcmp(oob + LTQ_NAND_BBT_OFFS,
+			ltq_nand_bbt_pattern, LTQ_NAND_BBT_LEN)) {
+			main = block;
+			main_ver = oob[LTQ_NAND_BBT_VEROFFS];
+		}
+
+		if (mirror < 0 && !memcmp(oob + LTQ_NAND_BBT_OFFS,
+			ltq_nand_mirror_pattern, LTQ_NAND_BBT_LEN)) {
+			mirror = block;
+			mirror_ver = oob[LTQ_NAND_BBT_VEROFFS];
+		}
+	}
+
+	if (main >= 0 && (mirror < 0 || main_ver >= mirror_ver)) {
+		first = main;
+		second = mirror;
+	} else {
+		first = mirror;
+		second = main;
+	}
+
+	if (first < 0)
+		return -1;
+
+	/* without any table the OOB bad block markers are used */
+	if (spl_nand_read_page(first, 0, buf, oob) &&
+	    (second < 0 || spl_nand_read_page(second, 0, buf, oob)))
+		return -1;
+
+	memcpy(spl_nand_bbt, buf, SPL_NAND_BBT_SIZE);
+	spl_nand_bbt_valid = 1;
 
 	return 0;
+#else
+	return -1;
+#endif
+}
+
+static int spl_nand_block_isbad(unsigned int block)
+{
+	u8 oob[CONFIG_SYS_NAND_OOBSIZE];
+
+	/* the boot ROM has just loaded the SPL from there */
+	if (!block)
+		return 0;
+
+#if defined(CONFIG_SYS_NAND_USE_FLASH_BBT) && defined(CONFIG_SYS_NAND_SIZE)
+	/* two bits per block, both set for a good block */
+	if (spl_nand_bbt_valid)
+		return block >= SPL_NAND_BLOCKS ||
+			((spl_nand_bbt[block >> 2] >> ((block & 3) << 1)) &
+			0x3) != 0x3;
+#endif
+
+	spl_nand_read_oob(block, 0, oob);
+
+	return oob[SPL_NAND_BADBLOCK_POS] != 0xff;
+}
+
+/*
+ * Images are written with bad blocks skipped, so the n-th block of an
+ * image is the n-th good block of the chip.
+ */
+static unsigned int spl_nand_map_block(unsigned int lblock)
+{
+	if (lblock < spl_nand_lblock) {
+		spl_nand_lblock = 0;
+		spl_nand_pblock = 0;
+	}
+
+	for (;;) {
+		while (spl_nand_block_isbad(spl_nand_pblock))
+			spl_nand_pblock++;
+
+		if (spl_nand_lblock == lblock)
+			break;
+
+		spl_nand_lblock++;
+		spl_nand_pblock++;
+	}
+
+	return spl_nand_pblock;
 }
 
 int nand_spl_load_image(uint32_t offs, unsigned int size, void *dst)
@@ -246,10 +472,14 @@ int nand_spl_load_image(uint32_t offs, unsigned int size, void *dst)
 	unsigned int page = (offs % CONFIG_SYS_NAND_BLOCK_SIZE) /
 					CONFIG_SYS_NAND_PAGE_SIZE;
 	unsigned int cnt = 0;
+	unsigned int pblock;
+	u8 oob[CONFIG_SYS_NAND_OOBSIZE];
 
 	while (block <= lastblock) {
+		pblock = spl_nand_map_block(block);
+
 		while (page < CONFIG_SYS_NAND_PAGE_COUNT) {
-			spl_nand_read_page(block, page, dst);
+			spl_nand_read_page(pblock, page, dst, oob);
 			dst += CONFIG_SYS_NAND_PAGE_SIZE;
 			page++;
 
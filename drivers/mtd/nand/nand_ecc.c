@@ -62,6 +62,72 @@ static const u_char nand_ecc_precalc_table[] = {
 	0x00, 0x55, 0x56, 0x03, 0x59, 0x0c, 0x0f, 0x5a, 0x5a, 0x0f, 0x0c, 0x59, 0x03, 0x56, 0x55, 0x00
 };
 
+/*
+ * Byte-wise column and line parity, used for buffers which are not word
+ * aligned.
+ */
+static void nand_ecc_parity_bytes(const u_char *dat, uint8_t *reg1,
+				  uint8_t *reg2, uint8_t *reg3)
+{
+	uint8_t idx;
+	int i;
+
+	for (i = 0; i < 256; i++) {
+		/* Get CP0 - CP5 from table */
+		idx = nand_ecc_precalc_table[*dat++];
+		*reg1 ^= (idx & 0x3f);
+
+		/* All bit XOR = 1 ? */
+		if (idx & 0x40) {
+			*reg3 ^= (uint8_t) i;
+			*reg2 ^= ~((uint8_t) i);
+		}
+	}
+}
+
+/*
+ * Word-wise column and line parity. Both are linear in the data, so the
+ * XOR of all words yields the column parity and the two low line parity
+ * bits (byte position within the word), while the indices of the words
+ * with odd parity yield the remaining line parity bits. This needs one
+ * table lookup per word instead of one per byte.
+ */
+static void nand_ecc_parity_words(const u_char *dat, uint8_t *reg1,
+				  uint8_t *reg2, uint8_t *reg3)
+{
+	const uint32_t *p = (const uint32_t *)dat;
+	union {
+		uint32_t w;
+		uint8_t b[4];
+	} sum;
+	uint32_t w, idx = 0;
+	uint8_t par;
+	int i;
+
+	sum.w = 0;
+	for (i = 0; i < 64; i++) {
+		w = *p++;
+		sum.w ^= w;
+		w ^= w >> 16;
+		w ^= w >> 8;
+		if (nand_ecc_precalc_table[w & 0xff] & 0x40)
+			idx ^= i;
+	}
+
+	/* Line parity bits 2..7 come from the word index */
+	*reg3 = idx << 2;
+
+	/* Line parity bits 0 and 1 come from the byte within the word */
+	if (nand_ecc_precalc_table[sum.b[1] ^ sum.b[3]] & 0x40)
+		*reg3 |= 0x01;
+	if (nand_ecc_precalc_table[sum.b[2] ^ sum.b[3]] & 0x40)
+		*reg3 |= 0x02;
+
+	par = nand_ecc_precalc_table[sum.b[0] ^ sum.b[1] ^ sum.b[2] ^ sum.b[3]];
+	*reg1 = par & 0x3f;
+	*reg2 = (par & 0x40) ? ~*reg3 : *reg3;
+}
+
 /**
  * nand_calculate_ecc - [NAND Interface] Calculate 3-byte ECC for 256-byte block
  * @mtd:	MTD block structure
@@ -71,24 +137,16 @@ static const u_char nand_ecc_precalc_table[] = {
 int nand_calculate_ecc(struct mtd_info *mtd, const u_char *dat,
 		       u_char *ecc_code)
 {
-	uint8_t idx, reg1, reg2, reg3, tmp1, tmp2;
-	int i;
+	uint8_t reg1, reg2, reg3, tmp1, tmp2;
 
 	/* Initialize variables */
 	reg1 = reg2 = reg3 = 0;
 
-	/* Build up column parity */
-	for(i = 0; i < 256; i++) {
-		/* Get CP0 - CP5 from table */
-		idx = nand_ecc_precalc_table[*dat++];
-		reg1 ^= (idx & 0x3f);
-
-		/* All bit XOR = 1 ? */
-		if (idx & 0x40) {
-			reg3 ^= (uint8_t) i;
-			reg2 ^= ~((uint8_t) i);
-		}
-	}
+	/* Build up column and line parity */
+	if ((unsigned long)dat & 3)
+		nand_ecc_parity_bytes(dat, &reg1, &reg2, &reg3);
+	else
+		nand_ecc_parity_words(dat, &reg1, &reg2, &reg3);
 
 	/* Create non-inverted ECC code from line parity */
 	tmp1  = (reg3 & 0x80) >> 0; /* B7 -> B7 */
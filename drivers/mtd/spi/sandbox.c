@@ -220,6 +220,8 @@ static int sandbox_sf_process_cmd(struct sandbox_spi_flash *sbsf, const u8 *rx,
 		sbsf->cmd = SF_ID;
 		break;
 	case CMD_READ_ARRAY_FAST:
+	case CMD_READ_DUAL_OUTPUT_FAST:
+		/* Dual output only differs in the data phase wiring */
 		sbsf->pad_addr_bytes = 1;
 	case CMD_READ_ARRAY_SLOW:
 	case CMD_PAGE_PROGRAM:
@@ -340,6 +342,7 @@ static int sandbox_sf_xfer(void *priv, const u8 *rx, u8 *tx,
 			}
 			switch (sbsf->cmd) {
 			case CMD_READ_ARRAY_FAST:
+			case CMD_READ_DUAL_OUTPUT_FAST:
 			case CMD_READ_ARRAY_SLOW:
 				sbsf->state = SF_READ;
 				break;
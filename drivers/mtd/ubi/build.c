@@ -76,6 +76,11 @@ static struct miscdevice ubi_ctrl_cdev = {
 /* All UBI devices in system */
 struct ubi_device *ubi_devices[UBI_MAX_DEVICES];
 
+#ifdef CONFIG_MTD_UBI_FASTMAP
+/* Set to attach by scanning, e.g. to get a writable device */
+int ubi_fastmap_disabled;
+#endif
+
 #ifdef UBI_LINUX
 /* Serializes UBI devices creations and removals */
 DEFINE_MUTEX(ubi_devices_mutex);
@@ -436,24 +441,37 @@ static void uif_close(struct ubi_device *ubi)
 
 /**
  * attach_by_scanning - attach an MTD device using scanning method.
- * @ubi: UBI device descriptor
+ * @ubi: UBI device description object
  *
  * This function returns zero in case of success and a negative error code in
  * case of failure.
  *
- * Note, currently this is the only method to attach UBI devices. Hopefully in
- * the future we'll have more scalable attaching methods and avoid full media
- * scanning. But even in this case scanning will be needed as a fall-back
- * attaching method if there are some on-flash table corruptions.
+ * With %CONFIG_MTD_UBI_FASTMAP a fastmap written by Linux is used instead of
+ * scanning the whole device, unless the "ubifastmap" environment variable is
+ * set to "no" or @ubi_fastmap_disabled is set. The device is read-only in
+ * this case, see fastmap.c. If there is no usable fastmap, the device is
+ * scanned.
  */
 static int attach_by_scanning(struct ubi_device *ubi)
 {
-	int err;
-	struct ubi_scan_info *si;
-
-	si = ubi_scan(ubi);
-	if (IS_ERR(si))
-		return PTR_ERR(si);
+	int err, __maybe_unused fastmap = 0;
+	struct ubi_scan_info *si = NULL;
+	ulong __maybe_unused start = get_timer(0);
+
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	if (!ubi_fastmap_disabled && getenv_yesno("ubifastmap") != 0) {
+		si = ubi_scan_fastmap(ubi);
+		if (IS_ERR(si))
+			return PTR_ERR(si);
+		if (si)
+			ubi->ro_mode = ubi->fm_attached = fastmap = 1;
+	}
+#endif
+	if (!si) {
+		si = ubi_scan(ubi);
+		if (IS_ERR(si))
+			return PTR_ERR(si);
+	}
 
 	ubi->bad_peb_count = si->bad_peb_count;
 	ubi->good_peb_count = ubi->peb_count - ubi->bad_peb_count;
@@ -473,6 +491,9 @@ static int attach_by_scanning(struct ubi_device *ubi)
 		goto out_eba;
 
 	ubi_scan_destroy_si(si);
+	ubi_msg("attached by %s in %lu ms%s",
+		fastmap ? "fastmap" : "scanning", get_timer(start),
+		fastmap ? ", read-only" : "");
 	return 0;
 
 out_eba:
@@ -0,0 +1,646 @@
+/*
+ * Based on the UBI fastmap implementation in Linux,
+ * Copyright (c) 2012 Linutronix GmbH, Author: Richard Weinberger
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+/*
+ * UBI fastmap attaching unit (read-only).
+ *
+ * Linux may store a fastmap on the flash: a snapshot of the erase counters,
+ * the EBA tables and the free list, which makes a full scan unnecessary.
+ * This unit looks for the fastmap anchor in the first %UBI_FM_MAX_START
+ * physical eraseblocks, reads and checks the fastmap and builds the same
+ * &struct ubi_scan_info a full scan would produce. Only the PEBs of the two
+ * fastmap pools have to be read, because Linux may have written them after
+ * the fastmap was taken.
+ *
+ * Fastmap is never written, so the device has to stay read-only after it was
+ * attached this way: the fastmap would not know about any change and Linux
+ * would lose data on the next attach.
+ */
+
+#include <ubi_uboot.h>
+#include "ubi.h"
+
+/* State of a physical eraseblock while the fastmap is applied */
+enum {
+	FM_PEB_UNKNOWN = 0,
+	FM_PEB_LISTED,	/* in the free or erase list */
+	FM_PEB_USED,	/* used, not yet found in an EBA table */
+	FM_PEB_SCRUB,	/* used and has to be scrubbed */
+	FM_PEB_MAPPED,	/* found in an EBA table */
+	FM_PEB_POOL,	/* has to be scanned */
+	FM_PEB_FASTMAP,	/* holds the fastmap itself */
+};
+
+struct fm_peb {
+	int ec;
+	int state;
+};
+
+/* Temporary variables used while attaching */
+static struct ubi_ec_hdr *ech;
+static struct ubi_vid_hdr *vidh;
+
+/**
+ * find_anchor - find the newest fastmap super block.
+ * @ubi: UBI device description object
+ *
+ * Returns the PEB holding the fastmap super block with the highest sequence
+ * number or %-1 if there is none.
+ */
+static int find_anchor(struct ubi_device *ubi)
+{
+	unsigned long long sqnum, max_sqnum = 0;
+	int pnum, err, anchor = -1;
+
+	for (pnum = 0; pnum < UBI_FM_MAX_START && pnum < ubi->peb_count;
+	     pnum++) {
+		if (ubi_io_is_bad(ubi, pnum))
+			continue;
+
+		err = ubi_io_read_vid_hdr(ubi, pnum, vidh, 0);
+		if (err && err != UBI_IO_BITFLIPS)
+			continue;
+
+		if (be32_to_cpu(vidh->vol_id) != UBI_FM_SB_VOLUME_ID)
+			continue;
+
+		sqnum = be64_to_cpu(vidh->sqnum);
+		if (anchor < 0 || sqnum > max_sqnum) {
+			anchor = pnum;
+			max_sqnum = sqnum;
+		}
+	}
+
+	return anchor;
+}
+
+/**
+ * read_fastmap - read and check the fastmap data.
+ * @ubi: UBI device description object
+ * @anchor: PEB holding the fastmap super block
+ * @peb: per-PEB state, the fastmap PEBs are marked
+ * @sqnum: highest sequence number of the fastmap PEBs is stored here
+ *
+ * Returns the fastmap data of all fastmap PEBs, which starts with the super
+ * block, %NULL if the fastmap is not valid or an error pointer.
+ */
+static void *read_fastmap(struct ubi_device *ubi, int anchor,
+			  struct fm_peb *peb, unsigned long long *sqnum)
+{
+	struct ubi_fm_sb *fmsb;
+	uint32_t crc, data_crc;
+	int i, err, pnum, used_blocks, vol_id;
+	void *fm_raw = NULL;
+	size_t fm_size;
+
+	fmsb = kmalloc(sizeof(*fmsb), GFP_KERNEL);
+	if (!fmsb)
+		return ERR_PTR(-ENOMEM);
+
+	err = ubi_io_read(ubi, fmsb, anchor, ubi->leb_start, sizeof(*fmsb));
+	if (err && err != UBI_IO_BITFLIPS)
+		goto out_bad;
+
+	if (be32_to_cpu(fmsb->magic) != UBI_FM_SB_MAGIC) {
+		ubi_err("bad fastmap super block magic 0x%x",
+			be32_to_cpu(fmsb->magic));
+		goto out_bad;
+	}
+
+	if (fmsb->version != UBI_FM_FMT_VERSION) {
+		ubi_err("bad fastmap version %d, expected %d",
+			fmsb->version, UBI_FM_FMT_VERSION);
+		goto out_bad;
+	}
+
+	used_blocks = be32_to_cpu(fmsb->used_blocks);
+	if (used_blocks < 1 || used_blocks > UBI_FM_MAX_BLOCKS ||
+	    be32_to_cpu(fmsb->block_loc[0]) != anchor) {
+		ubi_err("bad fastmap block count %d", used_blocks);
+		goto out_bad;
+	}
+
+	fm_size = ubi->leb_size * used_blocks;
+	fm_raw = vmalloc(fm_size);
+	if (!fm_raw) {
+		kfree(fmsb);
+		return ERR_PTR(-ENOMEM);
+	}
+
+	*sqnum = 0;
+	for (i = 0; i < used_blocks; i++) {
+		pnum = be32_to_cpu(fmsb->block_loc[i]);
+		if (pnum < 0 || pnum >= ubi->peb_count ||
+		    peb[pnum].state != FM_PEB_UNKNOWN ||
+		    ubi_io_is_bad(ubi, pnum))
+			goto out_bad;
+
+		err = ubi_io_read_vid_hdr(ubi, pnum, vidh, 0);
+		if (err && err != UBI_IO_BITFLIPS)
+			goto out_bad;
+
+		vol_id = be32_to_cpu(vidh->vol_id);
+		if (vol_id != (i ? UBI_FM_DATA_VOLUME_ID : UBI_FM_SB_VOLUME_ID))
+			goto out_bad;
+
+		if (*sqnum < be64_to_cpu(vidh->sqnum))
+			*sqnum = be64_to_cpu(vidh->sqnum);
+
+		err = ubi_io_read(ubi, fm_raw + ubi->leb_size * i, pnum,
+				  ubi->leb_start, ubi->leb_size);
+		if (err && err != UBI_IO_BITFLIPS)
+			goto out_bad;
+
+		peb[pnum].state = FM_PEB_FASTMAP;
+	}
+
+	/* The CRC is calculated with the CRC field cleared */
+	kfree(fmsb);
+	fmsb = fm_raw;
+	data_crc = be32_to_cpu(fmsb->data_crc);
+	fmsb->data_crc = 0;
+	crc = crc32(UBI_CRC32_INIT, fm_raw, fm_size);
+	if (crc != data_crc) {
+		ubi_err("fastmap data CRC is invalid: calculated %#08x, "
+			"must be %#08x", crc, data_crc);
+		vfree(fm_raw);
+		return NULL;
+	}
+
+	if (*sqnum < be64_to_cpu(fmsb->sqnum))
+		*sqnum = be64_to_cpu(fmsb->sqnum);
+
+	return fm_raw;
+
+out_bad:
+	ubi_err("cannot read fastmap from PEB %d", anchor);
+	vfree(fm_raw);
+	kfree(fmsb);
+	return NULL;
+}
+
+/**
+ * add_volume - add a volume described by the fastmap.
+ * @si: scanning information
+ * @fmvhdr: fastmap volume header
+ *
+ * Returns the new scanning volume object or an error pointer.
+ */
+static struct ubi_scan_volume *add_volume(struct ubi_scan_info *si,
+					  const struct ubi_fm_volhdr *fmvhdr)
+{
+	struct ubi_scan_volume *sv;
+	struct rb_node **p = &si->volumes.rb_node, *parent = NULL;
+	int vol_id = be32_to_cpu(fmvhdr->vol_id);
+
+	while (*p) {
+		parent = *p;
+		sv = rb_entry(parent, struct ubi_scan_volume, rb);
+
+		if (vol_id == sv->vol_id)
+			return ERR_PTR(-EINVAL);
+
+		if (vol_id > sv->vol_id)
+			p = &(*p)->rb_left;
+		else
+			p = &(*p)->rb_right;
+	}
+
+	sv = kzalloc(sizeof(struct ubi_scan_volume), GFP_KERNEL);
+	if (!sv)
+		return ERR_PTR(-ENOMEM);
+
+	sv->vol_id = vol_id;
+	sv->root = RB_ROOT;
+	sv->vol_type = fmvhdr->vol_type;
+	sv->data_pad = be32_to_cpu(fmvhdr->data_pad);
+	if (vol_id == UBI_LAYOUT_VOLUME_ID)
+		sv->compat = UBI_LAYOUT_VOLUME_COMPAT;
+
+	/* Match what scanning takes from the VID headers */
+	if (sv->vol_type == UBI_STATIC_VOLUME) {
+		sv->used_ebs = be32_to_cpu(fmvhdr->used_ebs);
+		sv->last_data_size = be32_to_cpu(fmvhdr->last_eb_bytes);
+	}
+
+	if (vol_id > si->highest_vol_id)
+		si->highest_vol_id = vol_id;
+
+	rb_link_node(&sv->rb, parent, p);
+	rb_insert_color(&sv->rb, &si->volumes);
+	si->vols_found += 1;
+	dbg_bld("added volume %d from fastmap", vol_id);
+	return sv;
+}
+
+/**
+ * add_leb - add a logical eraseblock known by the fastmap to a volume.
+ * @sv: volume scanning information
+ * @pnum: physical eraseblock number
+ * @lnum: logical eraseblock number
+ * @ec: erase counter
+ * @scrub: if the physical eraseblock has to be scrubbed
+ *
+ * The fastmap does not store sequence numbers, so the LEB gets the lowest
+ * one. A copy found in a pool PEB is always newer.
+ */
+static int add_leb(struct ubi_scan_volume *sv, int pnum, int lnum, int ec,
+		   int scrub)
+{
+	struct ubi_scan_leb *seb;
+	struct rb_node **p = &sv->root.rb_node, *parent = NULL;
+
+	while (*p) {
+		parent = *p;
+		seb = rb_entry(parent, struct ubi_scan_leb, u.rb);
+		if (lnum < seb->lnum)
+			p = &(*p)->rb_left;
+		else
+			p = &(*p)->rb_right;
+	}
+
+	seb = kzalloc(sizeof(struct ubi_scan_leb), GFP_KERNEL);
+	if (!seb)
+		return -ENOMEM;
+
+	seb->ec = ec;
+	seb->pnum = pnum;
+	seb->lnum = lnum;
+	seb->scrub = scrub;
+
+	if (sv->highest_lnum <= lnum)
+		sv->highest_lnum = lnum;
+
+	sv->leb_count += 1;
+	rb_link_node(&seb->u.rb, parent, p);
+	rb_insert_color(&seb->u.rb, &sv->root);
+	return 0;
+}
+
+/**
+ * read_ec - read the erase counter of a physical eraseblock.
+ * @ubi: UBI device description object
+ * @pnum: physical eraseblock number
+ * @bitflips: set if bit-flips were detected
+ *
+ * Returns the erase counter or a negative value if the EC header is not
+ * usable.
+ */
+static int read_ec(struct ubi_device *ubi, int pnum, int *bitflips)
+{
+	long long ec;
+	int err;
+
+	if (ubi_io_is_bad(ubi, pnum))
+		return -EINVAL;
+
+	err = ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
+	if (err && err != UBI_IO_BITFLIPS)
+		return -EINVAL;
+
+	*bitflips = (err == UBI_IO_BITFLIPS);
+
+	ec = be64_to_cpu(ech->ec);
+	if (ech->version != UBI_VERSION || ec > UBI_MAX_ERASECOUNTER)
+		return -EINVAL;
+
+	return ec;
+}
+
+/**
+ * scan_pool - read the headers of a fastmap pool PEB.
+ * @ubi: UBI device description object
+ * @si: scanning information
+ * @pnum: physical eraseblock number
+ *
+ * Returns zero in case of success and a negative error code if the PEB
+ * could not be added.
+ */
+static int scan_pool(struct ubi_device *ubi, struct ubi_scan_info *si,
+		     int pnum)
+{
+	int err, ec, bitflips, vol_id;
+
+	ec = read_ec(ubi, pnum, &bitflips);
+	if (ec < 0)
+		return ec;
+
+	err = ubi_io_read_vid_hdr(ubi, pnum, vidh, 0);
+	if (err == UBI_IO_PEB_FREE)
+		return ubi_scan_add_to_list(si, pnum, ec, &si->free);
+	if (err == UBI_IO_BITFLIPS)
+		bitflips = 1;
+	else if (err)
+		return -EINVAL;
+
+	/* Leave anything special to a full scan */
+	vol_id = be32_to_cpu(vidh->vol_id);
+	if (vol_id > UBI_MAX_VOLUMES && vol_id != UBI_LAYOUT_VOLUME_ID)
+		return -EINVAL;
+
+	return ubi_scan_add_used(ubi, si, pnum, ec, vidh, bitflips);
+}
+
+/**
+ * attach_fastmap - build scanning information from fastmap data.
+ * @ubi: UBI device description object
+ * @si: scanning information to fill in
+ * @fm_raw: fastmap data as returned by read_fastmap()
+ * @peb: per-PEB state
+ *
+ * Returns zero in case of success, a positive value if the fastmap is not
+ * usable and a negative error code in case of failure.
+ */
+static int attach_fastmap(struct ubi_device *ubi, struct ubi_scan_info *si,
+			  void *fm_raw, struct fm_peb *peb)
+{
+	size_t fm_pos = sizeof(struct ubi_fm_sb);
+	size_t fm_size = ubi->leb_size *
+		be32_to_cpu(((struct ubi_fm_sb *)fm_raw)->used_blocks);
+	struct ubi_fm_scan_pool *fmpl[2];
+	struct ubi_fm_volhdr *fmvhdr;
+	struct ubi_fm_hdr *fmhdr;
+	struct ubi_fm_eba *fm_eba;
+	struct ubi_fm_ec *fmec;
+	struct ubi_scan_volume *sv;
+	struct ubi_scan_leb *seb;
+	struct rb_node *rb1, *rb2;
+	int i, j, err, pnum, ec, bitflips, count;
+	int nfree, nused, nscrub, nerase, npool;
+
+	fmhdr = fm_raw + fm_pos;
+	fm_pos += sizeof(*fmhdr);
+	if (be32_to_cpu(fmhdr->magic) != UBI_FM_HDR_MAGIC)
+		return 1;
+
+	for (i = 0; i < 2; i++) {
+		fmpl[i] = fm_raw + fm_pos;
+		fm_pos += sizeof(*fmpl[i]);
+		if (be32_to_cpu(fmpl[i]->magic) != UBI_FM_POOL_MAGIC ||
+		    be16_to_cpu(fmpl[i]->size) > UBI_FM_MAX_POOL_SIZE)
+			return 1;
+	}
+
+	nfree = be32_to_cpu(fmhdr->free_peb_count);
+	nused = be32_to_cpu(fmhdr->used_peb_count);
+	nscrub = be32_to_cpu(fmhdr->scrub_peb_count);
+	nerase = be32_to_cpu(fmhdr->erase_peb_count);
+	count = nfree + nused + nscrub + nerase;
+	if (nfree < 0 || nused < 0 || nscrub < 0 || nerase < 0 ||
+	    count > ubi->peb_count ||
+	    fm_pos + count * sizeof(*fmec) > fm_size)
+		return 1;
+
+	/* Erase counters of the free, used, scrub and erase lists */
+	for (i = 0; i < count; i++) {
+		fmec = fm_raw + fm_pos;
+		fm_pos += sizeof(*fmec);
+
+		pnum = be32_to_cpu(fmec->pnum);
+		ec = be32_to_cpu(fmec->ec);
+		if (pnum < 0 || pnum >= ubi->peb_count ||
+		    peb[pnum].state != FM_PEB_UNKNOWN ||
+		    ec < 0 || ec > UBI_MAX_ERASECOUNTER)
+			return 1;
+
+		peb[pnum].ec = ec;
+		err = 0;
+		if (i < nfree) {
+			peb[pnum].state = FM_PEB_LISTED;
+			err = ubi_scan_add_to_list(si, pnum, ec, &si->free);
+		} else if (i < nfree + nused) {
+			peb[pnum].state = FM_PEB_USED;
+		} else if (i < nfree + nused + nscrub) {
+			peb[pnum].state = FM_PEB_SCRUB;
+		} else {
+			peb[pnum].state = FM_PEB_LISTED;
+			err = ubi_scan_add_to_list(si, pnum, ec, &si->erase);
+		}
+		if (err)
+			return err;
+	}
+
+	for (i = 0; i < 2; i++) {
+		npool = be16_to_cpu(fmpl[i]->size);
+		for (j = 0; j < npool; j++) {
+			pnum = be32_to_cpu(fmpl[i]->pebs[j]);
+			if (pnum < 0 || pnum >= ubi->peb_count ||
+			    peb[pnum].state != FM_PEB_UNKNOWN)
+				return 1;
+			peb[pnum].state = FM_PEB_POOL;
+		}
+	}
+
+	/* Volumes and their EBA tables */
+	for (i = 0; i < be32_to_cpu(fmhdr->vol_count); i++) {
+		fmvhdr = fm_raw + fm_pos;
+		fm_pos += sizeof(*fmvhdr);
+		fm_eba = fm_raw + fm_pos;
+		fm_pos += sizeof(*fm_eba);
+		if (fm_pos > fm_size ||
+		    be32_to_cpu(fmvhdr->magic) != UBI_FM_VHDR_MAGIC ||
+		    be32_to_cpu(fm_eba->magic) != UBI_FM_EBA_MAGIC)
+			return 1;
+
+		count = be32_to_cpu(fm_eba->reserved_pebs);
+		fm_pos += sizeof(__be32) * count;
+		if (count < 0 || count > ubi->peb_count || fm_pos > fm_size)
+			return 1;
+
+		if (fmvhdr->vol_type != UBI_DYNAMIC_VOLUME &&
+		    fmvhdr->vol_type != UBI_STATIC_VOLUME)
+			return 1;
+
+		sv = add_volume(si, fmvhdr);
+		if (IS_ERR(sv))
+			return PTR_ERR(sv) == -ENOMEM ? -ENOMEM : 1;
+
+		for (j = 0; j < count; j++) {
+			pnum = be32_to_cpu(fm_eba->pnum[j]);
+			if (pnum < 0)
+				continue;
+			if (pnum >= ubi->peb_count)
+				return 1;
+
+			switch (peb[pnum].state) {
+			case FM_PEB_POOL:
+				/* The pool scan finds the current copy */
+				continue;
+			case FM_PEB_USED:
+			case FM_PEB_SCRUB:
+				break;
+			case FM_PEB_UNKNOWN:
+				/*
+				 * Was in the protection queue while the
+				 * fastmap was written, only the EC is missing.
+				 */
+				ec = read_ec(ubi, pnum, &bitflips);
+				if (ec < 0)
+					return 1;
+				peb[pnum].ec = ec;
+				peb[pnum].state = bitflips ? FM_PEB_SCRUB :
+							     FM_PEB_USED;
+				break;
+			default:
+				return 1;
+			}
+
+			err = add_leb(sv, pnum, j, peb[pnum].ec,
+				      peb[pnum].state == FM_PEB_SCRUB);
+			if (err)
+				return err;
+			peb[pnum].state = FM_PEB_MAPPED;
+		}
+	}
+
+	/* Used PEBs that no EBA table refers to are stale */
+	for (pnum = 0; pnum < ubi->peb_count; pnum++) {
+		if (peb[pnum].state != FM_PEB_USED &&
+		    peb[pnum].state != FM_PEB_SCRUB)
+			continue;
+
+		err = ubi_scan_add_to_list(si, pnum, peb[pnum].ec, &si->erase);
+		if (err)
+			return err;
+	}
+
+	for (pnum = 0; pnum < ubi->peb_count; pnum++) {
+		if (peb[pnum].state != FM_PEB_POOL)
+			continue;
+
+		err = scan_pool(ubi, si, pnum);
+		if (err) {
+			ubi_err("bad fastmap pool PEB %d", pnum);
+			return err == -ENOMEM ? err : 1;
+		}
+	}
+
+	/* Every good PEB must be accounted for exactly once */
+	count = be32_to_cpu(fmhdr->bad_peb_count);
+	for (pnum = 0; pnum < ubi->peb_count; pnum++)
+		if (peb[pnum].state == FM_PEB_FASTMAP)
+			count++;
+
+	si->min_ec = UBI_MAX_ERASECOUNTER;
+	ubi_rb_for_each_entry(rb1, sv, &si->volumes, rb) {
+		ubi_rb_for_each_entry(rb2, seb, &sv->root, u.rb) {
+			si->ec_sum += seb->ec;
+			si->ec_count++;
+			si->min_ec = min(si->min_ec, seb->ec);
+			si->max_ec = max(si->max_ec, seb->ec);
+		}
+	}
+
+	list_for_each_entry(seb, &si->free, u.list) {
+		si->ec_sum += seb->ec;
+		si->ec_count++;
+		si->min_ec = min(si->min_ec, seb->ec);
+		si->max_ec = max(si->max_ec, seb->ec);
+	}
+
+	list_for_each_entry(seb, &si->erase, u.list) {
+		si->ec_sum += seb->ec;
+		si->ec_count++;
+	}
+
+	list_for_each_entry(seb, &si->corr, u.list)
+		count++;
+
+	if (count + si->ec_count != ubi->peb_count) {
+		ubi_err("fastmap accounts for %d of %d PEBs",
+			count + si->ec_count, ubi->peb_count);
+		return 1;
+	}
+
+	if (si->ec_count) {
+		do_div(si->ec_sum, si->ec_count);
+		si->mean_ec = si->ec_sum;
+	}
+
+	si->bad_peb_count = be32_to_cpu(fmhdr->bad_peb_count);
+	si->is_empty = 0;
+	return 0;
+}
+
+/**
+ * ubi_scan_fastmap - attach an MTD device using the fastmap.
+ * @ubi: UBI device description object
+ *
+ * Returns the scanning information built from the fastmap, %NULL if there is
+ * no usable fastmap and the device has to be scanned, or an error pointer in
+ * case of failure.
+ */
+struct ubi_scan_info *ubi_scan_fastmap(struct ubi_device *ubi)
+{
+	struct ubi_scan_info *si = NULL;
+	unsigned long long sqnum;
+	struct fm_peb *peb = NULL;
+	void *fm_raw = NULL;
+	int anchor, err = -ENOMEM;
+
+	ech = kzalloc(ubi->ec_hdr_alsize, GFP_KERNEL);
+	if (!ech)
+		return ERR_PTR(-ENOMEM);
+
+	vidh = ubi_zalloc_vid_hdr(ubi, GFP_KERNEL);
+	if (!vidh)
+		goto out_ech;
+
+	anchor = find_anchor(ubi);
+	if (anchor < 0) {
+		err = 0;
+		goto out_vidh;
+	}
+
+	peb = vmalloc(ubi->peb_count * sizeof(*peb));
+	if (!peb)
+		goto out_vidh;
+	memset(peb, 0, ubi->peb_count * sizeof(*peb));
+
+	fm_raw = read_fastmap(ubi, anchor, peb, &sqnum);
+	if (IS_ERR(fm_raw)) {
+		err = PTR_ERR(fm_raw);
+		fm_raw = NULL;
+		goto out_peb;
+	}
+
+	err = 0;
+	if (!fm_raw)
+		goto out_peb;
+
+	si = ubi_scan_alloc_si();
+	if (!si) {
+		err = -ENOMEM;
+		goto out_peb;
+	}
+
+	err = attach_fastmap(ubi, si, fm_raw, peb);
+	if (err) {
+		ubi_scan_destroy_si(si);
+		si = NULL;
+		if (err > 0)
+			err = 0;
+		goto out_peb;
+	}
+
+	if (si->max_sqnum < sqnum)
+		si->max_sqnum = sqnum;
+
+	ubi_msg("fastmap found in PEB %d", anchor);
+
+out_peb:
+	vfree(fm_raw);
+	vfree(peb);
+	if (!si && !err)
+		ubi_msg("no usable fastmap, scanning");
+out_vidh:
+	ubi_free_vid_hdr(ubi, vidh);
+out_ech:
+	kfree(ech);
+
+	return err ? ERR_PTR(err) : si;
+}
@@ -315,6 +315,7 @@ struct ubi_wl_entry;
  * @min_io_size: minimal input/output unit size of the underlying MTD device
  * @hdrs_min_io_size: minimal I/O unit size used for VID and EC headers
  * @ro_mode: if the UBI device is in read-only mode
+ * @fm_attached: if the UBI device was attached from a fastmap (read-only)
  * @leb_size: logical eraseblock size
  * @leb_start: starting offset of logical eraseblocks within physical
  * eraseblocks
@@ -398,6 +399,7 @@ struct ubi_device {
 	int min_io_size;
 	int hdrs_min_io_size;
 	int ro_mode;
+	int fm_attached;
 	int leb_size;
 	int leb_start;
 	int ec_hdr_alsize;
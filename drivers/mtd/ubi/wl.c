@@ -687,9 +687,11 @@ static void schedule_ubi_work(struct ubi_device *ubi, struct ubi_work *wrk)
 
 	/*
 	 * U-Boot special: We have no bgt_thread in U-Boot!
-	 * So just call do_work() here directly.
+	 * So just call do_work() here directly. In read-only mode the work
+	 * stays queued, just like the thread would not run it in Linux.
 	 */
-	do_work(ubi);
+	if (!ubi->ro_mode)
+		do_work(ubi);
 
 	spin_unlock(&ubi->wl_lock);
 }
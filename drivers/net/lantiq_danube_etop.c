@@ -41,7 +41,8 @@
 #define LTQ_PPE_ENETS0_CFG_FTUC		(1 << 28)
 
 #define LTQ_ETH_RX_BUFFER_CNT		PKTBUFSRX
-#define LTQ_ETH_TX_BUFFER_CNT		8
+#define LTQ_ETH_TX_BUFFER_CNT		16
+#define LTQ_ETH_TX_DATA_SIZE		PKTSIZE_ALIGN
 #define LTQ_ETH_RX_DATA_SIZE		PKTSIZE_ALIGN
 #define LTQ_ETH_IP_ALIGN		2
 
@@ -93,7 +94,6 @@ struct ltq_eth_priv {
 	struct mii_dev *bus;
 	struct eth_device *dev;
 	int rx_num;
-	int tx_num;
 };
 
 struct ltq_mdio_access {
@@ -213,10 +213,10 @@ static int ltq_eth_init(struct eth_device *dev, bd_t *bis)
 		ltq_dma_rx_map(dma_dev, i, ltq_eth_rx_packet_align(i),
 			LTQ_ETH_RX_DATA_SIZE);
 
+	ltq_dma_tx_ring_reset(dma_dev);
 	ltq_dma_enable(dma_dev);
 
 	priv->rx_num = 0;
-	priv->tx_num = 0;
 
 	return 0;
 }
@@ -226,6 +226,10 @@ static void ltq_eth_halt(struct eth_device *dev)
 	struct ltq_eth_priv *priv = dev->priv;
 	struct ltq_dma_device *dma_dev = &priv->dma_dev;
 
+	debug("%s: TX %u pps, RX %u dropped, %u overruns\n", dev->name,
+		ltq_dma_tx_ring_pps(dma_dev), dma_dev->rx_chan.stats.dropped,
+		dma_dev->rx_chan.stats.overruns);
+
 	ltq_dma_reset(dma_dev);
 }
 
@@ -239,14 +243,12 @@ static int ltq_eth_send(struct eth_device *dev, void *packet, int length)
 	if (length < 60)
 		length = 60;
 
-	err = ltq_dma_tx_map(dma_dev, priv->tx_num, packet, length, 10);
+	err = ltq_dma_tx_ring_send(dma_dev, packet, length, 10);
 	if (err) {
 		puts("NET: timeout on waiting for TX descriptor\n");
 		return -1;
 	}
 
-	priv->tx_num = (priv->tx_num + 1) % LTQ_ETH_TX_BUFFER_CNT;
-
 	return err;
 }
 
@@ -255,30 +257,36 @@ static int ltq_eth_recv(struct eth_device *dev)
 	struct ltq_eth_priv *priv = dev->priv;
 	struct ltq_dma_device *dma_dev = &priv->dma_dev;
 	u8 *packet;
-	int len;
+	int len, count;
 
-	if (!ltq_dma_rx_poll(dma_dev, priv->rx_num))
-		return 0;
+	/* Drain all completed descriptors, but stop after one lap */
+	for (count = 0; count < LTQ_ETH_RX_BUFFER_CNT; count++) {
+		if (!ltq_dma_rx_poll(dma_dev, priv->rx_num))
+			break;
 
 #if 0
-	printf("%s: rx_num %d\n", __func__, priv->rx_num);
+		printf("%s: rx_num %d\n", __func__, priv->rx_num);
 #endif
 
-	len = ltq_dma_rx_length(dma_dev, priv->rx_num);
-	packet = ltq_eth_rx_packet_align(priv->rx_num);
+		len = ltq_dma_rx_length(dma_dev, priv->rx_num);
+		packet = ltq_eth_rx_packet_align(priv->rx_num);
 
 #if 0
-	printf("%s: received: packet %p, len %u, rx_num %d\n",
-		__func__, packet, len, priv->rx_num);
+		printf("%s: received: packet %p, len %u, rx_num %d\n",
+			__func__, packet, len, priv->rx_num);
 #endif
 
-	if (len)
-		NetReceive(packet, len);
+		/* ltq_dma_rx_release() counts the others as dropped */
+		if (len > 0 && len <= LTQ_ETH_RX_DATA_SIZE) {
+			ltq_dma_rx_sync(dma_dev, packet, len);
+			NetReceive(packet, len);
+		}
 
-	ltq_dma_rx_map(dma_dev, priv->rx_num, packet,
-		LTQ_ETH_RX_DATA_SIZE);
+		ltq_dma_rx_release(dma_dev, priv->rx_num, packet,
+			LTQ_ETH_RX_DATA_SIZE, len);
 
-	priv->rx_num = (priv->rx_num + 1) % LTQ_ETH_RX_BUFFER_CNT;
+		priv->rx_num = (priv->rx_num + 1) % LTQ_ETH_RX_BUFFER_CNT;
+	}
 
 	return 0;
 }
@@ -363,6 +371,7 @@ int ltq_eth_initialize(const struct ltq_eth_board_config *board_config)
 	bus->priv = priv;
 
 	dma_dev = &priv->dma_dev;
+	dma_dev->name = LTQ_ETH_DRV_NAME;
 	dma_dev->port = 0;
 	dma_dev->rx_chan.chan_no = 6;
 	dma_dev->rx_chan.class = 3;
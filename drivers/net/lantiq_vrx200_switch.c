@@ -24,7 +24,8 @@
 #include <asm/arch/switch.h>
 
 #define LTQ_ETH_RX_BUFFER_CNT		PKTBUFSRX
-#define LTQ_ETH_TX_BUFFER_CNT		8
+#define LTQ_ETH_TX_BUFFER_CNT		16
+#define LTQ_ETH_TX_DATA_SIZE		PKTSIZE_ALIGN
 #define LTQ_ETH_RX_DATA_SIZE		PKTSIZE_ALIGN
 #define LTQ_ETH_IP_ALIGN		2
 #define LTQ_PHY_ANEG_TIMEOUT		3000
@@ -115,7 +116,6 @@ struct ltq_eth_priv {
 	struct eth_device *dev;
 	struct phy_device *phymap[LTQ_ETHSW_MAX_GMAC];
 	int rx_num;
-	int tx_num;
 };
 
 static struct vr9_switch_regs *switch_regs =
@@ -300,10 +300,10 @@ static int ltq_eth_init(struct eth_device *dev, bd_t * bis)
 		ltq_dma_rx_map(dma_dev, i, ltq_eth_rx_packet_align(i),
 			LTQ_ETH_RX_DATA_SIZE);
 
+	ltq_dma_tx_ring_reset(dma_dev);
 	ltq_dma_enable(dma_dev);
 
 	priv->rx_num = 0;
-	priv->tx_num = 0;
 
 	return 0;
 }
@@ -315,6 +315,10 @@ static void ltq_eth_halt(struct eth_device *dev)
 	struct phy_device *phydev;
 	int i;
 
+	debug("%s: TX %u pps, RX %u dropped, %u overruns\n", dev->name,
+		ltq_dma_tx_ring_pps(dma_dev), dma_dev->rx_chan.stats.dropped,
+		dma_dev->rx_chan.stats.overruns);
+
 	ltq_dma_reset(dma_dev);
 
 	for (i = 0; i < LTQ_ETHSW_MAX_GMAC; i++) {
@@ -332,13 +336,17 @@ static int ltq_eth_send(struct eth_device *dev, void *packet, int length)
 {
 	struct ltq_eth_priv *priv = dev->priv;
 	struct ltq_dma_device *dma_dev = &priv->dma_dev;
+	int err;
 
 #if 0
 	printf("%s: packet %p, len %d\n", __func__, packet, length);
 #endif
 
-	ltq_dma_tx_map(dma_dev, priv->tx_num, packet, length, 10);
-	priv->tx_num = (priv->tx_num + 1) % LTQ_ETH_TX_BUFFER_CNT;
+	err = ltq_dma_tx_ring_send(dma_dev, packet, length, 10);
+	if (err) {
+		puts("NET: timeout on waiting for TX descriptor\n");
+		return -1;
+	}
 
 	return 0;
 }
@@ -348,30 +356,36 @@ static int ltq_eth_recv(struct eth_device *dev)
 	struct ltq_eth_priv *priv = dev->priv;
 	struct ltq_dma_device *dma_dev = &priv->dma_dev;
 	u8 *packet;
-	int len;
+	int len, count;
 
-	if (!ltq_dma_rx_poll(dma_dev, priv->rx_num))
-		return 0;
+	/* Drain all completed descriptors, but stop after one lap */
+	for (count = 0; count < LTQ_ETH_RX_BUFFER_CNT; count++) {
+		if (!ltq_dma_rx_poll(dma_dev, priv->rx_num))
+			break;
 
 #if 0
-	printf("%s: rx_num %d\n", __func__, priv->rx_num);
+		printf("%s: rx_num %d\n", __func__, priv->rx_num);
 #endif
 
-	len = ltq_dma_rx_length(dma_dev, priv->rx_num);
-	packet = ltq_eth_rx_packet_align(priv->rx_num);
+		len = ltq_dma_rx_length(dma_dev, priv->rx_num);
+		packet = ltq_eth_rx_packet_align(priv->rx_num);
 
 #if 0
-	printf("%s: received: packet %p, len %u, rx_num %d\n",
-		__func__, packet, len, priv->rx_num);
+		printf("%s: received: packet %p, len %u, rx_num %d\n",
+			__func__, packet, len, priv->rx_num);
 #endif
 
-	if (len)
-		NetReceive(packet, len);
+		/* ltq_dma_rx_release() counts the others as dropped */
+		if (len > 0 && len <= LTQ_ETH_RX_DATA_SIZE) {
+			ltq_dma_rx_sync(dma_dev, packet, len);
+			NetReceive(packet, len);
+		}
 
-	ltq_dma_rx_map(dma_dev, priv->rx_num, packet,
-		LTQ_ETH_RX_DATA_SIZE);
+		ltq_dma_rx_release(dma_dev, priv->rx_num, packet,
+			LTQ_ETH_RX_DATA_SIZE, len);
 
-	priv->rx_num = (priv->rx_num + 1) % LTQ_ETH_RX_BUFFER_CNT;
+		priv->rx_num = (priv->rx_num + 1) % LTQ_ETH_RX_BUFFER_CNT;
+	}
 
 	return 0;
 }
@@ -674,6 +688,7 @@ int ltq_eth_initialize(const struct ltq_eth_board_config *board_config)
 	bus->priv = priv;
 
 	dma_dev = &priv->dma_dev;
+	dma_dev->name = LTQ_ETH_DRV_NAME;
 	dma_dev->port = 0;
 	dma_dev->rx_chan.chan_no = 0;
 	dma_dev->rx_chan.class = 0;
@@ -693,6 +708,10 @@ int ltq_eth_initialize(const struct ltq_eth_board_config *board_config)
 	if (ret)
 		return -1;
 
+	ret = ltq_dma_tx_ring_init(dma_dev, LTQ_ETH_TX_DATA_SIZE);
+	if (ret)
+		return -1;
+
 	ret = mdio_register(bus);
 	if (ret)
 		return -1;
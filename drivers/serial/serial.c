@@ -70,6 +70,7 @@ static int on_baudrate(const char *name, const char *value, enum env_op op,
 		if ((flags & H_INTERACTIVE) != 0) {
 			printf("## Switch baudrate to %d"
 				" bps and press ENTER ...\n", baudrate);
+			console_flush();
 			udelay(50000);
 		}
 
@@ -78,6 +79,7 @@ static int on_baudrate(const char *name, const char *value, enum env_op op,
 		gd->bd->bi_baudrate = baudrate;
 #endif
 
+		console_flush();
 		serial_setbrg();
 
 		udelay(50000);
@@ -281,6 +283,7 @@ void serial_stdio_init(void)
 		dev.stop = s->stop;
 		dev.putc = s->putc;
 		dev.puts = s->puts;
+		dev.write_nb = s->write_nb;
 		dev.getc = s->getc;
 		dev.tstc = s->tstc;
 
@@ -309,6 +312,8 @@ int serial_assign(const char *name)
 	for (s = serial_devices; s; s = s->next) {
 		if (strcmp(s->name, name))
 			continue;
+		/* Queued output belongs to the previous port */
+		console_flush();
 		serial_current = s;
 		return 0;
 	}
@@ -464,6 +469,33 @@ void serial_puts(const char *s)
 	get_current()->puts(s);
 }
 
+/**
+ * serial_write_nb() - Output characters without waiting for the hardware
+ * @s:		Characters to be output from the serial port.
+ * @len:	Number of characters in @s.
+ *
+ * This function passes up to @len characters to the currently selected
+ * serial port, as many as the hardware can queue for transfer right
+ * now, and returns immediately. It allows the console to buffer output
+ * and to drain it while doing something else. Drivers which do not
+ * implement write_nb() output all characters through their putc() call.
+ *
+ * Returns the number of characters taken by the serial port.
+ */
+int serial_write_nb(const char *s, int len)
+{
+	struct serial_device *dev = get_current();
+	int i;
+
+	if (dev->write_nb)
+		return dev->write_nb(s, len);
+
+	for (i = 0; i < len; i++)
+		dev->putc(s[i]);
+
+	return len;
+}
+
 /**
  * default_serial_puts() - Output string by calling serial_putc() in loop
  * @s:	Zero-terminated string to be output from the serial port.
@@ -228,6 +228,45 @@ static void ltq_serial_putc(const char c)
 	ltq_serial_tx(c);
 }
 
+/*
+ * Fill the TX FIFO with as many characters as it has room for right
+ * now and return how many were taken. A newline needs two entries.
+ */
+static int ltq_serial_write_nb(const char *s, int len)
+{
+	unsigned int txfree = ltq_serial_tx_free();
+	int i;
+
+	for (i = 0; i < len; i++) {
+		if (s[i] == '\n') {
+			if (txfree < 2)
+				break;
+
+			ltq_serial_tx('\r');
+			txfree--;
+		} else if (!txfree)
+			break;
+
+		ltq_serial_tx(s[i]);
+		txfree--;
+	}
+
+	return i;
+}
+
+static void ltq_serial_puts(const char *s)
+{
+	int len = strlen(s);
+	int n;
+
+	/* Read the FIFO state once per burst instead of once per char */
+	while (len) {
+		n = ltq_serial_write_nb(s, len);
+		s += n;
+		len -= n;
+	}
+}
+
 static int ltq_serial_getc(void)
 {
 	while (!ltq_serial_rx_fill())
@@ -247,7 +286,8 @@ static struct serial_device ltq_serial_drv = {
 	.stop	= NULL,
 	.setbrg	= ltq_serial_setbrg,
 	.putc	= ltq_serial_putc,
-	.puts	= default_serial_puts,
+	.puts	= ltq_serial_puts,
+	.write_nb = ltq_serial_write_nb,
 	.getc	= ltq_serial_getc,
 	.tstc	= ltq_serial_tstc,
 };
@@ -12,6 +12,7 @@
 #include <asm/lantiq/io.h>
 #include <asm/lantiq/clk.h>
 #include <asm/lantiq/pm.h>
+#include <asm/lantiq/dma.h>
 #include <asm/arch/soc.h>
 
 #define LTQ_SPI_CLC_RMC_SHIFT		8
@@ -62,6 +63,9 @@
 #define LTQ_SPI_RXREQ_RXCNT_MASK	0xFFFF
 #define LTQ_SPI_RXCNT_TODO_MASK		0xFFFF
 
+#define LTQ_SPI_DMACON_RXON		(1 << 0)
+#define LTQ_SPI_DMACON_TXON		(1 << 1)
+
 #define LTQ_SPI_GPIO_DIN		16
 #define LTQ_SPI_GPIO_DOUT		17
 #define LTQ_SPI_GPIO_CLK		18
@@ -102,6 +106,31 @@ struct ltq_spi_regs {
 	__be32	irncr;		/* Interrupt node control */
 };
 
+#if defined(CONFIG_LTQ_SPI_DMA)
+/* SSC is connected to DMA port 2, channels 10 (RX) and 11 (TX) */
+#ifndef LTQ_SPI_DMA_PORT
+#define LTQ_SPI_DMA_PORT		2
+#define LTQ_SPI_DMA_RX_CHAN		10
+#define LTQ_SPI_DMA_TX_CHAN		11
+#endif
+
+/* Minimum RX length for which DMA setup pays off */
+#ifndef CONFIG_LTQ_SPI_DMA_THRESHOLD
+#define CONFIG_LTQ_SPI_DMA_THRESHOLD	256
+#endif
+
+/*
+ * RXREQ can request at most 0xFFFF bytes. Larger transfers are split
+ * into segments, each one mapped to its own RX descriptor.
+ */
+#define LTQ_SPI_DMA_SEG_SIZE		(32 * 1024)
+#define LTQ_SPI_DMA_NUM_DESC		2
+#define LTQ_SPI_DMA_TIMEOUT		1000
+
+static struct ltq_dma_device ltq_spi_dma_dev;
+static int ltq_spi_dma_ready;
+#endif
+
 struct ltq_spi_drv_data {
 	struct ltq_spi_regs __iomem *regs;
 
@@ -517,6 +546,130 @@ static void rx_request(struct ltq_spi_drv_data *drv)
 	ltq_writel(&drv->regs->rxreq, rxreq);
 }
 
+#if defined(CONFIG_LTQ_SPI_DMA)
+static int ltq_spi_dma_setup(void)
+{
+	struct ltq_dma_device *dma_dev = &ltq_spi_dma_dev;
+	int ret;
+
+	if (ltq_spi_dma_ready)
+		return 0;
+
+	ltq_dma_init();
+
+	dma_dev->name = "ltq-spi";
+	dma_dev->port = LTQ_SPI_DMA_PORT;
+	dma_dev->rx_chan.chan_no = LTQ_SPI_DMA_RX_CHAN;
+	dma_dev->rx_chan.class = 0;
+	dma_dev->rx_chan.num_desc = LTQ_SPI_DMA_NUM_DESC;
+	dma_dev->rx_endian_swap = LTQ_DMA_ENDIANESS_B0_B1_B2_B3;
+	dma_dev->rx_burst_len = LTQ_DMA_BURST_2WORDS;
+	dma_dev->tx_chan.chan_no = LTQ_SPI_DMA_TX_CHAN;
+	dma_dev->tx_chan.class = 0;
+	dma_dev->tx_chan.num_desc = LTQ_SPI_DMA_NUM_DESC;
+	dma_dev->tx_endian_swap = LTQ_DMA_ENDIANESS_B0_B1_B2_B3;
+	dma_dev->tx_burst_len = LTQ_DMA_BURST_2WORDS;
+
+	ret = ltq_dma_register(dma_dev);
+	if (ret)
+		return ret;
+
+	ltq_spi_dma_ready = 1;
+
+	return 0;
+}
+
+static int ltq_spi_dma_capable(struct ltq_spi_drv_data *drv)
+{
+	/*
+	 * Only RX-only transfers to cache line aligned buffers are done
+	 * by DMA. Command phases and short or unaligned transfers are
+	 * handled by PIO.
+	 */
+	if (drv->tx || drv->rx_todo < CONFIG_LTQ_SPI_DMA_THRESHOLD)
+		return 0;
+
+	if ((unsigned long)drv->rx & (ARCH_DMA_MINALIGN - 1))
+		return 0;
+
+	return ltq_spi_dma_setup() == 0;
+}
+
+static unsigned int ltq_spi_dma_map(struct ltq_spi_drv_data *drv,
+					int index, u8 *buf, unsigned int len)
+{
+	unsigned int seg = min(len, (unsigned int)LTQ_SPI_DMA_SEG_SIZE);
+
+	if (seg)
+		ltq_dma_rx_map(&ltq_spi_dma_dev, index, buf, seg);
+
+	return seg;
+}
+
+static int ltq_spi_dma_rx(struct ltq_spi_drv_data *drv)
+{
+	struct ltq_dma_device *dma_dev = &ltq_spi_dma_dev;
+	unsigned int seg[LTQ_SPI_DMA_NUM_DESC];
+	unsigned int len, mapped, index = 0;
+	unsigned long timebase;
+	u8 *buf = drv->rx;
+	int ret = 0;
+
+	/* DMA transfers whole cache lines, the tail is read by PIO */
+	len = drv->rx_todo & ~(ARCH_DMA_MINALIGN - 1);
+
+	seg[0] = ltq_spi_dma_map(drv, 0, buf, len);
+	mapped = seg[0];
+	seg[1] = ltq_spi_dma_map(drv, 1, buf + mapped, len - mapped);
+	mapped += seg[1];
+
+	ltq_setbits(&drv->regs->dmacon, LTQ_SPI_DMACON_RXON);
+	ltq_dma_enable(dma_dev);
+
+	while (seg[index]) {
+		ltq_writel(&drv->regs->rxreq, seg[index]);
+
+		timebase = get_timer(0);
+		while (!ltq_dma_rx_poll(dma_dev, index)) {
+			WATCHDOG_RESET();
+
+			if (get_timer(timebase) >= LTQ_SPI_DMA_TIMEOUT) {
+				debug("SPI: DMA timeout\n");
+				dma_dev->rx_chan.stats.timeouts++;
+				ret = -1;
+				goto out;
+			}
+		}
+
+		drv->rx += seg[index];
+		drv->rx_todo -= seg[index];
+
+		/* Re-arm the completed descriptor with the next segment */
+		seg[index] = ltq_spi_dma_map(drv, index, buf + mapped,
+						len - mapped);
+		mapped += seg[index];
+
+		index = (index + 1) % LTQ_SPI_DMA_NUM_DESC;
+	}
+
+out:
+	ltq_dma_reset(dma_dev);
+	ltq_clrbits(&drv->regs->dmacon, LTQ_SPI_DMACON_RXON);
+
+	return ret;
+}
+#else
+static inline int ltq_spi_dma_capable(struct ltq_spi_drv_data *drv)
+{
+	return 0;
+}
+
+static inline int ltq_spi_dma_rx(struct ltq_spi_drv_data *drv)
+{
+	return -1;
+}
+#endif
+
 void spi_init(void)
 {
 }
@@ -540,6 +693,12 @@ struct spi_slave *spi_setup_slave(unsigned int bus, unsigned int cs,
 	drv->max_hz = max_hz;
 	drv->mode = mode;
 
+	/*
+	 * SSC has a single MTSR/MRST data line pair, so the best a serial
+	 * flash can do on this controller is a fast read with dummy byte.
+	 */
+	drv->slave.op_mode_rx = SPI_OPM_RX_NORM;
+
 	return &drv->slave;
 }
 
@@ -625,6 +784,12 @@ int spi_xfer(struct spi_slave *slave, unsigned int bitlen,
 	if (drv->rx) {
 		drv->rx_todo = bitlen / 8;
 
+		if (ltq_spi_dma_capable(drv)) {
+			ret = ltq_spi_dma_rx(drv);
+			if (ret || !drv->rx_todo)
+				goto done;
+		}
+
 		if (!drv->tx)
 			rx_request(drv);
 	}
@@ -653,7 +818,8 @@ int spi_xfer(struct spi_slave *slave, unsigned int bitlen,
 	}
 
 done:
-	ret = ltq_spi_wait_ready(drv);
+	if (!ret)
+		ret = ltq_spi_wait_ready(drv);
 
 	drv->rx = NULL;
 	drv->tx = NULL;
@@ -103,6 +103,9 @@ struct spi_slave *spi_setup_slave(unsigned int bus, unsigned int cs,
 		return NULL;
 	}
 
+	/* The emulated bus moves whole bytes, so dual output is free */
+	sss->slave.op_mode_rx = SPI_OPM_RX_NORM | SPI_OPM_RX_DOUT;
+
 	return &sss->slave;
 }
 
@@ -1407,14 +1407,78 @@ void ext4fs_allocate_blocks(struct ext2_inode *file_inode,
 
 #endif
 
+/*
+ * Small LRU cache of extent tree blocks. Resolving each extent of a large
+ * file walks the tree from the inode again, so the index blocks near the
+ * root are needed over and over. The cache is dropped in ext4fs_close().
+ */
+#define EXT4_EXTENT_CACHE_ENTRIES	4
+
+static struct ext4_extent_cache {
+	unsigned long long block;	/* 0 if unused */
+	unsigned int lru;
+	char *buf;
+} ext4fs_extent_cache[EXT4_EXTENT_CACHE_ENTRIES];
+static unsigned int ext4fs_extent_cache_tick;
+
+static void ext4fs_extent_cache_free(void)
+{
+	int i;
+
+	for (i = 0; i < EXT4_EXTENT_CACHE_ENTRIES; i++) {
+		free(ext4fs_extent_cache[i].buf);
+		ext4fs_extent_cache[i].buf = NULL;
+		ext4fs_extent_cache[i].block = 0;
+		ext4fs_extent_cache[i].lru = 0;
+	}
+}
+
+static char *ext4fs_read_extent_block(unsigned long long block, int blksz,
+				      int log2_blksz)
+{
+	struct ext4_extent_cache *entry, *victim = ext4fs_extent_cache;
+	int i;
+
+	ext4fs_extent_cache_tick++;
+
+	for (i = 0; i < EXT4_EXTENT_CACHE_ENTRIES; i++) {
+		entry = &ext4fs_extent_cache[i];
+		if (entry->block == block && entry->buf) {
+			entry->lru = ext4fs_extent_cache_tick;
+			return entry->buf;
+		}
+
+		if (entry->lru < victim->lru)
+			victim = entry;
+	}
+
+	if (!victim->buf) {
+		victim->buf = zalloc(blksz);
+		if (!victim->buf)
+			return NULL;
+	}
+
+	if (!ext4fs_devread((lbaint_t)block << log2_blksz, 0, blksz,
+			    victim->buf)) {
+		victim->block = 0;
+		victim->lru = 0;
+		return NULL;
+	}
+
+	victim->block = block;
+	victim->lru = ext4fs_extent_cache_tick;
+
+	return victim->buf;
+}
+
 static struct ext4_extent_header *ext4fs_get_extent_block
-	(struct ext2_data *data, char *buf,
-		struct ext4_extent_header *ext_block,
+	(struct ext2_data *data, struct ext4_extent_header *ext_block,
 		uint32_t fileblock, int log2_blksz)
 {
 	struct ext4_extent_idx *index;
 	unsigned long long block;
 	int blksz = EXT2_BLOCK_SIZE(data);
+	char *buf;
 	int i;
 
 	while (1) {
@@ -1432,20 +1496,91 @@ static struct ext4_extent_header *ext4fs_get_extent_block
 				break;
 		} while (fileblock >= le32_to_cpu(index[i].ei_block));
 
-		if (--i < 0)
-			return 0;
+		/*
+		 * The first index starts at the first extent, so a leading
+		 * hole lies before it. Its leaf maps the hole.
+		 */
+		if (--i < 0) {
+			if (!le16_to_cpu(ext_block->eh_entries))
+				return 0;
+			i = 0;
+		}
 
 		block = le16_to_cpu(index[i].ei_leaf_hi);
 		block = (block << 32) + le32_to_cpu(index[i].ei_leaf_lo);
 
-		if (ext4fs_devread((lbaint_t)block << log2_blksz, 0, blksz,
-				   buf))
-			ext_block = (struct ext4_extent_header *)buf;
-		else
+		buf = ext4fs_read_extent_block(block, blksz, log2_blksz);
+		if (!buf)
 			return 0;
+
+		ext_block = (struct ext4_extent_header *)buf;
 	}
 }
 
+/*
+ * Map 'fileblock' of an extent mapped inode. Fills in the physical block,
+ * or 0 for a hole, and whether the extent is uninitialized. Returns the
+ * number of blocks from 'fileblock' on that are mapped contiguously or
+ * belong to the same hole, or a negative error.
+ */
+long int ext4fs_map_extent(struct ext2_inode *inode, uint32_t fileblock,
+			   long int *blknr, int *uninit)
+{
+	struct ext4_extent_header *ext_block;
+	struct ext4_extent *extent;
+	unsigned long long start;
+	uint32_t first, len;
+	int log2_blksz;
+	int entries, i;
+
+	log2_blksz = LOG2_BLOCK_SIZE(ext4fs_root)
+		- get_fs()->dev_desc->log2blksz;
+
+	ext_block = ext4fs_get_extent_block(ext4fs_root,
+					    (struct ext4_extent_header *)
+					    inode->b.blocks.dir_blocks,
+					    fileblock, log2_blksz);
+	if (!ext_block) {
+		printf("invalid extent block\n");
+		return -EINVAL;
+	}
+
+	extent = (struct ext4_extent *)(ext_block + 1);
+	entries = le16_to_cpu(ext_block->eh_entries);
+
+	for (i = 0; i < entries; i++)
+		if (fileblock < le32_to_cpu(extent[i].ee_block))
+			break;
+
+	*blknr = 0;
+	*uninit = 0;
+
+	/* hole before the first extent of the leaf */
+	if (--i < 0)
+		return entries ? le32_to_cpu(extent[0].ee_block) - fileblock : 1;
+
+	first = le32_to_cpu(extent[i].ee_block);
+	len = le16_to_cpu(extent[i].ee_len);
+	if (len > EXT_INIT_MAX_LEN) {
+		len -= EXT_INIT_MAX_LEN;
+		*uninit = 1;
+	}
+
+	/* hole after the extent */
+	if (fileblock - first >= len) {
+		*uninit = 0;
+		if (i + 1 < entries)
+			return le32_to_cpu(extent[i + 1].ee_block) - fileblock;
+		return 1;
+	}
+
+	start = le16_to_cpu(extent[i].ee_start_hi);
+	start = (start << 32) + le32_to_cpu(extent[i].ee_start_lo);
+	*blknr = start + fileblock - first;
+
+	return len - (fileblock - first);
+}
+
 static int ext4fs_blockgroup
 	(struct ext2_data *data, int group, struct ext2_block_group *blkgrp)
 {
@@ -1508,54 +1643,19 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 	long int rblock;
 	long int perblock_parent;
 	long int perblock_child;
-	unsigned long long start;
 	/* get the blocksize of the filesystem */
 	blksz = EXT2_BLOCK_SIZE(ext4fs_root);
 	log2_blksz = LOG2_BLOCK_SIZE(ext4fs_root)
 		- get_fs()->dev_desc->log2blksz;
 
 	if (le32_to_cpu(inode->flags) & EXT4_EXTENTS_FL) {
-		char *buf = zalloc(blksz);
-		if (!buf)
-			return -ENOMEM;
-		struct ext4_extent_header *ext_block;
-		struct ext4_extent *extent;
-		int i = -1;
-		ext_block =
-			ext4fs_get_extent_block(ext4fs_root, buf,
-						(struct ext4_extent_header *)
-						inode->b.blocks.dir_blocks,
-						fileblock, log2_blksz);
-		if (!ext_block) {
-			printf("invalid extent block\n");
-			free(buf);
-			return -EINVAL;
-		}
+		int uninit;
 
-		extent = (struct ext4_extent *)(ext_block + 1);
+		status = ext4fs_map_extent(inode, fileblock, &blknr, &uninit);
+		if (status < 0)
+			return status;
 
-		do {
-			i++;
-			if (i >= le16_to_cpu(ext_block->eh_entries))
-				break;
-		} while (fileblock >= le32_to_cpu(extent[i].ee_block));
-		if (--i >= 0) {
-			fileblock -= le32_to_cpu(extent[i].ee_block);
-			if (fileblock >= le16_to_cpu(extent[i].ee_len)) {
-				free(buf);
-				return 0;
-			}
-
-			start = le16_to_cpu(extent[i].ee_start_hi);
-			start = (start << 32) +
-					le32_to_cpu(extent[i].ee_start_lo);
-			free(buf);
-			return fileblock + start;
-		}
-
-		printf("Extent Error\n");
-		free(buf);
-		return -1;
+		return blknr;
 	}
 
 	/* Direct blocks. */
@@ -1845,6 +1945,8 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 
 void ext4fs_close(void)
 {
+	ext4fs_extent_cache_free();
+
 	if ((ext4fs_file != NULL) && (ext4fs_root != NULL)) {
 		ext4fs_free_node(ext4fs_file, &ext4fs_root->diropen);
 		ext4fs_file = NULL;
@@ -40,6 +40,51 @@ void ext4fs_free_node(struct ext2fs_node *node, struct ext2fs_node *currroot)
 		free(node);
 }
 
+/*
+ * Read an extent mapped file one extent at a time. Each extent becomes a
+ * single ext4fs_devread() of its full length, holes and uninitialized
+ * extents are zero filled.
+ */
+static int ext4fs_read_extents(struct ext2fs_node *node, int pos,
+			       unsigned int len, char *buf)
+{
+	struct ext_filesystem *fs = get_fs();
+	int log2blksz = fs->dev_desc->log2blksz;
+	int log2_fs_blocksize = LOG2_BLOCK_SIZE(node->data) - log2blksz;
+	int blocksize = (1 << (log2_fs_blocksize + log2blksz));
+	uint32_t fileblock = pos / blocksize;
+	int skipfirst = pos % blocksize;
+	unsigned long long bytes;
+	long int blknr, count;
+	int uninit;
+
+	while (len) {
+		count = ext4fs_map_extent(&node->inode, fileblock, &blknr,
+					  &uninit);
+		if (count < 0)
+			return -1;
+
+		bytes = (unsigned long long)count * blocksize - skipfirst;
+		if (bytes > len)
+			bytes = len;
+
+		if (blknr && !uninit) {
+			if (!ext4fs_devread((lbaint_t)blknr << log2_fs_blocksize,
+					    skipfirst, bytes, buf))
+				return -1;
+		} else {
+			memset(buf, 0, bytes);
+		}
+
+		buf += bytes;
+		len -= bytes;
+		fileblock += count;
+		skipfirst = 0;
+	}
+
+	return 0;
+}
+
 /*
  * Taken from openmoko-kernel mailing list: By Andy green
  * Optimized read file API : collects and defers contiguous sector
@@ -67,6 +112,12 @@ int ext4fs_read_file(struct ext2fs_node *node, int pos,
 	if (len > filesize)
 		len = filesize;
 
+	if (le32_to_cpu(node->inode.flags) & EXT4_EXTENTS_FL) {
+		if (ext4fs_read_extents(node, pos, len, buf))
+			return -1;
+		return len;
+	}
+
 	blockcnt = ((len + pos) + blocksize - 1) / blocksize;
 
 	for (i = pos / blocksize; i < blockcnt; i++) {
@@ -25,6 +25,12 @@ static const int vfat_enabled = 1;
 static const int vfat_enabled = 0;
 #endif
 
+#if defined(CONFIG_FAT_CACHE) && !defined(CONFIG_SPL_BUILD)
+static const int fat_cache_enabled = 1;
+#else
+static const int fat_cache_enabled = 0;
+#endif
+
 /*
  * Convert a string to lowercase.
  */
@@ -52,6 +58,229 @@ static int disk_read(__u32 block, __u32 nr_blocks, void *buf)
 			cur_part_info.start + block, nr_blocks, buf);
 }
 
+/*
+ * Mounted volume cache
+ *
+ * With CONFIG_FAT_CACHE the parsed boot sector, an LRU cache of FAT
+ * windows and the directory entries of recently opened files are kept
+ * across commands. The mount is dropped when another device or partition
+ * is selected, when the start of the boot sector changes (a different
+ * medium has a different volume ID) and after a write. Writes that bypass
+ * the file system (mmc write, ums, DFU, ...) and re-initialising the
+ * device are caught by the generation number of the block device.
+ */
+#define FAT_MOUNT_SIG_SIZE	(sizeof(boot_sector) + sizeof(volume_info))
+#define FAT_DCACHE_ENTRIES	16
+#define FAT_DCACHE_NAMELEN	128
+
+struct fat_cache_buf {
+	__u32	bufnum;		/* FAT window held, -1 if unused */
+	__u32	lru;		/* Time of last use */
+	__u8	*data;
+};
+
+struct fat_dcache_ent {
+	char		path[FAT_DCACHE_NAMELEN];
+	dir_entry	dent;
+};
+
+static struct fat_mount {
+	int			valid;
+	block_dev_desc_t	*dev;
+	unsigned long		dev_gen;
+	lbaint_t		part_start;
+	lbaint_t		part_size;
+	__u8			sig[FAT_MOUNT_SIG_SIZE];
+	fsdata			geom;
+	__u32			root_cluster;
+	int			rootdir_size;
+
+	struct fat_cache_buf	*fatbufs;
+	int			nfatbufs;
+	__u32			tick;
+
+	struct fat_dcache_ent	*dcache;
+	int			dcache_next;
+
+	unsigned long		fat_hits, fat_misses;
+	unsigned long		dir_hits, dir_misses;
+} fat_mnt;
+
+static void fat_cache_invalidate(void)
+{
+	if (fat_mnt.fatbufs)
+		free(fat_mnt.fatbufs[0].data);
+	free(fat_mnt.fatbufs);
+	free(fat_mnt.dcache);
+
+	fat_mnt.valid = 0;
+	fat_mnt.fatbufs = NULL;
+	fat_mnt.nfatbufs = 0;
+	fat_mnt.dcache = NULL;
+}
+
+static int fat_cache_mounted(void)
+{
+	return fat_cache_enabled && fat_mnt.valid && fat_mnt.dev == cur_dev &&
+	       fat_mnt.dev_gen == cur_dev->gen;
+}
+
+/* Called with the boot sector each time a device is selected */
+static void fat_cache_check(block_dev_desc_t *dev_desc,
+			    disk_partition_t *info, const __u8 *bootsect)
+{
+	if (!fat_cache_enabled)
+		return;
+
+	if (fat_mnt.valid && (fat_mnt.dev != dev_desc ||
+			      fat_mnt.dev_gen != dev_desc->gen ||
+			      fat_mnt.part_start != info->start ||
+			      fat_mnt.part_size != info->size ||
+			      memcmp(fat_mnt.sig, bootsect, FAT_MOUNT_SIG_SIZE))) {
+		debug("FAT: device changed, dropping cache\n");
+		fat_cache_invalidate();
+	}
+
+	if (!fat_mnt.valid) {
+		fat_mnt.dev = dev_desc;
+		fat_mnt.dev_gen = dev_desc->gen;
+		fat_mnt.part_start = info->start;
+		fat_mnt.part_size = info->size;
+		memcpy(fat_mnt.sig, bootsect, FAT_MOUNT_SIG_SIZE);
+	}
+}
+
+/*
+ * Remember the geometry of the current volume and set up the FAT and
+ * directory caches. The number of cached FAT sectors is taken from the
+ * "fatcache" environment variable, 0 disables the cache.
+ */
+static void fat_cache_mount(fsdata *mydata, __u32 root_cluster,
+			    int rootdir_size)
+{
+	ulong sectors, nbufs, i;
+	__u8 *data;
+
+	fat_cache_invalidate();
+
+	sectors = getenv_ulong("fatcache", 10, CONFIG_FAT_CACHE_SECTORS);
+	if (!sectors)
+		return;
+
+	nbufs = DIV_ROUND_UP(sectors, FATBUFBLOCKS);
+	nbufs = min(nbufs, (ulong)DIV_ROUND_UP(mydata->fatlength,
+					       FATBUFBLOCKS));
+
+	fat_mnt.fatbufs = calloc(nbufs, sizeof(*fat_mnt.fatbufs));
+	fat_mnt.dcache = calloc(FAT_DCACHE_ENTRIES, sizeof(*fat_mnt.dcache));
+	data = memalign(ARCH_DMA_MINALIGN, nbufs * FATBUFSIZE);
+	if (!fat_mnt.fatbufs || !fat_mnt.dcache || !data) {
+		debug("FAT: no memory for %lu cache buffers\n", nbufs);
+		free(data);
+		fat_cache_invalidate();
+		return;
+	}
+
+	for (i = 0; i < nbufs; i++) {
+		fat_mnt.fatbufs[i].bufnum = -1;
+		fat_mnt.fatbufs[i].data = data + i * FATBUFSIZE;
+	}
+
+	fat_mnt.nfatbufs = nbufs;
+	fat_mnt.dev_gen = cur_dev->gen;
+	fat_mnt.geom = *mydata;
+	fat_mnt.root_cluster = root_cluster;
+	fat_mnt.rootdir_size = rootdir_size;
+	fat_mnt.dcache_next = 0;
+	fat_mnt.tick = 0;
+	fat_mnt.fat_hits = fat_mnt.fat_misses = 0;
+	fat_mnt.dir_hits = fat_mnt.dir_misses = 0;
+	fat_mnt.valid = 1;
+}
+
+/*
+ * Read FAT window 'bufnum' of FATBUFBLOCKS sectors into 'buf'.
+ * Return 0 on success, -1 otherwise.
+ */
+static int fat_read_fatbuf(fsdata *mydata, __u32 bufnum, __u8 *buf)
+{
+	__u32 getsize = FATBUFBLOCKS;
+	__u32 fatlength = mydata->fatlength;
+	__u32 startblock = bufnum * FATBUFBLOCKS;
+
+	if (startblock + getsize > fatlength)
+		getsize = fatlength - startblock;
+
+	startblock += mydata->fat_sect;	/* Offset from start of disk */
+
+	if (disk_read(startblock, getsize, buf) < 0) {
+		debug("Error reading FAT blocks\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Look up a FAT window in the cache, replacing the least recently used */
+static __u8 *fat_cache_get_fatbuf(fsdata *mydata, __u32 bufnum)
+{
+	struct fat_cache_buf *buf, *victim = fat_mnt.fatbufs;
+	int i;
+
+	fat_mnt.tick++;
+
+	for (i = 0; i < fat_mnt.nfatbufs; i++) {
+		buf = &fat_mnt.fatbufs[i];
+		if (buf->bufnum == bufnum) {
+			buf->lru = fat_mnt.tick;
+			fat_mnt.fat_hits++;
+			return buf->data;
+		}
+
+		if (buf->lru < victim->lru)
+			victim = buf;
+	}
+
+	fat_mnt.fat_misses++;
+
+	if (fat_read_fatbuf(mydata, bufnum, victim->data)) {
+		victim->bufnum = -1;
+		victim->lru = 0;
+		return NULL;
+	}
+
+	victim->bufnum = bufnum;
+	victim->lru = fat_mnt.tick;
+
+	return victim->data;
+}
+
+static int fat_dcache_lookup(const char *path, dir_entry *dent)
+{
+	int i;
+
+	for (i = 0; i < FAT_DCACHE_ENTRIES; i++) {
+		if (!strcmp(fat_mnt.dcache[i].path, path)) {
+			*dent = fat_mnt.dcache[i].dent;
+			fat_mnt.dir_hits++;
+			return 1;
+		}
+	}
+
+	fat_mnt.dir_misses++;
+
+	return 0;
+}
+
+static void fat_dcache_insert(const char *path, const dir_entry *dent)
+{
+	struct fat_dcache_ent *ent = &fat_mnt.dcache[fat_mnt.dcache_next];
+
+	strcpy(ent->path, path);
+	ent->dent = *dent;
+	fat_mnt.dcache_next = (fat_mnt.dcache_next + 1) % FAT_DCACHE_ENTRIES;
+}
+
 int fat_set_blk_dev(block_dev_desc_t *dev_desc, disk_partition_t *info)
 {
 	ALLOC_CACHE_ALIGN_BUFFER(unsigned char, buffer, dev_desc->blksz);
@@ -72,10 +301,11 @@ int fat_set_blk_dev(block_dev_desc_t *dev_desc, disk_partition_t *info)
 	}
 
 	/* Check for FAT12/FAT16/FAT32 filesystem */
-	if (!memcmp(buffer + DOS_FS_TYPE_OFFSET, "FAT", 3))
-		return 0;
-	if (!memcmp(buffer + DOS_FS32_TYPE_OFFSET, "FAT32", 5))
+	if (!memcmp(buffer + DOS_FS_TYPE_OFFSET, "FAT", 3) ||
+	    !memcmp(buffer + DOS_FS32_TYPE_OFFSET, "FAT32", 5)) {
+		fat_cache_check(dev_desc, info, buffer);
 		return 0;
+	}
 
 	cur_dev = NULL;
 	return -1;
@@ -189,18 +419,13 @@ static __u32 get_fatent(fsdata *mydata, __u32 entry)
 
 	/* Read a new block of FAT entries into the cache. */
 	if (bufnum != mydata->fatbufnum) {
-		__u32 getsize = FATBUFBLOCKS;
-		__u8 *bufptr = mydata->fatbuf;
-		__u32 fatlength = mydata->fatlength;
-		__u32 startblock = bufnum * FATBUFBLOCKS;
-
-		if (startblock + getsize > fatlength)
-			getsize = fatlength - startblock;
+		if (fat_cache_enabled && fat_mnt.fatbufs) {
+			__u8 *bufptr = fat_cache_get_fatbuf(mydata, bufnum);
 
-		startblock += mydata->fat_sect;	/* Offset from start of disk */
-
-		if (disk_read(startblock, getsize, bufptr) < 0) {
-			debug("Error reading FAT blocks\n");
+			if (!bufptr)
+				return ret;
+			mydata->fatbuf = bufptr;
+		} else if (fat_read_fatbuf(mydata, bufnum, mydata->fatbuf)) {
 			return ret;
 		}
 		mydata->fatbufnum = bufnum;
@@ -803,37 +1028,26 @@ exit:
 	return ret;
 }
 
-__u8 do_fat_read_at_block[MAX_CLUSTSIZE]
-	__aligned(ARCH_DMA_MINALIGN);
-
-long
-do_fat_read_at(const char *filename, unsigned long pos, void *buffer,
-	       unsigned long maxsize, int dols)
+/*
+ * Read the boot sector and set up the volume geometry in 'mydata'.
+ * Return 0 on success, -1 otherwise.
+ */
+static int fat_read_geometry(fsdata *mydata, __u32 *root_cluster,
+			     int *rootdir_size)
 {
-	char fnamecopy[2048];
 	boot_sector bs;
 	volume_info volinfo;
-	fsdata datablock;
-	fsdata *mydata = &datablock;
-	dir_entry *dentptr = NULL;
-	__u16 prevcksum = 0xffff;
-	char *subname = "";
-	__u32 cursect;
-	int idx, isdir = 0;
-	int files = 0, dirs = 0;
-	long ret = -1;
-	int firsttime;
-	__u32 root_cluster = 0;
-	int rootdir_size = 0;
-	int j;
 
 	if (read_bootsectandvi(&bs, &volinfo, &mydata->fatsize)) {
 		debug("Error: reading boot sector\n");
 		return -1;
 	}
 
+	*root_cluster = 0;
+	*rootdir_size = 0;
+
 	if (mydata->fatsize == 32) {
-		root_cluster = bs.root_cluster;
+		*root_cluster = bs.root_cluster;
 		mydata->fatlength = bs.fat32_length;
 	} else {
 		mydata->fatlength = bs.fat_length;
@@ -841,8 +1055,7 @@ do_fat_read_at(const char *filename, unsigned long pos, void *buffer,
 
 	mydata->fat_sect = bs.reserved;
 
-	cursect = mydata->rootdir_sect
-		= mydata->fat_sect + mydata->fatlength * bs.fats;
+	mydata->rootdir_sect = mydata->fat_sect + mydata->fatlength * bs.fats;
 
 	mydata->sect_size = (bs.sector_size[1] << 8) + bs.sector_size[0];
 	mydata->clust_size = bs.cluster_size;
@@ -856,20 +1069,68 @@ do_fat_read_at(const char *filename, unsigned long pos, void *buffer,
 		mydata->data_begin = mydata->rootdir_sect -
 					(mydata->clust_size * 2);
 	} else {
-		rootdir_size = ((bs.dir_entries[1]  * (int)256 +
+		*rootdir_size = ((bs.dir_entries[1]  * (int)256 +
 				 bs.dir_entries[0]) *
 				 sizeof(dir_entry)) /
 				 mydata->sect_size;
 		mydata->data_begin = mydata->rootdir_sect +
-					rootdir_size -
+					*rootdir_size -
 					(mydata->clust_size * 2);
 	}
 
+	return 0;
+}
+
+__u8 do_fat_read_at_block[MAX_CLUSTSIZE]
+	__aligned(ARCH_DMA_MINALIGN);
+
+long
+do_fat_read_at(const char *filename, unsigned long pos, void *buffer,
+	       unsigned long maxsize, int dols)
+{
+	char fnamecopy[2048];
+	char dkey[FAT_DCACHE_NAMELEN];
+	fsdata datablock;
+	fsdata *mydata = &datablock;
+	dir_entry *dentptr = NULL;
+	dir_entry dcache_dent;
+	__u16 prevcksum = 0xffff;
+	char *subname = "";
+	__u32 cursect;
+	int idx, isdir = 0;
+	int files = 0, dirs = 0;
+	long ret = -1;
+	int firsttime;
+	__u32 root_cluster = 0;
+	int rootdir_size = 0;
+	int cached = 0;
+	int j;
+
+	if (fat_cache_mounted()) {
+		*mydata = fat_mnt.geom;
+		root_cluster = fat_mnt.root_cluster;
+		rootdir_size = fat_mnt.rootdir_size;
+	} else {
+		if (fat_read_geometry(mydata, &root_cluster, &rootdir_size))
+			return -1;
+
+		if (fat_cache_enabled)
+			fat_cache_mount(mydata, root_cluster, rootdir_size);
+	}
+
+	cursect = mydata->rootdir_sect;
+
 	mydata->fatbufnum = -1;
-	mydata->fatbuf = memalign(ARCH_DMA_MINALIGN, FATBUFSIZE);
-	if (mydata->fatbuf == NULL) {
-		debug("Error: allocating memory\n");
-		return -1;
+	if (fat_cache_enabled && fat_mnt.fatbufs) {
+		/* get_fatent() points fatbuf into the cache */
+		mydata->fatbuf = NULL;
+		cached = 1;
+	} else {
+		mydata->fatbuf = memalign(ARCH_DMA_MINALIGN, FATBUFSIZE);
+		if (mydata->fatbuf == NULL) {
+			debug("Error: allocating memory\n");
+			return -1;
+		}
 	}
 
 	if (vfat_enabled)
@@ -893,6 +1154,16 @@ do_fat_read_at(const char *filename, unsigned long pos, void *buffer,
 	strcpy(fnamecopy, filename);
 	downcase(fnamecopy);
 
+	/* Files opened before need no directory lookup */
+	dkey[0] = '\0';
+	if (cached && !dols && strlen(fnamecopy) < FAT_DCACHE_NAMELEN) {
+		strcpy(dkey, fnamecopy);
+		if (fat_dcache_lookup(dkey, &dcache_dent)) {
+			dentptr = &dcache_dent;
+			goto found;
+		}
+	}
+
 	if (*fnamecopy == '\0') {
 		if (!dols)
 			goto exit;
@@ -1152,11 +1423,16 @@ rootdir_done:
 			subname = nextname;
 	}
 
+	if (dkey[0])
+		fat_dcache_insert(dkey, dentptr);
+
+found:
 	ret = get_contents(mydata, dentptr, pos, buffer, maxsize);
 	debug("Size: %d, got: %ld\n", FAT2CPU32(dentptr->size), ret);
 
 exit:
-	free(mydata->fatbuf);
+	if (!cached)
+		free(mydata->fatbuf);
 	return ret;
 }
 
@@ -1225,6 +1501,12 @@ int file_fat_detectfs(void)
 
 	printf("Filesystem: %s \"%s\"\n", volinfo.fs_type, vol_label);
 
+	if (fat_cache_mounted())
+		printf("Cache:      %d FAT sectors, FAT %lu/%lu hits, "
+		       "dir %lu/%lu hits\n", fat_mnt.nfatbufs * FATBUFBLOCKS,
+		       fat_mnt.fat_hits, fat_mnt.fat_hits + fat_mnt.fat_misses,
+		       fat_mnt.dir_hits, fat_mnt.dir_hits + fat_mnt.dir_misses);
+
 	return 0;
 }
 
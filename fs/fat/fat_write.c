@@ -1075,5 +1075,10 @@ exit:
 int file_fat_write(const char *filename, void *buffer, unsigned long maxsize)
 {
 	printf("writing %s\n", filename);
+
+	/* The FAT and directories change, drop the mount cache */
+	if (fat_cache_enabled)
+		fat_cache_invalidate();
+
 	return do_fat_write(filename, buffer, maxsize);
 }
@@ -10,6 +10,10 @@
 
 #include "jffs2_nand_private.h"
 
+#ifdef CONFIG_SYS_JFFS2_SORT_FRAGMENTS
+#error "CONFIG_JFFS2_NAND_1PASS does not support CONFIG_SYS_JFFS2_SORT_FRAGMENTS"
+#endif
+
 #define	NODE_CHUNK	1024	/* size of memory allocation chunk in b_nodes */
 
 /* Debugging switches */
@@ -144,7 +148,6 @@ insert_inode(struct b_list *list, struct jffs2_raw_inode *node, u32 offset)
 	new->offset = offset;
 	new->version = node->version;
 	new->ino = node->ino;
-	new->isize = node->isize;
 	new->csize = node->csize;
 
 	return insert_node(list, (struct b_node *)new);
@@ -232,8 +235,8 @@ static int compare_dirents(struct b_node *new, struct b_node *old)
 }
 #endif
 
-static u32
-jffs_init_1pass_list(struct part_info *part)
+void
+jffs2_free_cache(struct part_info *part)
 {
 	struct b_lists *pL;
 
@@ -242,7 +245,17 @@ jffs_init_1pass_list(struct part_info *part)
 		free_nodes(&pL->frag);
 		free_nodes(&pL->dir);
 		free(pL);
+		part->jffs2_priv = NULL;
 	}
+}
+
+static u32
+jffs_init_1pass_list(struct part_info *part)
+{
+	struct b_lists *pL;
+
+	jffs2_free_cache(part);
+
 	if (NULL != (part->jffs2_priv = malloc(sizeof(struct b_lists)))) {
 		pL = (struct b_lists *)part->jffs2_priv;
 
@@ -260,51 +273,48 @@ static long
 jffs2_1pass_read_inode(struct b_lists *pL, u32 ino, char *dest,
 		       struct stat *stat)
 {
-	struct b_inode *jNode;
+	struct b_inode *jNode, *latest = NULL;
+	struct jffs2_raw_inode ojNode;
 	u32 totalSize = 0;
 	u32 latestVersion = 0;
-	long ret;
+	size_t len;
 
-#ifdef CONFIG_SYS_JFFS2_SORT_FRAGMENTS
 	/* Find file size before loading any data, so fragments that
 	 * start past the end of file can be ignored. A fragment
 	 * that is partially in the file is loaded, so extra data may
 	 * be loaded up to the next 4K boundary above the file size.
 	 * This shouldn't cause trouble when loading kernel images, so
 	 * we will live with it.
+	 *
+	 * Nodes added from erase block summaries carry no file size,
+	 * so it is read from the header of the newest node.
 	 */
 	for (jNode = (struct b_inode *)pL->frag.listHead; jNode; jNode = jNode->next) {
-		if ((ino == jNode->ino)) {
-			/* get actual file length from the newest node */
-			if (jNode->version >= latestVersion) {
-				totalSize = jNode->isize;
-				latestVersion = jNode->version;
-			}
+		if (ino == jNode->ino && jNode->version >= latestVersion) {
+			latest = jNode;
+			latestVersion = jNode->version;
 		}
 	}
-#endif
+	if (latest) {
+		len = sizeof(ojNode);
+		if (nand_read(nand, latest->offset, &len, (u_char *)&ojNode))
+			return -1;
+		totalSize = ojNode.isize;
+	}
 
 	for (jNode = (struct b_inode *)pL->frag.listHead; jNode; jNode = jNode->next) {
 		if ((ino != jNode->ino))
 			continue;
-#ifndef CONFIG_SYS_JFFS2_SORT_FRAGMENTS
-		/* get actual file length from the newest node */
-		if (jNode->version >= latestVersion) {
-			totalSize = jNode->isize;
-			latestVersion = jNode->version;
-		}
-#endif
 		if (dest || stat) {
-			char *src, *dst;
+			u_char *src, *dst;
 			char data[4096 + sizeof(struct jffs2_raw_inode)];
 			struct jffs2_raw_inode *inode;
-			size_t len;
 
 			inode = (struct jffs2_raw_inode *)&data;
 			len = sizeof(struct jffs2_raw_inode);
 			if (dest)
 				len += jNode->csize;
-			nand_read(nand, jNode->offset, &len, inode);
+			nand_read(nand, jNode->offset, &len, (u_char *)inode);
 			/* ignore data behind latest known EOF */
 			if (inode->offset > totalSize)
 				continue;
@@ -319,33 +329,29 @@ jffs2_1pass_read_inode(struct b_lists *pL, u32 ino, char *dest,
 			if (!dest)
 				continue;
 
-			src = ((char *) inode) + sizeof(struct jffs2_raw_inode);
-			dst = (char *) (dest + inode->offset);
+			src = ((u_char *) inode) + sizeof(struct jffs2_raw_inode);
+			dst = (u_char *) (dest + inode->offset);
 
 			switch (inode->compr) {
 			case JFFS2_COMPR_NONE:
-				ret = 0;
 				memcpy(dst, src, inode->dsize);
 				break;
 			case JFFS2_COMPR_ZERO:
-				ret = 0;
 				memset(dst, 0, inode->dsize);
 				break;
 			case JFFS2_COMPR_RTIME:
-				ret = 0;
 				rtime_decompress(src, dst, inode->csize, inode->dsize);
 				break;
 			case JFFS2_COMPR_DYNRUBIN:
 				/* this is slow but it works */
-				ret = 0;
 				dynrubin_decompress(src, dst, inode->csize, inode->dsize);
 				break;
 			case JFFS2_COMPR_ZLIB:
-				ret = zlib_decompress(src, dst, inode->csize, inode->dsize);
+				zlib_decompress(src, dst, inode->csize, inode->dsize);
 				break;
 #if defined(CONFIG_JFFS2_LZO)
 			case JFFS2_COMPR_LZO:
-				ret = lzo_decompress(src, dst, inode->csize, inode->dsize);
+				lzo_decompress(src, dst, inode->csize, inode->dsize);
 				break;
 #endif
 			default:
@@ -365,7 +371,7 @@ jffs2_1pass_find_inode(struct b_lists * pL, const char *name, u32 pino)
 {
 	struct b_dirent *jDir;
 	int len = strlen(name);	/* name is assumed slash free */
-	unsigned int nhash = full_name_hash(name, len);
+	unsigned int nhash = full_name_hash((const unsigned char *)name, len);
 	u32 version = 0;
 	u32 inode = 0;
 
@@ -428,7 +434,7 @@ static inline void dump_stat(struct stat *st, const char *name)
 	if (st->st_mtime == (time_t)(-1)) /* some ctimes really hate -1 */
 		st->st_mtime = 1;
 
-	ctime_r(&st->st_mtime, s/*,64*/); /* newlib ctime doesn't have buflen */
+	ctime_r((time_t *)&st->st_mtime, s/*,64*/); /* newlib ctime doesn't have buflen */
 
 	if ((p = strchr(s,'\n')) != NULL) *p = '\0';
 	if ((p = strchr(s,'\r')) != NULL) *p = '\0';
@@ -451,7 +457,7 @@ dump_inode(struct b_lists *pL, struct b_dirent *d, struct b_inode *i)
 	if(!d || !i) return -1;
 	len = d->nsize;
 	nand_read(nand, d->offset + sizeof(struct jffs2_raw_dirent),
-		  &len, &fname);
+		  &len, (u_char *)fname);
 	fname[d->nsize] = '\0';
 
 	memset(&st, 0, sizeof(st));
@@ -592,7 +598,8 @@ jffs2_1pass_resolve_inode(struct b_lists * pL, u32 ino)
 	for (jNode = (struct b_inode *)pL->frag.listHead; jNode; jNode = jNode->next) {
 		if (jNode->ino == jDirFoundIno) {
 			size_t len = jNode->csize;
-			nand_read(nand, jNode->offset + sizeof(struct jffs2_raw_inode), &len, &tmp);
+			nand_read(nand, jNode->offset + sizeof(struct jffs2_raw_inode),
+				  &len, (u_char *)tmp);
 			tmp[jNode->csize] = '\0';
 			break;
 		}
@@ -655,13 +662,19 @@ jffs2_1pass_search_list_inodes(struct b_lists * pL, const char *fname, u32 pino)
 
 }
 
+/*
+ * The node lists are kept across commands and only rebuilt when another
+ * partition is used, or when the first directory entry is no longer found
+ * on flash, i.e. the partition has been rewritten in between. Checking
+ * all of them like the NOR code does would cost a page read each.
+ */
 unsigned char
 jffs2_1pass_rescan_needed(struct part_info *part)
 {
-	struct b_node *b;
+	struct b_dirent *b;
 	struct jffs2_unknown_node onode;
-	struct jffs2_unknown_node *node;
 	struct b_lists *pL = (struct b_lists *)part->jffs2_priv;
+	size_t len;
 
 	if (part->jffs2_priv == 0){
 		DEBUGF ("rescan: First time in use\n");
@@ -674,26 +687,24 @@ jffs2_1pass_rescan_needed(struct part_info *part)
 	}
 
 	/* or if we are scanning a new partition */
-	if (pL->partOffset != part->offset) {
+	if (pL->partNand != nand_info + part->dev->id->num ||
+	    pL->partOffset != part->offset || pL->partSize != part->size) {
 		DEBUGF ("rescan: different partition\n");
 		return 1;
 	}
 
-	/* FIXME */
-#if 0
 	/* but suppose someone reflashed a partition at the same offset... */
-	b = pL->dir.listHead;
-	while (b) {
-		node = (struct jffs2_unknown_node *) get_fl_mem(b->offset,
-			sizeof(onode), &onode);
-		if (node->nodetype != JFFS2_NODETYPE_DIRENT) {
+	b = (struct b_dirent *)pL->dir.listHead;
+	if (b) {
+		len = sizeof(onode);
+		if (nand_read(pL->partNand, b->offset, &len, (u_char *)&onode) ||
+		    onode.magic != JFFS2_MAGIC_BITMASK ||
+		    onode.nodetype != JFFS2_NODETYPE_DIRENT) {
 			DEBUGF ("rescan: fs changed beneath me? (%lx)\n",
 					(unsigned long) b->offset);
 			return 1;
 		}
-		b = b->next;
 	}
-#endif
 	return 0;
 }
 
@@ -764,7 +775,7 @@ jffs2_fill_scan_buf(nand_info_t *nand, unsigned char *buf,
 		    unsigned ofs, unsigned len)
 {
 	int ret;
-	unsigned olen;
+	size_t olen;
 
 	olen = len;
 	ret = nand_read(nand, ofs, &olen, buf);
@@ -773,12 +784,145 @@ jffs2_fill_scan_buf(nand_info_t *nand, unsigned char *buf,
 		return ret;
 	}
 	if (olen < len) {
-		printf("Read at 0x%x gave only 0x%x bytes\n", ofs, olen);
+		printf("Read at 0x%x gave only 0x%zx bytes\n", ofs, olen);
 		return -1;
 	}
 	return 0;
 }
 
+#ifdef CONFIG_JFFS2_SUMMARY
+#include "summary.h"
+
+/*
+ * Add the nodes listed in an erase block summary. The summary is walked
+ * twice, the first pass only checks that all entries are understood, so
+ * that nothing is added when the block has to be scanned after all.
+ */
+static int
+jffs2_sum_process_sum_data(struct b_lists *pL, u32 offset,
+			   struct jffs2_raw_summary *summary, u32 sumlen)
+{
+	struct jffs2_sum_inode_flash *spi;
+	struct jffs2_sum_dirent_flash *spd;
+	struct b_inode *inode;
+	struct b_dirent *dirent;
+	void *sp, *end = (void *)summary + sumlen - sizeof(struct jffs2_sum_marker);
+	int i, pass;
+
+	for (pass = 0; pass < 2; pass++) {
+		sp = summary->sum;
+
+		for (i = 0; i < summary->sum_num; i++) {
+			/* Entries are packed, so access them through packed types */
+			spi = sp;
+			spd = sp;
+			if (sp + sizeof(spi->nodetype) > end)
+				return 0;
+
+			switch (spi->nodetype) {
+			case JFFS2_NODETYPE_INODE:
+				if (sp + JFFS2_SUMMARY_INODE_SIZE > end)
+					return 0;
+				if (pass) {
+					inode = (struct b_inode *)add_node(&pL->frag,
+							sizeof(struct b_inode));
+					if (!inode)
+						return -1;
+					inode->offset = offset + spi->offset;
+					inode->version = spi->version;
+					inode->ino = spi->inode;
+					inode->csize = spi->totlen -
+						sizeof(struct jffs2_raw_inode);
+					insert_node(&pL->frag, (struct b_node *)inode);
+				}
+				sp += JFFS2_SUMMARY_INODE_SIZE;
+				break;
+
+			case JFFS2_NODETYPE_DIRENT:
+				if (sp + JFFS2_SUMMARY_DIRENT_SIZE(0) > end ||
+				    sp + JFFS2_SUMMARY_DIRENT_SIZE(spd->nsize) > end)
+					return 0;
+				if (pass) {
+					dirent = (struct b_dirent *)add_node(&pL->dir,
+							sizeof(struct b_dirent));
+					if (!dirent)
+						return -1;
+					dirent->offset = offset + spd->offset;
+					dirent->version = spd->version;
+					dirent->pino = spd->pino;
+					dirent->ino = spd->ino;
+					dirent->nhash = full_name_hash(spd->name,
+								       spd->nsize);
+					dirent->nsize = spd->nsize;
+					dirent->type = spd->type;
+					insert_node(&pL->dir, (struct b_node *)dirent);
+				}
+				sp += JFFS2_SUMMARY_DIRENT_SIZE(spd->nsize);
+				break;
+
+			default:
+				DEBUGF("summary: unknown node type %x at 0x%x\n",
+				       spi->nodetype, offset);
+				return 0;
+			}
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Look for a summary at the end of the erase block at 'offset', which has
+ * been read into the end of 'buf' as far as 'buflen'. Returns 1 if the
+ * block has been added from its summary, 0 if it has to be scanned and a
+ * negative value on errors.
+ */
+static int
+jffs2_sum_scan_sumnode(struct b_lists *pL, unsigned char *buf,
+		       unsigned sectorsize, unsigned buflen, u32 offset)
+{
+	struct jffs2_sum_marker *sm;
+	struct jffs2_raw_summary *summary;
+	struct jffs2_unknown_node crcnode;
+	u32 sumlen;
+
+	sm = (struct jffs2_sum_marker *)(buf + sectorsize - sizeof(*sm));
+	if (sm->magic != JFFS2_SUM_MAGIC || sm->offset >= sectorsize)
+		return 0;
+
+	sumlen = sectorsize - sm->offset;
+	if (sumlen < JFFS2_SUMMARY_FRAME_SIZE)
+		return 0;
+
+	/* Read the part of the summary which is not in the buffer yet */
+	if (sumlen > buflen &&
+	    jffs2_fill_scan_buf(nand, buf + sm->offset, offset + sm->offset,
+				sumlen - buflen))
+		return -1;
+
+	summary = (struct jffs2_raw_summary *)(buf + sm->offset);
+
+	crcnode.magic = JFFS2_MAGIC_BITMASK;
+	crcnode.nodetype = JFFS2_NODETYPE_SUMMARY;
+	crcnode.totlen = summary->totlen;
+	if (summary->magic != JFFS2_MAGIC_BITMASK ||
+	    summary->nodetype != JFFS2_NODETYPE_SUMMARY ||
+	    summary->hdr_crc != crc32_no_comp(0, (unsigned char *)&crcnode,
+					      sizeof(crcnode) - 4) ||
+	    summary->totlen != sumlen ||
+	    summary->node_crc != crc32_no_comp(0, (unsigned char *)summary,
+				sizeof(struct jffs2_raw_summary) - 8) ||
+	    summary->sum_crc != crc32_no_comp(0, (unsigned char *)summary->sum,
+				sumlen - sizeof(struct jffs2_raw_summary))) {
+		printf("Summary node crc error at 0x%x, scanning block\n",
+		       offset);
+		return 0;
+	}
+
+	return jffs2_sum_process_sum_data(pL, offset, summary, sumlen);
+}
+#endif /* CONFIG_JFFS2_SUMMARY */
+
 #define	EMPTY_SCAN_SIZE	1024
 static u32
 jffs2_1pass_build_lists(struct part_info * part)
@@ -786,12 +930,16 @@ jffs2_1pass_build_lists(struct part_info * part)
 	struct b_lists *pL;
 	struct jffs2_unknown_node *node;
 	unsigned nr_blocks, sectorsize, ofs, offset;
-	char *buf;
+	u_char *buf;
 	int i;
 	u32 counter = 0;
 	u32 counter4 = 0;
 	u32 counterF = 0;
 	u32 counterN = 0;
+#ifdef CONFIG_JFFS2_SUMMARY
+	u32 counterS = 0;
+	int ret;
+#endif
 
 	struct mtdids *id = part->dev->id;
 	nand = nand_info + id->num;
@@ -799,14 +947,18 @@ jffs2_1pass_build_lists(struct part_info * part)
 	/* if we are building a list we need to refresh the cache. */
 	jffs_init_1pass_list(part);
 	pL = (struct b_lists *)part->jffs2_priv;
+	if (!pL)
+		return 0;
+	pL->partNand = nand;
 	pL->partOffset = part->offset;
+	pL->partSize = part->size;
 	puts ("Scanning JFFS2 FS:   ");
 
 	sectorsize = nand->erasesize;
 	nr_blocks = part->size / sectorsize;
 	buf = malloc(sectorsize);
 	if (!buf)
-		return 0;
+		goto err;
 
 	for (i = 0; i < nr_blocks; i++) {
 		printf("\b\b%c ", spinner[counter++ % sizeof(spinner)]);
@@ -816,8 +968,25 @@ jffs2_1pass_build_lists(struct part_info * part)
 		if (nand_block_isbad(nand, offset))
 			continue;
 
+#ifdef CONFIG_JFFS2_SUMMARY
+		/* The summary ends in a marker in the last page of the block */
+		if (jffs2_fill_scan_buf(nand, buf + sectorsize - nand->writesize,
+					offset + sectorsize - nand->writesize,
+					nand->writesize))
+			goto err;
+
+		ret = jffs2_sum_scan_sumnode(pL, buf, sectorsize,
+					     nand->writesize, offset);
+		if (ret < 0)
+			goto err;
+		if (ret) {
+			counterS++;
+			continue;
+		}
+#endif
+
 		if (jffs2_fill_scan_buf(nand, buf, offset, EMPTY_SCAN_SIZE))
-			return 0;
+			goto err;
 
 		ofs = 0;
 		/* Scan only 4KiB of 0xFF before declaring it's empty */
@@ -827,7 +996,7 @@ jffs2_1pass_build_lists(struct part_info * part)
 			continue;
 
 		if (jffs2_fill_scan_buf(nand, buf + EMPTY_SCAN_SIZE, offset + EMPTY_SCAN_SIZE, sectorsize - EMPTY_SCAN_SIZE))
-			return 0;
+			goto err;
 		offset += ofs;
 
 		while (ofs < sectorsize - sizeof(struct jffs2_unknown_node)) {
@@ -842,18 +1011,16 @@ jffs2_1pass_build_lists(struct part_info * part)
 			if (node->nodetype == JFFS2_NODETYPE_INODE &&
 				    inode_crc((struct jffs2_raw_inode *) node)) {
 				if (insert_inode(&pL->frag, (struct jffs2_raw_inode *) node,
-						 offset) == NULL) {
-					return 0;
-				}
+						 offset) == NULL)
+					goto err;
 			} else if (node->nodetype == JFFS2_NODETYPE_DIRENT &&
 				   dirent_crc((struct jffs2_raw_dirent *) node)  &&
 				   dirent_name_crc((struct jffs2_raw_dirent *) node)) {
 				if (! (counterN%100))
 					puts ("\b\b.  ");
 				if (insert_dirent(&pL->dir, (struct jffs2_raw_dirent *) node,
-						  offset) == NULL) {
-					return 0;
-				}
+						  offset) == NULL)
+					goto err;
 				counterN++;
 			} else if (node->nodetype == JFFS2_NODETYPE_CLEANMARKER) {
 				if (node->totlen != sizeof(struct jffs2_unknown_node))
@@ -886,6 +1053,9 @@ jffs2_1pass_build_lists(struct part_info * part)
 	putLabeledWord("+4 increments = ", counter4);
 	putLabeledWord("+file_offset increments = ", counterF);
 #endif
+#ifdef CONFIG_JFFS2_SUMMARY
+	DEBUGF("%u of %u blocks added from summaries\n", counterS, nr_blocks);
+#endif
 
 #ifdef DEBUG_DIRENTS
 	dump_dirents(pL);
@@ -900,15 +1070,21 @@ jffs2_1pass_build_lists(struct part_info * part)
 	free(buf);
 
 	return 1;
+
+err:
+	/* do not leave partial lists behind for the next command */
+	free(buf);
+	jffs2_free_cache(part);
+	return 0;
 }
 
 
 static u32
 jffs2_1pass_fill_info(struct b_lists * pL, struct b_jffs2_info * piL)
 {
-	struct b_node *b;
+	struct b_inode *b;
 	struct jffs2_raw_inode ojNode;
-	struct jffs2_raw_inode *jNode;
+	size_t len;
 	int i;
 
 	for (i = 0; i < JFFS2_NUM_COMPR; i++) {
@@ -916,19 +1092,17 @@ jffs2_1pass_fill_info(struct b_lists * pL, struct b_jffs2_info * piL)
 		piL->compr_info[i].compr_sum = 0;
 		piL->compr_info[i].decompr_sum = 0;
 	}
-/*	FIXME
-	b = pL->frag.listHead;
-	while (b) {
-		jNode = (struct jffs2_raw_inode *) get_fl_mem(b->offset,
-			sizeof(ojNode), &ojNode);
-		if (jNode->compr < JFFS2_NUM_COMPR) {
-			piL->compr_info[jNode->compr].num_frags++;
-			piL->compr_info[jNode->compr].compr_sum += jNode->csize;
-			piL->compr_info[jNode->compr].decompr_sum += jNode->dsize;
+
+	for (b = (struct b_inode *)pL->frag.listHead; b; b = b->next) {
+		len = sizeof(ojNode);
+		if (nand_read(nand, b->offset, &len, (u_char *)&ojNode))
+			continue;
+		if (ojNode.compr < JFFS2_NUM_COMPR) {
+			piL->compr_info[ojNode.compr].num_frags++;
+			piL->compr_info[ojNode.compr].compr_sum += ojNode.csize;
+			piL->compr_info[ojNode.compr].decompr_sum += ojNode.dsize;
 		}
-		b = b->next;
 	}
-*/
 	return 0;
 }
 
@@ -936,13 +1110,18 @@ jffs2_1pass_fill_info(struct b_lists * pL, struct b_jffs2_info * piL)
 static struct b_lists *
 jffs2_get_list(struct part_info * part, const char *who)
 {
+	struct b_lists *pL;
+
 	if (jffs2_1pass_rescan_needed(part)) {
 		if (!jffs2_1pass_build_lists(part)) {
 			printf("%s: Failed to scan JFFSv2 file structure\n", who);
 			return NULL;
 		}
 	}
-	return (struct b_lists *)part->jffs2_priv;
+	pL = (struct b_lists *)part->jffs2_priv;
+	/* the lists may have been built for another device */
+	nand = pL->partNand;
+	return pL;
 }
 
 
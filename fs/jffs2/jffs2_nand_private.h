@@ -12,7 +12,6 @@ struct b_inode {
 	u32 offset;	/* physical offset to beginning of real inode */
 	u32 version;
 	u32 ino;
-	u32 isize;
 	u32 csize;
 };
 
@@ -35,7 +34,9 @@ struct b_list {
 };
 
 struct b_lists {
-	char *partOffset;
+	nand_info_t *partNand;	/* device, offset and size the lists */
+	u64 partOffset;		/* were built from */
+	u64 partSize;
 	struct b_list dir;
 	struct b_list frag;
 };
@@ -316,6 +316,10 @@ static int init_constants_early(struct ubifs_info *c)
 	c->min_io_size = c->di.min_io_size;
 	c->min_io_shift = fls(c->min_io_size) - 1;
 
+	c->max_bu_buf_len = UBIFS_MAX_BULK_READ * UBIFS_MAX_DATA_NODE_SZ;
+	if (c->max_bu_buf_len > c->leb_size)
+		c->max_bu_buf_len = c->leb_size;
+
 	if (c->leb_size < UBIFS_MIN_LEB_SZ) {
 		ubifs_err("too small LEBs (%d bytes), min. is %d bytes",
 			  c->leb_size, UBIFS_MIN_LEB_SZ);
@@ -579,6 +583,27 @@ static int check_volume_empty(struct ubifs_info *c)
  * Note, the function does not de-allocate resources it it fails half way
  * through, and the caller has to do this instead.
  */
+/**
+ * bu_init - initialize bulk-read information.
+ * @c: UBIFS file-system description object
+ */
+static void bu_init(struct ubifs_info *c)
+{
+	ubifs_assert(c->bulk_read == 1);
+
+	if (c->bu.buf)
+		return; /* Already initialized */
+
+	c->bu.buf = kmalloc(c->max_bu_buf_len, GFP_KERNEL);
+	if (!c->bu.buf) {
+		/* Just disable bulk-read */
+		ubifs_warn("Cannot allocate %d bytes of memory for bulk-read, "
+			   "disabling it", c->max_bu_buf_len);
+		c->bulk_read = 0;
+		return;
+	}
+}
+
 static int mount_ubifs(struct ubifs_info *c)
 {
 	struct super_block *sb = c->vfs_sb;
@@ -629,6 +654,9 @@ static int mount_ubifs(struct ubifs_info *c)
 	if (!c->sbuf)
 		goto out_free;
 
+	if (c->bulk_read == 1)
+		bu_init(c);
+
 	/*
 	 * We have to check all CRCs, even for data nodes, when we mount the FS
 	 * (specifically, when we are replaying).
@@ -799,6 +827,7 @@ out_infos:
 out_orphans:
 	free_orphans(c);
 out_journal:
+	ubifs_tnc_close(c);
 out_lpt:
 	ubifs_lpt_free(c, 0);
 out_master:
@@ -808,6 +837,7 @@ out_master:
 		kthread_stop(c->bgt);
 	kfree(c->cbuf);
 out_free:
+	kfree(c->bu.buf);
 	vfree(c->ileb_buf);
 	vfree(c->sbuf);
 	kfree(c->bottom_up_buf);
@@ -836,12 +866,14 @@ void ubifs_umount(struct ubifs_info *c)
 	if (c->bgt)
 		kthread_stop(c->bgt);
 
+	ubifs_tnc_close(c);
 	free_orphans(c);
 	ubifs_lpt_free(c, 0);
 
 	kfree(c->cbuf);
 	kfree(c->rcvrd_mst_node);
 	kfree(c->mst_node);
+	kfree(c->bu.buf);
 	vfree(c->ileb_buf);
 	vfree(c->sbuf);
 	kfree(c->bottom_up_buf);
@@ -949,6 +981,11 @@ static int ubifs_fill_super(struct super_block *sb, void *data, int silent)
 	c->highest_inum = UBIFS_FIRST_INO;
 	c->lhead_lnum = c->ltail_lnum = UBIFS_LOG_LNUM;
 
+	/* U-Boot always reads whole files, so bulk-read pays off */
+	c->bulk_read = 1;
+	c->tnc_cache_max = getenv_ulong("ubifscache", 10,
+					CONFIG_UBIFS_TNC_CACHE_KB) << 10;
+
 	ubi_get_volume_info(ubi, &c->vi);
 	ubi_get_device_info(c->vi.ubi_num, &c->di);
 
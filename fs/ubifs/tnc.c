@@ -333,15 +333,17 @@ static int lnc_add(struct ubifs_info *c, struct ubifs_zbranch *zbr,
 
 	ubifs_assert(!zbr->leaf);
 	ubifs_assert(zbr->len != 0);
-	ubifs_assert(is_hash_key(c, &zbr->key));
 
-	err = ubifs_validate_entry(c, dent);
-	if (err) {
-		dbg_dump_stack();
-		dbg_dump_node(c, dent);
-		return err;
+	if (is_hash_key(c, &zbr->key)) {
+		err = ubifs_validate_entry(c, dent);
+		if (err) {
+			dbg_dump_stack();
+			dbg_dump_node(c, dent);
+			return err;
+		}
 	}
 
+	c->lnc_misses += 1;
 	lnc_node = kmalloc(zbr->len, GFP_NOFS);
 	if (!lnc_node)
 		/* We don't have to have the cache, so no error */
@@ -349,6 +351,7 @@ static int lnc_add(struct ubifs_info *c, struct ubifs_zbranch *zbr,
 
 	memcpy(lnc_node, node, zbr->len);
 	zbr->leaf = lnc_node;
+	c->tnc_cache_sz += zbr->len;
 	return 0;
 }
 
@@ -377,6 +380,8 @@ static int lnc_add_directly(struct ubifs_info *c, struct ubifs_zbranch *zbr,
 	}
 
 	zbr->leaf = node;
+	c->lnc_misses += 1;
+	c->tnc_cache_sz += zbr->len;
 	return 0;
 }
 
@@ -403,18 +408,22 @@ static void lnc_free(struct ubifs_zbranch *zbr)
  * (in it is there) or from the hash media, in which case the node is also
  * added to LNC. Returns zero in case of success or a negative negative error
  * code in case of failure.
+ *
+ * U-Boot has no inode cache, so inode nodes are kept in LNC as well.
  */
 static int tnc_read_node_nm(struct ubifs_info *c, struct ubifs_zbranch *zbr,
 			    void *node)
 {
 	int err;
 
-	ubifs_assert(is_hash_key(c, &zbr->key));
+	ubifs_assert(is_hash_key(c, &zbr->key) ||
+		     key_type(c, &zbr->key) == UBIFS_INO_KEY);
 
 	if (zbr->leaf) {
 		/* Read from the leaf node cache */
 		ubifs_assert(zbr->len != 0);
 		memcpy(node, zbr->leaf, zbr->len);
+		c->lnc_hits += 1;
 		return 0;
 	}
 
@@ -550,8 +559,10 @@ static int matches_name(struct ubifs_info *c, struct ubifs_zbranch *zbr,
 		err = lnc_add_directly(c, zbr, dent);
 		if (err)
 			goto out_free;
-	} else
+	} else {
 		dent = zbr->leaf;
+		c->lnc_hits += 1;
+	}
 
 	nlen = le16_to_cpu(dent->nlen);
 	err = memcmp(dent->name, nm->name, min_t(int, nlen, nm->len));
@@ -586,9 +597,11 @@ static struct ubifs_znode *get_znode(struct ubifs_info *c,
 	struct ubifs_zbranch *zbr;
 
 	zbr = &znode->zbranch[n];
-	if (zbr->znode)
+	if (zbr->znode) {
 		znode = zbr->znode;
-	else
+		znode->time = c->tnc_clock;
+		c->zn_hits += 1;
+	} else
 		znode = ubifs_load_znode(c, zbr, znode, n);
 	return znode;
 }
@@ -843,8 +856,10 @@ static int fallible_matches_name(struct ubifs_info *c,
 		err = lnc_add_directly(c, zbr, dent);
 		if (err)
 			goto out_free;
-	} else
+	} else {
 		dent = zbr->leaf;
+		c->lnc_hits += 1;
+	}
 
 	nlen = le16_to_cpu(dent->nlen);
 	err = memcmp(dent->name, nm->name, min_t(int, nlen, nm->len));
@@ -1172,7 +1187,8 @@ int ubifs_lookup_level0(struct ubifs_info *c, const union ubifs_key *key,
 {
 	int err, exact;
 	struct ubifs_znode *znode;
-	unsigned long time = get_seconds();
+	/* Age znodes by lookups, 'ubifs_tnc_shrink()' evicts the oldest */
+	unsigned long time = ++c->tnc_clock;
 
 	dbg_tnc("search key %s", DBGKEY(key));
 
@@ -1181,7 +1197,8 @@ int ubifs_lookup_level0(struct ubifs_info *c, const union ubifs_key *key,
 		znode = ubifs_load_znode(c, &c->zroot, NULL, 0);
 		if (IS_ERR(znode))
 			return PTR_ERR(znode);
-	}
+	} else
+		c->zn_hits += 1;
 
 	znode->time = time;
 
@@ -1198,8 +1215,9 @@ int ubifs_lookup_level0(struct ubifs_info *c, const union ubifs_key *key,
 		zbr = &znode->zbranch[*n];
 
 		if (zbr->znode) {
-			znode->time = time;
 			znode = zbr->znode;
+			znode->time = time;
+			c->zn_hits += 1;
 			continue;
 		}
 
@@ -1441,7 +1459,7 @@ again:
 		*lnum = zt->lnum;
 		*offs = zt->offs;
 	}
-	if (is_hash_key(c, key)) {
+	if (is_hash_key(c, key) || key_type(c, key) == UBIFS_INO_KEY) {
 		/*
 		 * In this case the leaf node cache gets used, so we pass the
 		 * address of the zbranch and keep the mutex locked
@@ -2765,3 +2783,17 @@ out_unlock:
 	mutex_unlock(&c->tnc_mutex);
 	return ERR_PTR(err);
 }
+
+/**
+ * ubifs_tnc_close - close TNC subsystem and free all related resources.
+ * @c: UBIFS file-system description object
+ */
+void ubifs_tnc_close(struct ubifs_info *c)
+{
+	if (c->zroot.znode) {
+		ubifs_destroy_tnc_subtree(c->zroot.znode);
+		c->zroot.znode = NULL;
+	}
+	c->tnc_cache_sz = 0;
+	destroy_old_idx(c);
+}
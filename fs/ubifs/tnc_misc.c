@@ -218,6 +218,44 @@ struct ubifs_znode *ubifs_tnc_postorder_next(struct ubifs_znode *znode)
 	return ubifs_tnc_postorder_first(zn);
 }
 
+/**
+ * ubifs_destroy_tnc_subtree - destroy all znodes connected to a subtree.
+ * @znode: znode defining subtree to destroy
+ *
+ * This function destroys subtree of the TNC tree. Returns number of clean
+ * znodes in the subtree.
+ */
+long ubifs_destroy_tnc_subtree(struct ubifs_znode *znode)
+{
+	struct ubifs_znode *zn = ubifs_tnc_postorder_first(znode);
+	long clean_freed = 0;
+	int n;
+
+	ubifs_assert(zn);
+	while (1) {
+		for (n = 0; n < zn->child_cnt; n++) {
+			if (!zn->zbranch[n].znode)
+				continue;
+
+			if (zn->level > 0 &&
+			    !ubifs_zn_dirty(zn->zbranch[n].znode))
+				clean_freed += 1;
+
+			cond_resched();
+			kfree(zn->zbranch[n].znode);
+		}
+
+		if (zn == znode) {
+			if (!ubifs_zn_dirty(zn))
+				clean_freed += 1;
+			kfree(zn);
+			return clean_freed;
+		}
+
+		zn = ubifs_tnc_postorder_next(zn);
+	}
+}
+
 /**
  * read_znode - read an indexing node from flash and fill znode.
  * @c: UBIFS file-system description object
@@ -387,9 +425,12 @@ struct ubifs_znode *ubifs_load_znode(struct ubifs_info *c,
 
 	zbr->znode = znode;
 	znode->parent = parent;
-	znode->time = get_seconds();
+	znode->time = c->tnc_clock;
 	znode->iip = iip;
 
+	c->zn_misses += 1;
+	c->tnc_cache_sz += c->max_znode_sz;
+
 	return znode;
 
 out:
@@ -433,3 +474,114 @@ int ubifs_tnc_read_node(struct ubifs_info *c, struct ubifs_zbranch *zbr,
 
 	return 0;
 }
+
+/* Number of znodes 'ubifs_tnc_shrink()' evicts per walk of the TNC */
+#define TNC_SHRINK_BATCH 16
+
+/**
+ * tnc_cache_usage - memory accounted to a znode in the TNC cache.
+ * @c: UBIFS file-system description object
+ * @znode: znode to account
+ *
+ * Returns the size of @znode plus the leaf nodes cached in its branches.
+ */
+static long tnc_cache_usage(const struct ubifs_info *c,
+			    const struct ubifs_znode *znode)
+{
+	long size = c->max_znode_sz;
+	int i;
+
+	if (znode->level == 0)
+		for (i = 0; i < znode->child_cnt; i++)
+			if (znode->zbranch[i].leaf)
+				size += znode->zbranch[i].len;
+
+	return size;
+}
+
+/**
+ * tnc_evict - drop a znode from the TNC cache.
+ * @c: UBIFS file-system description object
+ * @znode: clean znode without children in memory
+ *
+ * The znode is re-read from the media on the next access.
+ */
+static void tnc_evict(struct ubifs_info *c, struct ubifs_znode *znode)
+{
+	int i;
+
+	c->tnc_cache_sz -= tnc_cache_usage(c, znode);
+
+	if (znode->level == 0)
+		for (i = 0; i < znode->child_cnt; i++)
+			kfree(znode->zbranch[i].leaf);
+
+	if (znode->parent)
+		znode->parent->zbranch[znode->iip].znode = NULL;
+	else
+		c->zroot.znode = NULL;
+	kfree(znode);
+}
+
+/**
+ * ubifs_tnc_shrink - keep the TNC cache within its limit.
+ * @c: UBIFS file-system description object
+ *
+ * U-Boot has no memory shrinker, so without a limit the TNC and the leaf node
+ * cache grow with every file looked up or read until the file-system is
+ * un-mounted. This function evicts the least recently used clean znodes which
+ * have no children in memory, together with their cached leaf nodes, while
+ * more than @c->tnc_cache_max bytes are in use.
+ *
+ * Pointers to znodes are not stable across this function, so it must only be
+ * called between TNC operations.
+ */
+void ubifs_tnc_shrink(struct ubifs_info *c)
+{
+	struct ubifs_znode *victim[TNC_SHRINK_BATCH];
+	struct ubifs_znode *znode;
+	long size;
+	int i, cnt;
+
+	while (c->tnc_cache_max && c->tnc_cache_sz > c->tnc_cache_max) {
+		/* Find the oldest znodes that may go, oldest first */
+		cnt = 0;
+		size = 0;
+		znode = ubifs_tnc_postorder_first(c->zroot.znode);
+		for (; znode; znode = ubifs_tnc_postorder_next(znode)) {
+			if (ubifs_zn_dirty(znode))
+				continue;
+
+			size += tnc_cache_usage(c, znode);
+			if (znode->level > 0 && ubifs_tnc_find_child(znode, 0))
+				continue;
+
+			for (i = cnt; i > 0; i--) {
+				if (victim[i - 1]->time <= znode->time)
+					break;
+				if (i < TNC_SHRINK_BATCH)
+					victim[i] = victim[i - 1];
+			}
+			if (i < TNC_SHRINK_BATCH) {
+				victim[i] = znode;
+				if (cnt < TNC_SHRINK_BATCH)
+					cnt++;
+			}
+		}
+
+		/*
+		 * Journal replay at mount time dirties znodes and drops cached
+		 * leaf nodes without accounting, so resync the usage here.
+		 */
+		c->tnc_cache_sz = size;
+		if (!cnt || size <= c->tnc_cache_max)
+			break;
+
+		/*
+		 * Always evict the whole batch, so that the next few znodes
+		 * read do not cause another walk.
+		 */
+		for (i = 0; i < cnt; i++)
+			tnc_evict(c, victim[i]);
+	}
+}
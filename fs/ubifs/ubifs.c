@@ -471,6 +471,7 @@ int ubifs_ls(char *filename)
 	int ret = 0;
 
 	c->ubi = ubi_open_volume(c->vi.ubi_num, c->vi.vol_id, UBI_READONLY);
+	ubifs_tnc_shrink(c);
 	inum = ubifs_findfile(ubifs_sb, filename);
 	if (!inum) {
 		ret = -1;
@@ -519,23 +520,20 @@ static inline void *kmap(struct page *page)
 	return page->addr;
 }
 
-static int read_block(struct inode *inode, void *addr, unsigned int block,
-		      struct ubifs_data_node *dn)
+/**
+ * decompress_block - uncompress a data node into a block.
+ * @inode: inode the data node belongs to
+ * @addr: the block is returned here
+ * @block: block number, for error messages
+ * @dn: data node
+ */
+static int decompress_block(struct inode *inode, void *addr,
+			    unsigned int block, struct ubifs_data_node *dn)
 {
 	struct ubifs_info *c = inode->i_sb->s_fs_info;
 	int err, len, out_len;
-	union ubifs_key key;
 	unsigned int dlen;
 
-	data_key_init(c, &key, inode->i_ino, block);
-	err = ubifs_tnc_lookup(c, &key, dn);
-	if (err) {
-		if (err == -ENOENT)
-			/* Not found, so it must be a hole */
-			memset(addr, 0, UBIFS_BLOCK_SIZE);
-		return err;
-	}
-
 	ubifs_assert(le64_to_cpu(dn->ch.sqnum) > ubifs_inode(inode)->creat_sqnum);
 
 	len = le32_to_cpu(dn->size);
@@ -566,6 +564,115 @@ dump:
 	return -EINVAL;
 }
 
+static int read_block(struct inode *inode, void *addr, unsigned int block,
+		      struct ubifs_data_node *dn)
+{
+	struct ubifs_info *c = inode->i_sb->s_fs_info;
+	union ubifs_key key;
+	int err;
+
+	data_key_init(c, &key, inode->i_ino, block);
+	err = ubifs_tnc_lookup(c, &key, dn);
+	if (err) {
+		if (err == -ENOENT)
+			/* Not found, so it must be a hole */
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+		return err;
+	}
+
+	return decompress_block(inode, addr, block, dn);
+}
+
+/**
+ * bulk_read_blocks - read the first blocks of a file using bulk-reads.
+ * @c: UBIFS file-system description object
+ * @inode: inode to read from
+ * @addr: destination address
+ * @count: number of blocks to read
+ * @last_len: number of bytes to store of the last block
+ *
+ * The data nodes of a file written in one go are mostly consecutive in a LEB,
+ * so instead of looking up and reading every node on its own this function
+ * collects runs of them with 'ubifs_tnc_get_bu_keys()' and reads each run with
+ * a single UBI read. Holes are zero-filled. Returns zero in case of success
+ * and a negative error code in case of failure.
+ */
+static int bulk_read_blocks(struct ubifs_info *c, struct inode *inode,
+			    void *addr, unsigned int count, int last_len)
+{
+	struct bu_info *bu = &c->bu;
+	unsigned int block = 0, end;
+	void *buff = NULL, *dst;
+	int err = 0, nn, len;
+
+	while (block < count) {
+		/* Nothing in the TNC is referenced between bulk-reads */
+		ubifs_tnc_shrink(c);
+
+		data_key_init(c, &bu->key, inode->i_ino, block);
+		bu->buf_len = c->max_bu_buf_len;
+		err = ubifs_tnc_get_bu_keys(c, bu);
+		if (err)
+			break;
+
+		if (bu->cnt) {
+			err = ubifs_tnc_bulk_read(c, bu);
+			if (err)
+				break;
+			c->bu_reads += 1;
+			c->bu_nodes += bu->cnt;
+			end = key_block(c, &bu->zbranch[bu->cnt - 1].key) + 1;
+		} else if (bu->eof) {
+			/* No more data nodes, the rest is a hole */
+			end = count;
+		} else {
+			end = block + max(bu->blk_cnt, 1);
+		}
+		if (end > count)
+			end = count;
+
+		for (nn = 0; block < end; block++) {
+			struct ubifs_data_node *dn;
+
+			dst = addr + block * UBIFS_BLOCK_SIZE;
+			len = block + 1 == count ? last_len : UBIFS_BLOCK_SIZE;
+
+			if (nn >= bu->cnt ||
+			    key_block(c, &bu->zbranch[nn].key) != block) {
+				memset(dst, 0, len);
+				continue;
+			}
+
+			dn = bu->buf + bu->zbranch[nn].offs - bu->zbranch[0].offs;
+			nn++;
+
+			if (len == UBIFS_BLOCK_SIZE) {
+				err = decompress_block(inode, dst, block, dn);
+				if (err)
+					goto out;
+				continue;
+			}
+
+			/* Do not write beyond the requested size */
+			if (!buff) {
+				buff = malloc(UBIFS_BLOCK_SIZE);
+				if (!buff) {
+					err = -ENOMEM;
+					goto out;
+				}
+			}
+			err = decompress_block(inode, buff, block, dn);
+			if (err)
+				goto out;
+			memcpy(dst, buff, len);
+		}
+	}
+
+out:
+	free(buff);
+	return err;
+}
+
 static int do_readpage(struct ubifs_info *c, struct inode *inode,
 		       struct page *page, int last_block_size)
 {
@@ -689,6 +796,7 @@ int ubifs_load(char *filename, u32 addr, u32 size)
 	int last_block_size = 0;
 
 	c->ubi = ubi_open_volume(c->vi.ubi_num, c->vi.vol_id, UBI_READONLY);
+	ubifs_tnc_shrink(c);
 	/* ubifs_findfile will resolve symlinks, so we know that we get
 	 * the real file here */
 	inum = ubifs_findfile(ubifs_sb, filename);
@@ -718,22 +826,28 @@ int ubifs_load(char *filename, u32 addr, u32 size)
 	printf("Loading file '%s' to addr 0x%08x with size %d (0x%08x)...\n",
 	       filename, addr, size, size);
 
-	page.addr = (void *)addr;
-	page.index = 0;
-	page.inode = inode;
-	for (i = 0; i < count; i++) {
-		/*
-		 * Make sure to not read beyond the requested size
-		 */
-		if (((i + 1) == count) && (size < inode->i_size))
-			last_block_size = size - (i * PAGE_SIZE);
+	if (c->bulk_read) {
+		last_block_size = size - (count - 1) * UBIFS_BLOCK_SIZE;
+		err = bulk_read_blocks(c, inode, (void *)addr, count,
+				       last_block_size);
+	} else {
+		page.addr = (void *)addr;
+		page.index = 0;
+		page.inode = inode;
+		for (i = 0; i < count; i++) {
+			/*
+			 * Make sure to not read beyond the requested size
+			 */
+			if (((i + 1) == count) && (size < inode->i_size))
+				last_block_size = size - (i * PAGE_SIZE);
 
-		err = do_readpage(c, inode, &page, last_block_size);
-		if (err)
-			break;
+			err = do_readpage(c, inode, &page, last_block_size);
+			if (err)
+				break;
 
-		page.addr += PAGE_SIZE;
-		page.index++;
+			page.addr += PAGE_SIZE;
+			page.index++;
+		}
 	}
 
 	if (err)
@@ -576,8 +576,17 @@ static inline ino_t parent_ino(struct dentry *dentry)
 /* Maximum expected tree height for use by bottom_up_buf */
 #define BOTTOM_UP_HEIGHT 64
 
-/* Maximum number of data nodes to bulk-read */
-#define UBIFS_MAX_BULK_READ 32
+/*
+ * Maximum number of data nodes to bulk-read. U-Boot reads straight to the
+ * load address, so this is sized to let one bulk-read cover a whole LEB of
+ * compressed data rather than a few page cache pages.
+ */
+#define UBIFS_MAX_BULK_READ 64
+
+/* Default limit of the TNC cache in KiB, see 'ubifs_tnc_shrink()' */
+#ifndef CONFIG_UBIFS_TNC_CACHE_KB
+#define CONFIG_UBIFS_TNC_CACHE_KB 256
+#endif
 
 /*
  * Lockdep classes for UBIFS inode @ui_mutex.
@@ -1418,6 +1427,16 @@ struct ubifs_debug_info;
  * @bu_mutex: protects the pre-allocated bulk-read buffer and @c->bu
  * @bu: pre-allocated bulk-read information
  *
+ * @tnc_cache_sz: bytes used by clean znodes and the leaf node cache
+ * @tnc_cache_max: limit of @tnc_cache_sz, %0 if unlimited
+ * @tnc_clock: access counter used to age znodes
+ * @zn_hits: znode lookups served from the TNC
+ * @zn_misses: znodes read from the media
+ * @lnc_hits: leaf node lookups served from the leaf node cache
+ * @lnc_misses: cacheable leaf nodes read from the media
+ * @bu_reads: number of bulk-reads
+ * @bu_nodes: number of data nodes read by bulk-reads
+ *
  * @log_lebs: number of logical eraseblocks in the log
  * @log_bytes: log size in bytes
  * @log_last: last LEB of the log
@@ -1657,6 +1676,16 @@ struct ubifs_info {
 	struct mutex bu_mutex;
 	struct bu_info bu;
 
+	long tnc_cache_sz;
+	long tnc_cache_max;
+	unsigned long tnc_clock;
+	unsigned long zn_hits;
+	unsigned long zn_misses;
+	unsigned long lnc_hits;
+	unsigned long lnc_misses;
+	unsigned long bu_reads;
+	unsigned long bu_nodes;
+
 	int log_lebs;
 	long long log_bytes;
 	int log_last;
@@ -1978,6 +2007,7 @@ struct ubifs_znode *ubifs_load_znode(struct ubifs_info *c,
 				     struct ubifs_znode *parent, int iip);
 int ubifs_tnc_read_node(struct ubifs_info *c, struct ubifs_zbranch *zbr,
 			void *node);
+void ubifs_tnc_shrink(struct ubifs_info *c);
 
 /* tnc_commit.c */
 int ubifs_tnc_start_commit(struct ubifs_info *c, struct ubifs_zbranch *zroot);
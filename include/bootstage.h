@@ -191,6 +191,10 @@ enum bootstage_id {
 	BOOTSTAGE_ID_MAIN_CPU_READY,
 
 	BOOTSTAGE_ID_ACCUM_LCD,
+	BOOTSTAGE_ID_ACCUM_BOOTM_READ,	/* bootm: reading image from flash */
+	BOOTSTAGE_ID_ACCUM_BOOTM_CRC,	/* bootm: image data CRC */
+	BOOTSTAGE_ID_ACCUM_BOOTM_DECOMP,/* bootm: decompressing image */
+	BOOTSTAGE_ID_ACCUM_NAND_BBT,	/* NAND: reading or creating BBT */
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
@@ -642,6 +642,7 @@ void	serial_setbrg (void);
 void	serial_putc   (const char);
 void	serial_putc_raw(const char);
 void	serial_puts   (const char *);
+int	serial_write_nb(const char *, int);
 int	serial_getc   (void);
 int	serial_tstc   (void);
 
@@ -794,6 +795,7 @@ int	init_timebase (void);
 
 /* lib/gunzip.c */
 int gunzip(void *, int, unsigned char *, unsigned long *);
+int gzip_parse_header(const unsigned char *src, unsigned long len);
 int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 						int stoponerr, int offset);
 
@@ -837,6 +839,11 @@ int	ctrlc (void);
 int	had_ctrlc (void);	/* have we had a Control-C since last clear? */
 void	clear_ctrlc (void);	/* clear the Control-C condition */
 int	disable_ctrlc (int);	/* 1 to disable, 0 to enable Control-C detect */
+#if defined(CONFIG_CONSOLE_TX_BUFFER) && !defined(CONFIG_SPL_BUILD)
+void	console_flush(void);	/* Wait until buffered output reached the device */
+#else
+static inline void console_flush(void) {}
+#endif
 
 /*
  * STDIO based functions (can always be used)
@@ -38,6 +38,7 @@
 #define CONFIG_SYS_NAND_OOBSIZE		64
 #define CONFIG_SYS_NAND_BLOCK_SIZE	(256 * 1024)
 #define CONFIG_SYS_NAND_5_ADDR_CYCLE
+#define CONFIG_SYS_NAND_SIZE		(128 * 1024 * 1024)
 
 #define CONFIG_LTQ_SPL_COMP_LZO
 #define CONFIG_LTQ_SPL_CONSOLE
@@ -34,6 +34,7 @@
 #define CONFIG_CMD_FDT
 
 #define CONFIG_FS_FAT
+#define CONFIG_FAT_CACHE
 #define CONFIG_FS_EXT4
 #define CONFIG_EXT4_WRITE
 #define CONFIG_CMD_FAT
@@ -74,10 +75,13 @@
 #define CONFIG_ENV_SIZE		8192
 #define CONFIG_ENV_IS_NOWHERE
 
+#define CONFIG_CMD_TEST_STRING
+
 /* SPI */
 #define CONFIG_SANDBOX_SPI
 #define CONFIG_CMD_SF
 #define CONFIG_CMD_SF_TEST
+#define CONFIG_CMD_SF_BENCH
 #define CONFIG_CMD_SPI
 #define CONFIG_SPI_FLASH
 #define CONFIG_SPI_FLASH_SANDBOX
@@ -55,6 +55,12 @@ struct ext4_extent {
 	__le32	ee_start_lo;	/* low 32 bits of physical block */
 };
 
+/*
+ * ee_len values above EXT_INIT_MAX_LEN mark an uninitialized extent of
+ * (ee_len - EXT_INIT_MAX_LEN) blocks, which reads back as zeroes.
+ */
+#define EXT_INIT_MAX_LEN	(1UL << 15)
+
 /*
  * This is index on-disk structure.
  * It's used at all the levels except the bottom.
@@ -138,6 +144,8 @@ void ext4fs_free_node(struct ext2fs_node *node, struct ext2fs_node *currroot);
 int ext4fs_devread(lbaint_t sector, int byte_offset, int byte_len, char *buf);
 void ext4fs_set_blk_dev(block_dev_desc_t *rbdd, disk_partition_t *info);
 long int read_allocated_block(struct ext2_inode *inode, int fileblock);
+long int ext4fs_map_extent(struct ext2_inode *inode, uint32_t fileblock,
+			   long int *blknr, int *uninit);
 int ext4fs_probe(block_dev_desc_t *fs_dev_desc,
 		 disk_partition_t *fs_partition);
 int ext4_read_file(const char *filename, void *buf, int offset, int len);
@@ -29,6 +29,11 @@
 #define FAT16BUFSIZE	(FATBUFSIZE/2)
 #define FAT32BUFSIZE	(FATBUFSIZE/4)
 
+/* Default number of FAT sectors kept by CONFIG_FAT_CACHE */
+#ifndef CONFIG_FAT_CACHE_SECTORS
+#define CONFIG_FAT_CACHE_SECTORS	(16 * FATBUFBLOCKS)
+#endif
+
 
 /* Filesystem identifiers */
 #define FAT12_SIGN	"FAT12   "
@@ -303,6 +303,9 @@ typedef struct bootm_headers {
 #endif
 
 	int		verify;		/* getenv("verify")[0] != 'n' */
+#ifdef CONFIG_BOOTM_PREFETCH
+	int		verify_deferred;/* data CRC checked in bootm_load_os() */
+#endif
 
 #define	BOOTM_STATE_START	(0x00000001)
 #define	BOOTM_STATE_FINDOS	(0x00000002)
@@ -648,6 +651,52 @@ int image_setup_libfdt(bootm_headers_t *images, void *blob,
  */
 int image_setup_linux(bootm_headers_t *images);
 
+/**
+ * image_prefetch_wanted() - check whether to use the prefetching reader
+ *
+ * Compressed images in memory-mapped flash are read in cached, sequential
+ * chunks instead of being decompressed directly from flash. This can be
+ * disabled with the environment variable bootm_prefetch=no.
+ *
+ * @comp:	Compression type of the image (IH_COMP_...)
+ * @addr:	Address of the compressed data
+ * @len:	Length of the compressed data
+ * @return 1 if image_prefetch_uncompress() should be used, 0 if not
+ */
+int image_prefetch_wanted(uint8_t comp, ulong addr, ulong len);
+
+/**
+ * image_prefetch_uncompress() - decompress an image from flash
+ *
+ * The data is fetched from flash through a bounce buffer in chunks of
+ * CONFIG_BOOTM_PREFETCH_SIZE bytes and, if @crc is given, checksummed on
+ * the way. The time spent on each phase is recorded with bootstage.
+ *
+ * @comp:	Compression type of the image (IH_COMP_...)
+ * @src:	Address of the compressed data
+ * @src_len:	Length of the compressed data
+ * @dst:	Output buffer
+ * @dst_len:	Size of the output buffer
+ * @out_len:	Returns the number of bytes written to @dst
+ * @crc:	Returns the CRC32 of all @src_len bytes, may be NULL
+ * @return 0 if ok, else the error code of the decompressor
+ */
+int image_prefetch_uncompress(uint8_t comp, ulong src, ulong src_len,
+			      void *dst, ulong dst_len, ulong *out_len,
+			      uint32_t *crc);
+
+/**
+ * image_prefetch_map() - map an image for the prefetching reader
+ *
+ * The default uses map_sysmem(). Architectures may return a cached alias
+ * of the flash window instead, which must be coherent with flash.
+ *
+ * @addr:	Address of the compressed data
+ * @len:	Length of the compressed data
+ * @return pointer to read the data from
+ */
+const void *image_prefetch_map(ulong addr, ulong len);
+
 /**
  * bootz_setup() - Extract stat and size of a Linux xImage
  *
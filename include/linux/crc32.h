@@ -8,7 +8,12 @@
 #include <linux/types.h>
 /* #include <linux/bitrev.h> */
 
-extern u32  crc32_le(u32 crc, unsigned char const *p, size_t len);
+/*
+ * The little-endian CRC32 without final inversion is crc32_no_comp() from
+ * lib/crc32.c, so UBI and UBIFS share its tables instead of their own.
+ */
+uint32_t crc32_no_comp(uint32_t crc, const unsigned char *p, uint len);
+#define crc32_le(crc, p, len)	crc32_no_comp(crc, p, len)
 /* extern u32  crc32_be(u32 crc, unsigned char const *p, size_t len); */
 
 #define crc32(seed, data, length)  crc32_le(seed, (unsigned char const *)data, length)
@@ -31,6 +31,18 @@ int lzo1x_decompress_safe(const unsigned char *src, size_t src_len,
 int lzop_decompress(const unsigned char *src, size_t src_len,
 		    unsigned char *dst, size_t *dst_len);
 
+/*
+ * Incremental lzop decompression. lzop_parse_header() returns a pointer
+ * to the first block or NULL if the magic does not match. Each call of
+ * lzop_decompress_block() decodes one complete block from *src and
+ * advances *src, *dst and *remaining. LZO_E_INPUT_OVERRUN is returned
+ * without consuming anything if src_len does not cover the whole block,
+ * LZOP_E_END if the end-of-stream marker has been reached.
+ */
+const unsigned char *lzop_parse_header(const unsigned char *src);
+int lzop_decompress_block(const unsigned char **src, size_t src_len,
+			  unsigned char **dst, size_t *remaining);
+
 /*
  * Return values (< 0 = Error)
  */
@@ -45,4 +57,7 @@ int lzop_decompress(const unsigned char *src, size_t src_len,
 #define LZO_E_INPUT_NOT_CONSUMED	(-8)
 #define LZO_E_NOT_YET_IMPLEMENTED	(-9)
 
+/* lzop_decompress_block() found the end-of-stream marker */
+#define LZOP_E_END			1
+
 #endif
@@ -38,6 +38,7 @@ typedef struct block_dev_desc {
 				       lbaint_t start,
 				       lbaint_t blkcnt);
 	void		*priv;		/* driver private struct pointer */
+	unsigned long	gen;		/* changed on re-init and raw writes */
 }block_dev_desc_t;
 
 #define BLOCK_CNT(size, block_dev_desc) (PAD_COUNT(size, block_dev_desc->blksz))
@@ -111,6 +112,7 @@ int host_get_dev_err(int dev, block_dev_desc_t **blk_devp);
 int get_partition_info (block_dev_desc_t * dev_desc, int part, disk_partition_t *info);
 void print_part (block_dev_desc_t *dev_desc);
 void  init_part (block_dev_desc_t *dev_desc);
+void dev_changed(block_dev_desc_t *dev_desc);
 void dev_print(block_dev_desc_t *dev_desc);
 int get_device(const char *ifname, const char *dev_str,
 	       block_dev_desc_t **dev_desc);
@@ -133,6 +135,7 @@ static inline int get_partition_info (block_dev_desc_t * dev_desc, int part,
 	disk_partition_t *info) { return -1; }
 static inline void print_part (block_dev_desc_t *dev_desc) {}
 static inline void  init_part (block_dev_desc_t *dev_desc) {}
+static inline void dev_changed(block_dev_desc_t *dev_desc) {}
 static inline void dev_print(block_dev_desc_t *dev_desc) {}
 static inline int get_device(const char *ifname, const char *dev_str,
 	       block_dev_desc_t **dev_desc)
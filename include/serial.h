@@ -14,6 +14,8 @@ struct serial_device {
 	int	(*tstc)(void);
 	void	(*putc)(const char c);
 	void	(*puts)(const char *s);
+	/* queue up to len chars without waiting, returns the number taken */
+	int	(*write_nb)(const char *s, int len);
 #if CONFIG_POST & CONFIG_SYS_POST_UART
 	void	(*loop)(int);
 #endif
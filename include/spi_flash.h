@@ -28,12 +28,16 @@
 /* Enum list - Full read commands */
 enum spi_read_cmds {
 	ARRAY_SLOW = 1 << 0,
-	DUAL_OUTPUT_FAST = 1 << 1,
-	DUAL_IO_FAST = 1 << 2,
-	QUAD_OUTPUT_FAST = 1 << 3,
-	QUAD_IO_FAST = 1 << 4,
+	ARRAY_FAST = 1 << 1,
+	DUAL_OUTPUT_FAST = 1 << 2,
+	DUAL_IO_FAST = 1 << 3,
+	QUAD_OUTPUT_FAST = 1 << 4,
+	QUAD_IO_FAST = 1 << 5,
 };
-#define RD_EXTN		ARRAY_SLOW | DUAL_OUTPUT_FAST | DUAL_IO_FAST
+#define RD_NORM		ARRAY_SLOW | ARRAY_FAST
+#define RD_DUAL		RD_NORM | DUAL_OUTPUT_FAST
+#define RD_QUAD		RD_DUAL | QUAD_OUTPUT_FAST
+#define RD_EXTN		RD_NORM | DUAL_OUTPUT_FAST | DUAL_IO_FAST
 #define RD_FULL		RD_EXTN | QUAD_OUTPUT_FAST | QUAD_IO_FAST
 
 /* Dual SPI flash memories */
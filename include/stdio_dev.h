@@ -34,6 +34,7 @@ struct stdio_dev {
 
 	void (*putc) (const char c);	/* To put a char			*/
 	void (*puts) (const char *s);	/* To put a string (accelerator)	*/
+	int (*write_nb) (const char *s, int len); /* To put without waiting	*/
 
 /* INPUT functions */
 
@@ -219,5 +219,8 @@ extern int ubi_volume_write(char *volume, void *buf, size_t size);
 extern int ubi_volume_read(char *volume, char *buf, size_t size);
 
 extern struct ubi_device *ubi_devices[];
+#ifdef CONFIG_MTD_UBI_FASTMAP
+extern int ubi_fastmap_disabled;
+#endif
 
 #endif
@@ -26,7 +26,29 @@
 
 #define tole(x) cpu_to_le32(x)
 
+/*
+ * Number of lookup tables used per step: 1 (1 KiB of tables, one byte per
+ * lookup), 4 (4 KiB, one word per step) or 8 (8 KiB, two words per step).
+ * SPL has its own setting to keep the small table within its size budget.
+ */
+#if defined(CONFIG_SPL_BUILD)
+# ifdef CONFIG_SPL_CRC32_SLICES
+#  define CRC32_SLICES CONFIG_SPL_CRC32_SLICES
+# endif
+#elif defined(CONFIG_CRC32_SLICES)
+# define CRC32_SLICES CONFIG_CRC32_SLICES
+#endif
+#ifndef CRC32_SLICES
+# define CRC32_SLICES 1
+#endif
+#if CRC32_SLICES != 1 && CRC32_SLICES != 4 && CRC32_SLICES != 8
+# error "CRC32_SLICES must be 1, 4 or 8"
+#endif
+
 #ifdef DYNAMIC_CRC_TABLE
+#if CRC32_SLICES > 1
+# error "DYNAMIC_CRC_TABLE only provides the byte-wise table"
+#endif
 
 local int crc_table_empty = 1;
 local uint32_t crc_table[256];
@@ -149,6 +171,10 @@ tole(0xbad03605L), tole(0xcdd70693L), tole(0x54de5729L), tole(0x23d967bfL),
 tole(0xb3667a2eL), tole(0xc4614ab8L), tole(0x5d681b02L), tole(0x2a6f2b94L),
 tole(0xb40bbe37L), tole(0xc30c8ea1L), tole(0x5a05df1bL), tole(0x2d02ef8dL)
 };
+
+#if CRC32_SLICES > 1
+#include "crc32_slice.h"
+#endif
 #endif
 
 #if 0
@@ -167,10 +193,19 @@ const uint32_t * ZEXPORT get_crc_table()
 /* ========================================================================= */
 # if __BYTE_ORDER == __LITTLE_ENDIAN
 #  define DO_CRC(x) crc = tab[(crc ^ (x)) & 255] ^ (crc >> 8)
+#  define SLICE_BYTE(w, i) (((w) >> (8 * (i))) & 255)
 # else
 #  define DO_CRC(x) crc = tab[((crc >> 24) ^ (x)) & 255] ^ (crc << 8)
+#  define SLICE_BYTE(w, i) (((w) >> (24 - 8 * (i))) & 255)
 # endif
 
+/*
+ * Lookup for byte i (in memory order) of word w in the table that advances
+ * the CRC by k further bytes; k = 0 is the byte-wise crc_table itself.
+ */
+# define DO_SLICE(k, w, i) crc_table_slice[(k) - 1][SLICE_BYTE(w, i)]
+# define DO_SLICE0(w, i) tab[SLICE_BYTE(w, i)]
+
 /* ========================================================================= */
 
 /* No ones complement version. JFFS2 (and other things ?)
@@ -195,6 +230,25 @@ uint32_t ZEXPORT crc32_no_comp(uint32_t crc, const Bytef *buf, uInt len)
 	 b = (uint32_t *)p;
     }
 
+#if CRC32_SLICES == 8
+    for (; len >= 8; len -= 8) {
+	 /* two words per step, eight independent lookups */
+	 uint32_t q = *b++ ^ crc;
+
+	 crc = *b++;
+	 crc = DO_SLICE(7, q, 0) ^ DO_SLICE(6, q, 1) ^
+	       DO_SLICE(5, q, 2) ^ DO_SLICE(4, q, 3) ^
+	       DO_SLICE(3, crc, 0) ^ DO_SLICE(2, crc, 1) ^
+	       DO_SLICE(1, crc, 2) ^ DO_SLICE0(crc, 3);
+    }
+#endif
+#if CRC32_SLICES >= 4
+    for (; len >= 4; len -= 4) {
+	 crc ^= *b++;
+	 crc = DO_SLICE(3, crc, 0) ^ DO_SLICE(2, crc, 1) ^
+	       DO_SLICE(1, crc, 2) ^ DO_SLICE0(crc, 3);
+    }
+#endif
     rem_len = len & 3;
     len = len >> 2;
     for (--b; len; --len) {
@@ -217,6 +271,9 @@ uint32_t ZEXPORT crc32_no_comp(uint32_t crc, const Bytef *buf, uInt len)
     return le32_to_cpu(crc);
 }
 #undef DO_CRC
+#undef DO_SLICE
+#undef DO_SLICE0
+#undef SLICE_BYTE
 
 uint32_t ZEXPORT crc32 (uint32_t crc, const Bytef *p, uInt len)
 {
@@ -1,12 +1,28 @@
 /* LzmaDec.c -- LZMA Decoder
 2009-09-20 : Igor Pavlov : Public domain */
 
+#ifdef USE_HOSTCC
+#include <string.h>
+#define WATCHDOG_RESET() do { } while (0)
+#include "LzmaDec.h"
+#else
 #include <config.h>
 #include <common.h>
 #include <watchdog.h>
 #include "LzmaDec.h"
 
 #include <linux/string.h>
+#endif
+
+/*
+ * U-Boot: CONFIG_LZMA_SPEED_OPT (CONFIG_SPL_LZMA_SPEED_OPT in SPL) adds
+ * LzmaDec_DecodeFlat(), a decoder loop for output buffers that hold the
+ * whole stream, which is how bootm and the SPL use the decoder.
+ */
+#if (defined(CONFIG_SPL_BUILD) && defined(CONFIG_SPL_LZMA_SPEED_OPT)) || \
+    (!defined(CONFIG_SPL_BUILD) && defined(CONFIG_LZMA_SPEED_OPT))
+#define _LZMA_DEC_FLAT
+#endif
 
 #define kNumTopBits 24
 #define kTopValue ((UInt32)1 << kNumTopBits)
@@ -93,6 +109,7 @@
 
 #define kMatchMinLen 2
 #define kMatchSpecLenStart (kMatchMinLen + kLenNumLowSymbols + kLenNumMidSymbols + kLenNumHighSymbols)
+#define kMatchMaxLen (kMatchSpecLenStart - 1)
 
 #define IsMatch 0
 #define IsRep (IsMatch + (kNumStates << kNumPosBitsMax))
@@ -451,6 +468,294 @@ static int MY_FAST_CALL LzmaDec_DecodeReal(CLzmaDec *p, SizeT limit, const Byte
   return SZ_OK;
 }
 
+#ifdef _LZMA_DEC_FLAT
+/*
+LzmaDec_DecodeFlat() is LzmaDec_DecodeReal() for a dictionary that starts at
+the beginning of the output and never wraps (dicPos == processedPos), as with
+LzmaDecode() and the SPL. Matches are copied from dic + dicPos - rep0 without
+wrap handling, and because decoding stops kMatchMaxLen bytes before the limit
+a match never has to be cut short. Unlike LzmaDec_DecodeReal() it may decode
+no symbol at all; LzmaDec_DecodeReal() finishes the last bytes.
+*/
+
+#define LZMA_FLAT_CHUNK (1 << 16) /* output between watchdog resets */
+
+static int MY_FAST_CALL LzmaDec_DecodeFlat(CLzmaDec *p, SizeT limit, const Byte *bufLimit)
+{
+  CLzmaProb *probs = p->probs;
+
+  unsigned state = p->state;
+  UInt32 rep0 = p->reps[0], rep1 = p->reps[1], rep2 = p->reps[2], rep3 = p->reps[3];
+  unsigned pbMask = ((unsigned)1 << (p->prop.pb)) - 1;
+  unsigned lpMask = ((unsigned)1 << (p->prop.lp)) - 1;
+  unsigned lc = p->prop.lc;
+
+  Byte *dic = p->dic;
+  Byte *out = dic + p->dicPos;
+  Byte *outLimit, *chunkLimit;
+  unsigned prevByte;
+
+  UInt32 checkDicSize = p->checkDicSize;
+  unsigned len = 0;
+
+  const Byte *buf = p->buf;
+  UInt32 range = p->range;
+  UInt32 code = p->code;
+
+  if (p->dicPos != p->processedPos || limit - p->dicPos <= kMatchSpecLenStart)
+    return SZ_OK;
+  outLimit = dic + limit - kMatchSpecLenStart;
+  prevByte = (out == dic) ? 0 : out[-1];
+
+  while (out < outLimit && buf < bufLimit)
+  {
+    chunkLimit = (outLimit - out > LZMA_FLAT_CHUNK) ? out + LZMA_FLAT_CHUNK : outLimit;
+    WATCHDOG_RESET();
+
+    do
+    {
+      CLzmaProb *prob;
+      UInt32 bound;
+      unsigned ttt;
+      UInt32 processedPos = (UInt32)(out - dic);
+      unsigned posState = processedPos & pbMask;
+
+      prob = probs + IsMatch + (state << kNumPosBitsMax) + posState;
+      IF_BIT_0(prob)
+      {
+        unsigned symbol;
+        UPDATE_0(prob);
+        /* prevByte is 0 for the first byte, which selects the same probs */
+        prob = probs + Literal + (LZMA_LIT_SIZE * (((processedPos & lpMask) << lc) + (prevByte >> (8 - lc))));
+
+        if (state < kNumLitStates)
+        {
+          state -= (state < 4) ? state : 3;
+          symbol = 1;
+          do { GET_BIT(prob + symbol, symbol) } while (symbol < 0x100);
+        }
+        else
+        {
+          unsigned matchByte = out[-(ptrdiff_t)rep0];
+          unsigned offs = 0x100;
+          state -= (state < 10) ? 3 : 6;
+          symbol = 1;
+          do
+          {
+            unsigned bit;
+            CLzmaProb *probLit;
+            matchByte <<= 1;
+            bit = (matchByte & offs);
+            probLit = prob + offs + bit + symbol;
+            GET_BIT2(probLit, symbol, offs &= ~bit, offs &= bit)
+          }
+          while (symbol < 0x100);
+        }
+        prevByte = (Byte)symbol;
+        *out++ = (Byte)symbol;
+        continue;
+      }
+
+      UPDATE_1(prob);
+      prob = probs + IsRep + state;
+      IF_BIT_0(prob)
+      {
+        UPDATE_0(prob);
+        state += kNumStates;
+        prob = probs + LenCoder;
+      }
+      else
+      {
+        UPDATE_1(prob);
+        if (out == dic)
+          return SZ_ERROR_DATA;
+        prob = probs + IsRepG0 + state;
+        IF_BIT_0(prob)
+        {
+          UPDATE_0(prob);
+          prob = probs + IsRep0Long + (state << kNumPosBitsMax) + posState;
+          IF_BIT_0(prob)
+          {
+            UPDATE_0(prob);
+            prevByte = out[-(ptrdiff_t)rep0];
+            *out++ = (Byte)prevByte;
+            state = state < kNumLitStates ? 9 : 11;
+            continue;
+          }
+          UPDATE_1(prob);
+        }
+        else
+        {
+          UInt32 distance;
+          UPDATE_1(prob);
+          prob = probs + IsRepG1 + state;
+          IF_BIT_0(prob)
+          {
+            UPDATE_0(prob);
+            distance = rep1;
+          }
+          else
+          {
+            UPDATE_1(prob);
+            prob = probs + IsRepG2 + state;
+            IF_BIT_0(prob)
+            {
+              UPDATE_0(prob);
+              distance = rep2;
+            }
+            else
+            {
+              UPDATE_1(prob);
+              distance = rep3;
+              rep3 = rep2;
+            }
+            rep2 = rep1;
+          }
+          rep1 = rep0;
+          rep0 = distance;
+        }
+        state = state < kNumLitStates ? 8 : 11;
+        prob = probs + RepLenCoder;
+      }
+      {
+        unsigned limit, offset;
+        CLzmaProb *probLen = prob + LenChoice;
+        IF_BIT_0(probLen)
+        {
+          UPDATE_0(probLen);
+          probLen = prob + LenLow + (posState << kLenNumLowBits);
+          offset = 0;
+          limit = (1 << kLenNumLowBits);
+        }
+        else
+        {
+          UPDATE_1(probLen);
+          probLen = prob + LenChoice2;
+          IF_BIT_0(probLen)
+          {
+            UPDATE_0(probLen);
+            probLen = prob + LenMid + (posState << kLenNumMidBits);
+            offset = kLenNumLowSymbols;
+            limit = (1 << kLenNumMidBits);
+          }
+          else
+          {
+            UPDATE_1(probLen);
+            probLen = prob + LenHigh;
+            offset = kLenNumLowSymbols + kLenNumMidSymbols;
+            limit = (1 << kLenNumHighBits);
+          }
+        }
+        TREE_DECODE(probLen, limit, len);
+        len += offset;
+      }
+
+      if (state >= kNumStates)
+      {
+        UInt32 distance;
+        prob = probs + PosSlot +
+            ((len < kNumLenToPosStates ? len : kNumLenToPosStates - 1) << kNumPosSlotBits);
+        TREE_6_DECODE(prob, distance);
+        if (distance >= kStartPosModelIndex)
+        {
+          unsigned posSlot = (unsigned)distance;
+          int numDirectBits = (int)(((distance >> 1) - 1));
+          distance = (2 | (distance & 1));
+          if (posSlot < kEndPosModelIndex)
+          {
+            distance <<= numDirectBits;
+            prob = probs + SpecPos + distance - posSlot - 1;
+            {
+              UInt32 mask = 1;
+              unsigned i = 1;
+              do
+              {
+                GET_BIT2(prob + i, i, ; , distance |= mask);
+                mask <<= 1;
+              }
+              while (--numDirectBits != 0);
+            }
+          }
+          else
+          {
+            numDirectBits -= kNumAlignBits;
+            do
+            {
+              NORMALIZE
+              range >>= 1;
+
+              {
+                UInt32 t;
+                code -= range;
+                t = (0 - ((UInt32)code >> 31)); /* (UInt32)((Int32)code >> 31) */
+                distance = (distance << 1) + (t + 1);
+                code += range & t;
+              }
+            }
+            while (--numDirectBits != 0);
+            prob = probs + Align;
+            distance <<= kNumAlignBits;
+            {
+              unsigned i = 1;
+              GET_BIT2(prob + i, i, ; , distance |= 1);
+              GET_BIT2(prob + i, i, ; , distance |= 2);
+              GET_BIT2(prob + i, i, ; , distance |= 4);
+              GET_BIT2(prob + i, i, ; , distance |= 8);
+            }
+            if (distance == (UInt32)0xFFFFFFFF)
+            {
+              len += kMatchSpecLenStart;
+              state -= kNumStates;
+              goto end;
+            }
+          }
+        }
+        rep3 = rep2;
+        rep2 = rep1;
+        rep1 = rep0;
+        rep0 = distance + 1;
+        if (checkDicSize == 0)
+        {
+          if (distance >= processedPos)
+            return SZ_ERROR_DATA;
+        }
+        else if (distance >= checkDicSize)
+          return SZ_ERROR_DATA;
+        state = (state < kNumStates + kNumLitStates) ? kNumLitStates : kNumLitStates + 3;
+      }
+
+      /* there is room for the longest match, copy it whole */
+      {
+        const Byte *src = out - rep0;
+        Byte *lim = out + len + kMatchMinLen;
+        do
+          *out++ = *src++;
+        while (out != lim);
+        prevByte = out[-1];
+        len = 0;
+      }
+    }
+    while (out < chunkLimit && buf < bufLimit);
+  }
+end:
+
+  NORMALIZE;
+  p->buf = buf;
+  p->range = range;
+  p->code = code;
+  p->remainLen = len;
+  p->dicPos = (SizeT)(out - dic);
+  p->processedPos = (UInt32)(out - dic);
+  p->reps[0] = rep0;
+  p->reps[1] = rep1;
+  p->reps[2] = rep2;
+  p->reps[3] = rep3;
+  p->state = state;
+
+  return SZ_OK;
+}
+#endif /* _LZMA_DEC_FLAT */
+
 static void MY_FAST_CALL LzmaDec_WriteRem(CLzmaDec *p, SizeT limit)
 {
   if (p->remainLen != 0 && p->remainLen < kMatchSpecLenStart)
@@ -488,7 +793,17 @@ static int MY_FAST_CALL LzmaDec_DecodeReal2(CLzmaDec *p, SizeT limit, const Byte
       if (limit - p->dicPos > rem)
         limit2 = p->dicPos + rem;
     }
+#ifdef _LZMA_DEC_FLAT
+    {
+      SizeT dicPos = p->dicPos;
+      RINOK(LzmaDec_DecodeFlat(p, limit2, bufLimit));
+      /* keep "first symbol is always decoded" if the fast loop did nothing */
+      if (p->remainLen == 0 && (p->dicPos == dicPos || p->buf < bufLimit))
+        RINOK(LzmaDec_DecodeReal(p, limit2, bufLimit));
+    }
+#else
     RINOK(LzmaDec_DecodeReal(p, limit2, bufLimit));
+#endif
     if (p->processedPos >= p->prop.dicSize)
       p->checkDicSize = p->prop.dicSize;
     LzmaDec_WriteRem(p, limit);
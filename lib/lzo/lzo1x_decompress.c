@@ -30,7 +30,7 @@ static const unsigned char lzop_magic[] = {
 
 #define HEADER_HAS_FILTER	0x00000800L
 
-static inline const unsigned char *parse_header(const unsigned char *src)
+const unsigned char *lzop_parse_header(const unsigned char *src)
 {
 	u16 version;
 	int i;
@@ -62,55 +62,85 @@ static inline const unsigned char *parse_header(const unsigned char *src)
 	return src;
 }
 
+int lzop_decompress_block(const unsigned char **src, size_t src_len,
+			  unsigned char **dst, size_t *remaining)
+{
+	const unsigned char *ip = *src;
+	u32 slen, dlen;
+	size_t tmp;
+	int r;
+
+	if (src_len < 4)
+		return LZO_E_INPUT_OVERRUN;
+
+	/* read uncompressed block size */
+	dlen = get_unaligned_be32(ip);
+
+	/* exit if last block */
+	if (dlen == 0) {
+		*src = ip + 4;
+		return LZOP_E_END;
+	}
+
+	if (src_len < 12)
+		return LZO_E_INPUT_OVERRUN;
+
+	/* read compressed block size, and skip block checksum info */
+	slen = get_unaligned_be32(ip + 4);
+	ip += 12;
+
+	if (slen <= 0 || slen > dlen)
+		return LZO_E_ERROR;
+
+	/* wait until the whole block is available */
+	if (src_len - 12 < slen)
+		return LZO_E_INPUT_OVERRUN;
+
+	/* abort if buffer ran out of room */
+	if (dlen > *remaining)
+		return LZO_E_OUTPUT_OVERRUN;
+
+	/* decompress */
+	tmp = dlen;
+	r = lzo1x_decompress_safe((u8 *) ip, slen, *dst, &tmp);
+
+	if (r != LZO_E_OK)
+		return r;
+
+	if (dlen != tmp)
+		return LZO_E_ERROR;
+
+	*src = ip + slen;
+	*dst += dlen;
+	*remaining -= dlen;
+
+	return LZO_E_OK;
+}
+
 int lzop_decompress(const unsigned char *src, size_t src_len,
 		    unsigned char *dst, size_t *dst_len)
 {
 	unsigned char *start = dst;
 	const unsigned char *send = src + src_len;
-	u32 slen, dlen;
-	size_t tmp, remaining;
+	size_t remaining;
 	int r;
 
-	src = parse_header(src);
+	src = lzop_parse_header(src);
 	if (!src)
 		return LZO_E_ERROR;
 
 	remaining = *dst_len;
 	while (src < send) {
-		/* read uncompressed block size */
-		dlen = get_unaligned_be32(src);
-		src += 4;
+		r = lzop_decompress_block(&src, send - src, &dst, &remaining);
 
 		/* exit if last block */
-		if (dlen == 0) {
+		if (r == LZOP_E_END) {
 			*dst_len = dst - start;
 			return LZO_E_OK;
 		}
 
-		/* read compressed block size, and skip block checksum info */
-		slen = get_unaligned_be32(src);
-		src += 8;
-
-		if (slen <= 0 || slen > dlen)
-			return LZO_E_ERROR;
-
-		/* abort if buffer ran out of room */
-		if (dlen > remaining)
-			return LZO_E_OUTPUT_OVERRUN;
-
-		/* decompress */
-		tmp = dlen;
-		r = lzo1x_decompress_safe((u8 *) src, slen, dst, &tmp);
-
 		if (r != LZO_E_OK)
 			return r;
-
-		if (dlen != tmp)
-			return LZO_E_ERROR;
-
-		src += slen;
-		dst += dlen;
-		remaining -= dlen;
 	}
 
 	return LZO_E_INPUT_OVERRUN;
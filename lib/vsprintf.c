@@ -839,6 +839,7 @@ void panic(const char *fmt, ...)
 	vprintf(fmt, args);
 	putc('\n');
 	va_end(args);
+	console_flush();
 #if defined(CONFIG_PANIC_HANG)
 	hang();
 #else
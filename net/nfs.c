@@ -42,12 +42,29 @@
 
 static int fs_mounted;
 static unsigned long rpc_id;
-static int nfs_offset = -1;
-static int nfs_len;
+static unsigned int nfs_offset;	/* next offset to request */
+static unsigned int nfs_read_end;	/* file size, once EOF was seen */
+static unsigned int nfs_read_size;
 static ulong nfs_timeout = NFS_TIMEOUT;
+static ulong nfs_start_time;
+static int nfs_version;
 
-static char dirfh[NFS_FHSIZE];	/* file handle of directory */
-static char filefh[NFS_FHSIZE]; /* file handle of kernel image */
+static char dirfh[NFS3_FHSIZE];	/* file handle of directory */
+static unsigned int dirfh_len;
+static char filefh[NFS3_FHSIZE]; /* file handle of kernel image */
+static unsigned int filefh_len;
+
+/*
+ * READ requests in flight. Replies may arrive in any order and are
+ * matched to their request by the RPC XID; a slot with len == 0 is free,
+ * one with id == 0 still has to be sent.
+ */
+struct nfs_read_slot {
+	unsigned long id;
+	unsigned int offset;
+	unsigned int len;
+};
+static struct nfs_read_slot nfs_read_slots[NFS_READ_WINDOW];
 
 static enum net_loop_state nfs_download_state;
 static IPaddr_t NfsServerIP;
@@ -188,7 +205,11 @@ rpc_req(int rpc_prog, int rpc_proc, uint32_t *data, int datalen)
 	pkt.u.call.type = htonl(MSG_CALL);
 	pkt.u.call.rpcvers = htonl(2);	/* use RPC version 2 */
 	pkt.u.call.prog = htonl(rpc_prog);
-	pkt.u.call.vers = htonl(2);	/* portmapper is version 2 */
+	/* portmapper is version 2, MOUNT and NFS follow the NFS version */
+	if (rpc_prog != PROG_PORTMAP && nfs_version == NFS_V3)
+		pkt.u.call.vers = htonl(3);
+	else
+		pkt.u.call.vers = htonl(2);
 	pkt.u.call.proc = htonl(rpc_proc);
 	p = (uint32_t *)&(pkt.u.call.data);
 
@@ -229,6 +250,20 @@ rpc_lookup_req(int prog, int ver)
 	rpc_req(PROG_PORTMAP, PORTMAP_GETPORT, data, 8);
 }
 
+/**************************************************************************
+NFS_ADD_FH - Add a file handle, NFSv3 handles are variable length
+**************************************************************************/
+static uint32_t *nfs_add_fh(uint32_t *p, const char *fh, unsigned int fhlen)
+{
+	if (nfs_version == NFS_V3)
+		*p++ = htonl(fhlen);
+	if (fhlen & 3)
+		*(p + fhlen / 4) = 0;
+	memcpy(p, fh, fhlen);
+
+	return p + (fhlen + 3) / 4;
+}
+
 /**************************************************************************
 NFS_MOUNT - Mount an NFS Filesystem
 **************************************************************************/
@@ -295,12 +330,12 @@ nfs_readlink_req(void)
 	p = &(data[0]);
 	p = (uint32_t *)rpc_add_credentials((long *)p);
 
-	memcpy(p, filefh, NFS_FHSIZE);
-	p += (NFS_FHSIZE / 4);
+	p = nfs_add_fh(p, filefh, filefh_len);
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
-	rpc_req(PROG_NFS, NFS_READLINK, data, len);
+	rpc_req(PROG_NFS, nfs_version == NFS_V3 ? NFS3PROC_READLINK :
+		NFS_READLINK, data, len);
 }
 
 /**************************************************************************
@@ -319,8 +354,7 @@ nfs_lookup_req(char *fname)
 	p = &(data[0]);
 	p = (uint32_t *)rpc_add_credentials((long *)p);
 
-	memcpy(p, dirfh, NFS_FHSIZE);
-	p += (NFS_FHSIZE / 4);
+	p = nfs_add_fh(p, dirfh, dirfh_len);
 	*p++ = htonl(fnamelen);
 	if (fnamelen & 3)
 		*(p + fnamelen / 4) = 0;
@@ -329,14 +363,15 @@ nfs_lookup_req(char *fname)
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
-	rpc_req(PROG_NFS, NFS_LOOKUP, data, len);
+	rpc_req(PROG_NFS, nfs_version == NFS_V3 ? NFS3PROC_LOOKUP : NFS_LOOKUP,
+		data, len);
 }
 
 /**************************************************************************
 NFS_READ - Read File on NFS Server
 **************************************************************************/
 static void
-nfs_read_req(int offset, int readlen)
+nfs_read_req(unsigned int offset, unsigned int readlen)
 {
 	uint32_t data[1024];
 	uint32_t *p;
@@ -345,17 +380,59 @@ nfs_read_req(int offset, int readlen)
 	p = &(data[0]);
 	p = (uint32_t *)rpc_add_credentials((long *)p);
 
-	memcpy(p, filefh, NFS_FHSIZE);
-	p += (NFS_FHSIZE / 4);
-	*p++ = htonl(offset);
-	*p++ = htonl(readlen);
-	*p++ = 0;
+	p = nfs_add_fh(p, filefh, filefh_len);
+	if (nfs_version == NFS_V3) {
+		*p++ = 0;		/* offset is 64 bit */
+		*p++ = htonl(offset);
+		*p++ = htonl(readlen);
+	} else {
+		*p++ = htonl(offset);
+		*p++ = htonl(readlen);
+		*p++ = 0;		/* totalcount, unused */
+	}
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
 	rpc_req(PROG_NFS, NFS_READ, data, len);
 }
 
+/**************************************************************************
+NFS_READ_WINDOW - Keep up to NFS_READ_WINDOW READ requests outstanding
+Free slots are given the next part of the file until its end is known.
+With resend set (after a timeout) every outstanding request is sent
+again. Returns the number of requests in flight.
+**************************************************************************/
+static int
+nfs_read_window(int resend)
+{
+	struct nfs_read_slot *slot;
+	int busy = 0;
+
+	for (slot = nfs_read_slots;
+	     slot < nfs_read_slots + NFS_READ_WINDOW; slot++) {
+		/* nothing to wait for beyond the end of the file */
+		if (slot->offset >= nfs_read_end)
+			slot->len = 0;
+
+		if (!slot->len && nfs_offset < nfs_read_end) {
+			slot->id = 0;
+			slot->offset = nfs_offset;
+			slot->len = nfs_read_size;
+			nfs_offset += nfs_read_size;
+		}
+		if (!slot->len)
+			continue;
+
+		if (!slot->id || resend) {
+			nfs_read_req(slot->offset, slot->len);
+			slot->id = rpc_id;
+		}
+		busy++;
+	}
+
+	return busy;
+}
+
 /**************************************************************************
 RPC request dispatcher
 **************************************************************************/
@@ -367,10 +444,10 @@ NfsSend(void)
 
 	switch (NfsState) {
 	case STATE_PRCLOOKUP_PROG_MOUNT_REQ:
-		rpc_lookup_req(PROG_MOUNT, 1);
+		rpc_lookup_req(PROG_MOUNT, nfs_version == NFS_V3 ? 3 : 1);
 		break;
 	case STATE_PRCLOOKUP_PROG_NFS_REQ:
-		rpc_lookup_req(PROG_NFS, 2);
+		rpc_lookup_req(PROG_NFS, nfs_version);
 		break;
 	case STATE_MOUNT_REQ:
 		nfs_mount_req(nfs_path);
@@ -382,7 +459,7 @@ NfsSend(void)
 		nfs_lookup_req(nfs_filename);
 		break;
 	case STATE_READ_REQ:
-		nfs_read_req(nfs_offset, nfs_len);
+		nfs_read_window(1);
 		break;
 	case STATE_READLINK_REQ:
 		nfs_readlink_req();
@@ -445,8 +522,16 @@ nfs_mount_reply(uchar *pkt, unsigned len)
 	    rpc_pkt.u.reply.data[0])
 		return -1;
 
+	if (nfs_version == NFS_V3) {
+		dirfh_len = ntohl(rpc_pkt.u.reply.data[1]);
+		if (dirfh_len > NFS3_FHSIZE)
+			return -1;
+		memcpy(dirfh, rpc_pkt.u.reply.data + 2, dirfh_len);
+	} else {
+		dirfh_len = NFS_FHSIZE;
+		memcpy(dirfh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
+	}
 	fs_mounted = 1;
-	memcpy(dirfh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
 
 	return 0;
 }
@@ -496,7 +581,15 @@ nfs_lookup_reply(uchar *pkt, unsigned len)
 	    rpc_pkt.u.reply.data[0])
 		return -1;
 
-	memcpy(filefh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
+	if (nfs_version == NFS_V3) {
+		filefh_len = ntohl(rpc_pkt.u.reply.data[1]);
+		if (filefh_len > NFS3_FHSIZE)
+			return -1;
+		memcpy(filefh, rpc_pkt.u.reply.data + 2, filefh_len);
+	} else {
+		filefh_len = NFS_FHSIZE;
+		memcpy(filefh, rpc_pkt.u.reply.data + 1, NFS_FHSIZE);
+	}
 
 	return 0;
 }
@@ -505,6 +598,7 @@ static int
 nfs_readlink_reply(uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
+	uint32_t *data;
 	int rlen;
 
 	debug("%s\n", __func__);
@@ -522,17 +616,21 @@ nfs_readlink_reply(uchar *pkt, unsigned len)
 	    rpc_pkt.u.reply.data[0])
 		return -1;
 
-	rlen = ntohl(rpc_pkt.u.reply.data[1]); /* new path length */
+	data = rpc_pkt.u.reply.data + 1;
+	/* NFSv3 may add the attributes of the link first */
+	if (nfs_version == NFS_V3)
+		data += *data ? 22 : 1;
+
+	rlen = ntohl(data[0]); /* new path length */
 
-	if (*((char *)&(rpc_pkt.u.reply.data[2])) != '/') {
+	if (*((char *)&(data[1])) != '/') {
 		int pathlen;
 		strcat(nfs_path, "/");
 		pathlen = strlen(nfs_path);
-		memcpy(nfs_path + pathlen, (uchar *)&(rpc_pkt.u.reply.data[2]),
-			rlen);
+		memcpy(nfs_path + pathlen, (uchar *)&(data[1]), rlen);
 		nfs_path[pathlen + rlen] = 0;
 	} else {
-		memcpy(nfs_path, (uchar *)&(rpc_pkt.u.reply.data[2]), rlen);
+		memcpy(nfs_path, (uchar *)&(data[1]), rlen);
 		nfs_path[rlen] = 0;
 	}
 	return 0;
@@ -542,15 +640,23 @@ static int
 nfs_read_reply(uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
-	int rlen;
+	struct nfs_read_slot *slot;
+	unsigned long id;
+	uint32_t *data;
+	unsigned int hlen;
+	int rlen, eof;
 
 	debug("%s\n", __func__);
 
-	memcpy((uchar *)&rpc_pkt, pkt, sizeof(rpc_pkt.u.reply));
+	memcpy((uchar *)&rpc_pkt, pkt, min(len, sizeof(rpc_pkt.u.reply)));
 
-	if (ntohl(rpc_pkt.u.reply.id) > rpc_id)
-		return -NFS_RPC_ERR;
-	else if (ntohl(rpc_pkt.u.reply.id) < rpc_id)
+	/* late answers to requests sent again after a timeout are dropped */
+	id = ntohl(rpc_pkt.u.reply.id);
+	for (slot = nfs_read_slots;
+	     slot < nfs_read_slots + NFS_READ_WINDOW; slot++)
+		if (slot->len && slot->id == id)
+			break;
+	if (slot == nfs_read_slots + NFS_READ_WINDOW)
 		return -NFS_RPC_DROP;
 
 	if (rpc_pkt.u.reply.rstatus  ||
@@ -564,17 +670,45 @@ nfs_read_reply(uchar *pkt, unsigned len)
 		return -ntohl(rpc_pkt.u.reply.data[0]);
 	}
 
-	if ((nfs_offset != 0) && !((nfs_offset) %
-			(NFS_READ_SIZE / 2 * 10 * HASHES_PER_LINE)))
+	data = rpc_pkt.u.reply.data;
+	if (nfs_version == NFS_V3) {
+		/* skip the file attributes, if present */
+		data += data[1] ? 23 : 2;
+		rlen = ntohl(data[0]);
+		eof = !rlen || data[1];
+		data += 3;
+	} else {
+		/* data[6] is the file size */
+		rlen = ntohl(data[18]);
+		eof = !rlen || slot->offset + rlen >= ntohl(data[6]);
+		data += 19;
+	}
+
+	/* a truncated reply is requested again after the timeout */
+	hlen = (uchar *)data - (uchar *)&rpc_pkt;
+	if (rlen > slot->len || hlen + rlen > len)
+		return -NFS_RPC_DROP;
+
+	if ((slot->offset != 0) && !((slot->offset) %
+			(nfs_read_size / 2 * 10 * HASHES_PER_LINE)))
 		puts("\n\t ");
-	if (!(nfs_offset % ((NFS_READ_SIZE / 2) * 10)))
+	if (!(slot->offset % ((nfs_read_size / 2) * 10)))
 		putc('#');
 
-	rlen = ntohl(rpc_pkt.u.reply.data[18]);
-	if (store_block((uchar *)pkt + sizeof(rpc_pkt.u.reply),
-			nfs_offset, rlen))
+	if (store_block(pkt + hlen, slot->offset, rlen))
 		return -9999;
 
+	if (eof) {
+		if (slot->offset + rlen < nfs_read_end)
+			nfs_read_end = slot->offset + rlen;
+		slot->len = 0;
+	} else {
+		/* short read, ask for the rest */
+		slot->offset += rlen;
+		slot->len -= rlen;
+		slot->id = 0;
+	}
+
 	return rlen;
 }
 
@@ -607,18 +741,33 @@ NfsHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src, unsigned len)
 	if (dest != NfsOurPort)
 		return;
 
+	/* only READ replies may be larger, the others are copied whole */
+	if (NfsState != STATE_READ_REQ && len > sizeof(struct rpc_t))
+		return;
+
 	switch (NfsState) {
 	case STATE_PRCLOOKUP_PROG_MOUNT_REQ:
 		if (rpc_lookup_reply(PROG_MOUNT, pkt, len) == -NFS_RPC_DROP)
 			break;
-		NfsState = STATE_PRCLOOKUP_PROG_NFS_REQ;
+		if (!NfsSrvMountPort && nfs_version == NFS_V3) {
+			/* no MOUNT v3, so no NFSv3 either */
+			nfs_version = NFS_V2;
+		} else {
+			NfsState = STATE_PRCLOOKUP_PROG_NFS_REQ;
+		}
 		NfsSend();
 		break;
 
 	case STATE_PRCLOOKUP_PROG_NFS_REQ:
 		if (rpc_lookup_reply(PROG_NFS, pkt, len) == -NFS_RPC_DROP)
 			break;
-		NfsState = STATE_MOUNT_REQ;
+		if (!NfsSrvNfsPort && nfs_version == NFS_V3) {
+			/* server does not speak NFSv3, start over with v2 */
+			nfs_version = NFS_V2;
+			NfsState = STATE_PRCLOOKUP_PROG_MOUNT_REQ;
+		} else {
+			NfsState = STATE_MOUNT_REQ;
+		}
 		NfsSend();
 		break;
 
@@ -645,6 +794,20 @@ NfsHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src, unsigned len)
 			puts("*** ERROR: Cannot umount\n");
 			net_set_state(NETLOOP_FAIL);
 		} else {
+			if (nfs_download_state == NETLOOP_SUCCESS) {
+				nfs_start_time = get_timer(nfs_start_time);
+				if (nfs_start_time > 0) {
+					puts("\n\t ");	/* Line up with "Loading: " */
+					print_size(NetBootFileXferSize /
+						nfs_start_time * 1000, "/s");
+					printf(" (NFSv%d, %u byte reads",
+					       nfs_version, nfs_read_size);
+					if (NFS_READ_WINDOW > 1)
+						printf(", window %d",
+						       NFS_READ_WINDOW);
+					putc(')');
+				}
+			}
 			puts("\ndone\n");
 			net_set_state(nfs_download_state);
 		}
@@ -661,7 +824,13 @@ NfsHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src, unsigned len)
 		} else {
 			NfsState = STATE_READ_REQ;
 			nfs_offset = 0;
-			nfs_len = NFS_READ_SIZE;
+			nfs_read_end = ~0U;
+			nfs_read_size = NFS_READ_SIZE;
+			if (nfs_version == NFS_V2 &&
+			    nfs_read_size > NFS_MAXDATA)
+				nfs_read_size = NFS_MAXDATA;
+			memset(nfs_read_slots, 0, sizeof(nfs_read_slots));
+			nfs_start_time = get_timer(0);
 			NfsSend();
 		}
 		break;
@@ -686,17 +855,21 @@ NfsHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src, unsigned len)
 
 	case STATE_READ_REQ:
 		rlen = nfs_read_reply(pkt, len);
+		if (rlen == -NFS_RPC_DROP)
+			break;
 		NetSetTimeout(nfs_timeout, NfsTimeout);
-		if (rlen > 0) {
-			nfs_offset += rlen;
+		if (rlen >= 0) {
+			/* refill the window, done when nothing is left */
+			if (nfs_read_window(0))
+				break;
+			nfs_download_state = NETLOOP_SUCCESS;
+			NfsState = STATE_UMOUNT_REQ;
 			NfsSend();
 		} else if ((rlen == -NFSERR_ISDIR) || (rlen == -NFSERR_INVAL)) {
 			/* symbolic link */
 			NfsState = STATE_READLINK_REQ;
 			NfsSend();
 		} else {
-			if (!rlen)
-				nfs_download_state = NETLOOP_SUCCESS;
 			NfsState = STATE_UMOUNT_REQ;
 			NfsSend();
 		}
@@ -775,6 +948,7 @@ NfsStart(void)
 
 	NfsTimeoutCount = 0;
 	NfsState = STATE_PRCLOOKUP_PROG_MOUNT_REQ;
+	nfs_version = NFS_V3;
 
 	/*NfsOurPort = 4096 + (get_ticks() % 3072);*/
 	/*FIX ME !!!*/
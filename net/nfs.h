@@ -25,7 +25,17 @@
 #define NFS_READLINK    5
 #define NFS_READ        6
 
+#define NFS3PROC_LOOKUP 3
+#define NFS3PROC_READLINK 5
+#define NFS3PROC_READ   6
+
+#define NFS_V2          2
+#define NFS_V3          3
+
 #define NFS_FHSIZE      32
+#define NFS3_FHSIZE     64
+
+#define NFS_MAXDATA     8192	/* largest NFSv2 READ */
 
 #define NFSERR_PERM     1
 #define NFSERR_NOENT    2
@@ -44,6 +54,13 @@
 #define NFS_READ_SIZE 1024 /* biggest power of two that fits Ether frame */
 #endif
 
+/* Number of READ requests kept outstanding at the same time */
+#ifdef CONFIG_NFS_READ_WINDOW
+#define NFS_READ_WINDOW CONFIG_NFS_READ_WINDOW
+#else
+#define NFS_READ_WINDOW 1
+#endif
+
 #define NFS_MAXLINKDEPTH 16
 
 struct rpc_t {
@@ -65,7 +82,8 @@ struct rpc_t {
 			uint32_t verifier;
 			uint32_t v2;
 			uint32_t astatus;
-			uint32_t data[19];
+			/* holds the headers of an NFSv3 READ reply */
+			uint32_t data[26];
 		} reply;
 	} u;
 };
@@ -14,6 +14,9 @@
 #ifdef CONFIG_SYS_DIRECT_FLASH_TFTP
 #include <flash.h>
 #endif
+#ifdef CONFIG_TFTP_HASH
+#include <hash.h>
+#endif
 
 /* Well known TFTP port # */
 #define WELL_KNOWN_PORT	69
@@ -130,6 +133,25 @@ static char tftp_filename[MAX_LEN];
 static unsigned short TftpBlkSize = TFTP_BLOCK_SIZE;
 static unsigned short TftpBlkSizeOption = TFTP_MTU_BLOCKSIZE;
 
+/*
+ * Number of blocks the server may send before waiting for an ACK (RFC 7440).
+ * The option is only requested for downloads when this is above 1.
+ */
+#ifdef CONFIG_TFTP_WINDOWSIZE
+#define TFTP_WINDOWSIZE CONFIG_TFTP_WINDOWSIZE
+#else
+#define TFTP_WINDOWSIZE 1
+#endif
+
+static unsigned short TftpWindowSize = 1;
+static unsigned short TftpWindowSizeOption = TFTP_WINDOWSIZE;
+/* block number that completes the current window */
+static ulong	TftpNextAck;
+/* last in-order block we asked the server to go back to */
+static ulong	TftpLastNack;
+/* number of blocks received out of order */
+static ulong	TftpOutOfOrder;
+
 #ifdef CONFIG_MCAST_TFTP
 #include <malloc.h>
 #define MTFTP_BITMAPSIZE	0x1000
@@ -156,6 +178,89 @@ mcast_cleanup(void)
 
 #endif	/* CONFIG_MCAST_TFTP */
 
+#ifdef CONFIG_TFTP_HASH
+/*
+ * Digest of the received file, built while the blocks arrive so that no
+ * second pass over the loaded image is needed. The algorithm is taken from
+ * the "tftphash" variable and the result is stored in "filehash".
+ */
+static struct hash_algo *tftp_hash;
+static void *tftp_hash_ctx;
+static ulong tftp_hash_offset;
+
+static void tftp_hash_stop(void)
+{
+	u8 digest[HASH_MAX_DIGEST_SIZE];
+
+	if (tftp_hash_ctx)
+		tftp_hash->hash_finish(tftp_hash, tftp_hash_ctx, digest,
+				       sizeof(digest));
+	tftp_hash_ctx = NULL;
+}
+
+static void tftp_hash_start(void)
+{
+	const char *algo = getenv("tftphash");
+
+	tftp_hash_stop();
+	if (!algo || TftpWriting)
+		return;
+
+	setenv("filehash", NULL);
+	if (hash_progressive_lookup_algo(algo, &tftp_hash)) {
+		printf("TFTP: unsupported hash algorithm '%s'\n", algo);
+		return;
+	}
+	if (tftp_hash->hash_init(tftp_hash, &tftp_hash_ctx))
+		tftp_hash_ctx = NULL;
+	tftp_hash_offset = 0;
+}
+
+static void tftp_hash_block(ulong offset, const uchar *src, unsigned len)
+{
+	if (!tftp_hash_ctx || offset + len <= tftp_hash_offset)
+		return;
+
+	/* a gap in the data, e.g. from multicast TFTP: give up */
+	if (offset != tftp_hash_offset) {
+		debug("TFTP: hash stopped at offset 0x%lx\n", offset);
+		tftp_hash_stop();
+		return;
+	}
+
+	if (tftp_hash->hash_update(tftp_hash, tftp_hash_ctx, src, len, 0)) {
+		tftp_hash_ctx = NULL;
+		return;
+	}
+	tftp_hash_offset += len;
+}
+
+static void tftp_hash_finish(void)
+{
+	u8 digest[HASH_MAX_DIGEST_SIZE];
+	char str[HASH_MAX_DIGEST_SIZE * 2 + 1];
+	void *ctx = tftp_hash_ctx;
+	int i;
+
+	if (!ctx)
+		return;
+
+	tftp_hash_ctx = NULL;
+	if (tftp_hash->hash_finish(tftp_hash, ctx, digest, sizeof(digest)))
+		return;
+
+	for (i = 0; i < tftp_hash->digest_size; i++)
+		sprintf(str + 2 * i, "%02x", digest[i]);
+	printf("%s: %s\n", tftp_hash->name, str);
+	setenv("filehash", str);
+}
+#else
+static inline void tftp_hash_start(void) {}
+static inline void tftp_hash_block(ulong offset, const uchar *src,
+				   unsigned len) {}
+static inline void tftp_hash_finish(void) {}
+#endif
+
 static inline void
 store_block(int block, uchar *src, unsigned len)
 {
@@ -186,6 +291,7 @@ store_block(int block, uchar *src, unsigned len)
 	{
 		(void)memcpy((void *)(load_addr + offset), src, len);
 	}
+	tftp_hash_block(offset, src, len);
 #ifdef CONFIG_MCAST_TFTP
 	if (Multicast)
 		ext2_set_bit(block, Bitmap);
@@ -201,9 +307,13 @@ static void new_transfer(void)
 	TftpLastBlock = 0;
 	TftpBlockWrap = 0;
 	TftpBlockWrapOffset = 0;
+	TftpNextAck = TftpWindowSize;
+	TftpLastNack = -1;
+	TftpOutOfOrder = 0;
 #ifdef CONFIG_CMD_TFTPPUT
 	TftpFinalBlock = 0;
 #endif
+	tftp_hash_start();
 }
 
 #ifdef CONFIG_CMD_TFTPPUT
@@ -305,8 +415,12 @@ static void tftp_complete(void)
 		puts("\n\t ");	/* Line up with "Loading: " */
 		print_size(NetBootFileXferSize /
 			time_start * 1000, "/s");
+		if (TftpWindowSize > 1)
+			printf(" (window %d, %lu blocks out of order)",
+			       TftpWindowSize, TftpOutOfOrder);
 	}
 	puts("\ndone\n");
+	tftp_hash_finish();
 	net_set_state(NETLOOP_SUCCESS);
 }
 
@@ -359,6 +473,10 @@ TftpSend(void)
 		/* try for more effic. blk size */
 		pkt += sprintf((char *)pkt, "blksize%c%d%c",
 				0, TftpBlkSizeOption, 0);
+		/* and for more than one block in flight */
+		if (TftpState == STATE_SEND_RRQ && TftpWindowSizeOption > 1)
+			pkt += sprintf((char *)pkt, "windowsize%c%d%c",
+					0, TftpWindowSizeOption, 0);
 #ifdef CONFIG_MCAST_TFTP
 		/* Check all preconditions before even trying the option */
 		if (!ProhibitMcast) {
@@ -442,6 +560,27 @@ static void icmp_handler(unsigned type, unsigned code, unsigned dest,
 }
 #endif
 
+/*
+ * A block other than the next one arrived within a window. If it is ahead of
+ * the next one, a block has been lost: acknowledge the last block received
+ * in order so the server continues from there, but only once per position.
+ * Blocks we already have are ignored like in lock-step mode; answering them
+ * would make the server resend whole windows (Sorcerer's Apprentice), a
+ * lost ACK is recovered by the timeout instead.
+ */
+static void tftp_out_of_order(ushort block)
+{
+	TftpOutOfOrder++;
+	if ((ushort)(block - TftpLastBlock - 1) >= TFTP_SEQUENCE_SIZE / 2 ||
+	    TftpLastNack == TftpLastBlock)
+		return;
+
+	TftpLastNack = TftpLastBlock;
+	TftpBlock = TftpLastBlock;
+	TftpNextAck = (ushort)(TftpBlock + TftpWindowSize);
+	TftpSend();
+}
+
 static void
 TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 	    unsigned len)
@@ -528,6 +667,15 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 				debug("Blocksize ack: %s, %d\n",
 					(char *)pkt+i+8, TftpBlkSize);
 			}
+			if (strcmp((char *)pkt+i, "windowsize") == 0) {
+				TftpWindowSize = (unsigned short)
+					simple_strtoul((char *)pkt+i+11, NULL,
+						       10);
+				if (!TftpWindowSize)
+					TftpWindowSize = 1;
+				debug("Windowsize ack: %s, %d\n",
+					(char *)pkt+i+11, TftpWindowSize);
+			}
 #ifdef CONFIG_TFTP_TSIZE
 			if (strcmp((char *)pkt+i, "tsize") == 0) {
 				TftpTsize = simple_strtoul((char *)pkt+i+6,
@@ -539,6 +687,9 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 		}
 #ifdef CONFIG_MCAST_TFTP
 		parse_multicast_oack((char *)pkt, len-1);
+		/* multicast clients acknowledge every block */
+		if (Multicast)
+			TftpWindowSize = 1;
 		if ((Multicast) && (!MasterClient))
 			TftpState = STATE_DATA;	/* passive.. */
 		else
@@ -556,6 +707,13 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 		if (len < 2)
 			return;
 		len -= 2;
+
+		if (TftpState == STATE_DATA && TftpWindowSize > 1 &&
+		    ntohs(*(__be16 *)pkt) != (ushort)(TftpLastBlock + 1)) {
+			tftp_out_of_order(ntohs(*(__be16 *)pkt));
+			break;
+		}
+
 		TftpBlock = ntohs(*(__be16 *)pkt);
 
 		update_block_number();
@@ -600,7 +758,8 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 
 		/*
 		 *	Acknowledge the block just received, which will prompt
-		 *	the remote for the next one.
+		 *	the remote for the next one. With a window only its last
+		 *	block and the end of the file are acknowledged.
 		 */
 #ifdef CONFIG_MCAST_TFTP
 		/* if I am the MasterClient, actively calculate what my next
@@ -627,7 +786,11 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 			}
 		}
 #endif
-		TftpSend();
+		if (TftpWindowSize == 1 || TftpBlock == TftpNextAck ||
+		    len < TftpBlkSize) {
+			TftpNextAck = (ushort)(TftpBlock + TftpWindowSize);
+			TftpSend();
+		}
 
 #ifdef CONFIG_MCAST_TFTP
 		if (Multicast) {
@@ -679,6 +842,8 @@ TftpTimeout(void)
 	} else {
 		puts("T ");
 		NetSetTimeout(TftpTimeoutMSecs, TftpTimeout);
+		/* the server restarts its window after our ACK */
+		TftpNextAck = (ushort)(TftpBlock + TftpWindowSize);
 		if (TftpState != STATE_RECV_WRQ)
 			TftpSend();
 	}
@@ -701,6 +866,17 @@ void TftpStart(enum proto_t protocol)
 	if (ep != NULL)
 		TftpTimeoutMSecs = simple_strtol(ep, NULL, 10);
 
+	ep = getenv("tftpwindowsize");
+	if (ep != NULL) {
+		long windowsize = simple_strtol(ep, NULL, 10);
+
+		if (windowsize < 1 || windowsize > 65535) {
+			printf("TFTP windowsize (%s) invalid, using 1\n", ep);
+			windowsize = 1;
+		}
+		TftpWindowSizeOption = windowsize;
+	}
+
 	if (TftpTimeoutMSecs < 1000) {
 		printf("TFTP timeout (%ld ms) too low, "
 			"set minimum = 1000 ms\n",
@@ -708,8 +884,8 @@ void TftpStart(enum proto_t protocol)
 		TftpTimeoutMSecs = 1000;
 	}
 
-	debug("TFTP blocksize = %i, timeout = %ld ms\n",
-		TftpBlkSizeOption, TftpTimeoutMSecs);
+	debug("TFTP blocksize = %i, windowsize = %i, timeout = %ld ms\n",
+		TftpBlkSizeOption, TftpWindowSizeOption, TftpTimeoutMSecs);
 
 	TftpRemoteIP = NetServerIP;
 	if (BootFile[0] == '\0') {
@@ -807,8 +983,9 @@ void TftpStart(enum proto_t protocol)
 
 	/* zero out server ether in case the server ip has changed */
 	memset(NetServerEther, 0, 6);
-	/* Revert TftpBlkSize to dflt */
+	/* Revert TftpBlkSize and TftpWindowSize to dflt */
 	TftpBlkSize = TFTP_BLOCK_SIZE;
+	TftpWindowSize = 1;
 #ifdef CONFIG_MCAST_TFTP
 	mcast_cleanup();
 #endif
@@ -837,8 +1014,9 @@ TftpStartServer(void)
 	TftpTimeoutMSecs = TIMEOUT;
 	NetSetTimeout(TftpTimeoutMSecs, TftpTimeout);
 
-	/* Revert TftpBlkSize to dflt */
+	/* Revert TftpBlkSize and TftpWindowSize to dflt */
 	TftpBlkSize = TFTP_BLOCK_SIZE;
+	TftpWindowSize = 1;
 	TftpBlock = 0;
 	TftpOurPort = WELL_KNOWN_PORT;
 
@@ -0,0 +1,109 @@
+/*
+ * Host-side check and benchmark of the lib/crc32.c slicing variants
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * Build and run through test-crc32.sh, which links lib/crc32.c once for
+ * every supported CONFIG_CRC32_SLICES value.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_SIZE	(1024 * 1024)
+#define BENCH_ROUNDS	64
+#define CHECK_ROUNDS	20000
+
+typedef uint32_t (*crc_fn)(uint32_t, const unsigned char *, unsigned int);
+
+uint32_t crc32_no_comp_1(uint32_t, const unsigned char *, unsigned int);
+uint32_t crc32_no_comp_4(uint32_t, const unsigned char *, unsigned int);
+uint32_t crc32_no_comp_8(uint32_t, const unsigned char *, unsigned int);
+
+static const struct {
+	const char *name;
+	crc_fn fn;
+} variants[] = {
+	{ "byte table (1 KiB)", crc32_no_comp_1 },
+	{ "slice-by-4 (4 KiB)", crc32_no_comp_4 },
+	{ "slice-by-8 (8 KiB)", crc32_no_comp_8 },
+};
+
+#define NUM_VARIANTS	(sizeof(variants) / sizeof(variants[0]))
+
+/* Bit-wise reference, independent of any table */
+static uint32_t crc32_ref(uint32_t crc, const unsigned char *p,
+			  unsigned int len)
+{
+	int i;
+
+	while (len--) {
+		crc ^= *p++;
+		for (i = 0; i < 8; i++)
+			crc = (crc >> 1) ^ ((crc & 1) ? 0xedb88320 : 0);
+	}
+
+	return crc;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(void)
+{
+	unsigned char *buf;
+	unsigned int i, v, off, len;
+	uint32_t seed, ref, crc;
+	double start, secs;
+	int err = 0;
+
+	buf = malloc(BENCH_SIZE + 16);
+	if (!buf)
+		return 1;
+
+	srand(1);
+	for (i = 0; i < BENCH_SIZE + 16; i++)
+		buf[i] = rand();
+
+	/* all alignments, short and long lengths, chained seeds */
+	for (i = 0; i < CHECK_ROUNDS && !err; i++) {
+		off = rand() & 15;
+		len = (i & 1) ? rand() % 64 : rand() % 4096;
+		seed = (i & 2) ? rand() : 0;
+		ref = crc32_ref(seed, buf + off, len);
+
+		for (v = 0; v < NUM_VARIANTS; v++) {
+			crc = variants[v].fn(seed, buf + off, len);
+			if (crc != ref) {
+				printf("%s: off %u len %u: %08x != %08x\n",
+				       variants[v].name, off, len, crc, ref);
+				err = 1;
+			}
+		}
+	}
+	printf("check: %s\n", err ? "FAILED" : "ok");
+
+	for (v = 0; v < NUM_VARIANTS; v++) {
+		crc = 0;
+		start = now();
+		for (i = 0; i < BENCH_ROUNDS; i++)
+			crc = variants[v].fn(crc, buf, BENCH_SIZE);
+		secs = now() - start;
+
+		printf("%-20s %8.1f MB/s (crc %08x)\n", variants[v].name,
+		       BENCH_ROUNDS * (BENCH_SIZE / 1e6) / secs, crc);
+	}
+
+	free(buf);
+
+	return err;
+}
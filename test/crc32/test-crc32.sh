@@ -0,0 +1,32 @@
+#!/bin/sh
+#
+# Check and benchmark the lib/crc32.c slicing variants on the host
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+# To run this from the top of the source tree:
+#
+# ./test/crc32/test-crc32.sh
+
+HOSTCC=${HOSTCC:-cc}
+OUT=$(mktemp -d)
+OBJS=
+
+cleanup()
+{
+	rm -rf ${OUT}
+}
+trap cleanup EXIT
+
+for slices in 1 4 8; do
+	${HOSTCC} -O2 -Wall -DUSE_HOSTCC -DCONFIG_CRC32_SLICES=${slices} \
+		-Dcrc32_no_comp=crc32_no_comp_${slices} \
+		-Dcrc32=crc32_${slices} -Dcrc32_wd=crc32_wd_${slices} \
+		-Dcrc32_wd_buf=crc32_wd_buf_${slices} \
+		-Iinclude -c lib/crc32.c -o ${OUT}/crc32_${slices}.o || exit 1
+	OBJS="${OBJS} ${OUT}/crc32_${slices}.o"
+done
+
+${HOSTCC} -O2 -Wall -o ${OUT}/crc32_bench test/crc32/crc32_bench.c ${OBJS} \
+	|| exit 1
+${OUT}/crc32_bench
@@ -0,0 +1,116 @@
+/*
+ * Host-side check of the fs/ext4 read path
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * Build and run through test-ext4.sh, which links the fs/ext4 objects of
+ * a sandbox build. Every file is loaded from the image as ext4load does
+ * and compared with its original.
+ */
+
+#include <common.h>
+#include <part.h>
+#include <ext4fs.h>
+
+/* the U-Boot headers are used, so declare what is needed from libc */
+extern void *fopen(const char *path, const char *mode);
+extern unsigned long fread(void *ptr, unsigned long size, unsigned long n,
+			   void *stream);
+extern int fclose(void *stream);
+
+#define IMAGE_SIZE	(32 << 20)
+#define FILE_SIZE	(8 << 20)
+
+static unsigned char image[IMAGE_SIZE];
+static unsigned char out[FILE_SIZE], ref[FILE_SIZE];
+static block_dev_desc_t dev;
+static disk_partition_t info = {
+	.start = 0,
+	.size = IMAGE_SIZE / 512,
+	.blksz = 512,
+};
+
+static unsigned long image_read(int dev, lbaint_t start, lbaint_t blkcnt,
+				void *buffer)
+{
+	if ((start + blkcnt) * 512 > IMAGE_SIZE)
+		return 0;
+
+	memcpy(buffer, image + start * 512, blkcnt * 512);
+
+	return blkcnt;
+}
+
+static long load(const char *name, void *buf, unsigned long size)
+{
+	void *f = fopen(name, "rb");
+	long len;
+
+	if (!f)
+		return -1;
+
+	len = fread(buf, 1, size, f);
+	fclose(f);
+
+	return len;
+}
+
+static int check(const char *path, const char *orig)
+{
+	long len, ref_len;
+	int size;
+
+	ref_len = load(orig, ref, sizeof(ref));
+	if (ref_len < 0) {
+		printf("%s: cannot read %s\n", path, orig);
+		return 1;
+	}
+
+	ext4fs_set_blk_dev(&dev, &info);
+	if (!ext4fs_mount(info.size)) {
+		printf("%s: mount failed\n", path);
+		return 1;
+	}
+
+	size = ext4fs_open(path);
+	memset(out, 0xa5, sizeof(out));
+	len = size < 0 ? -1 : ext4fs_read((char *)out, size);
+	ext4fs_close();
+
+	if (len != ref_len || memcmp(out, ref, len)) {
+		printf("%s: FAILED, read %ld of %ld bytes\n", path, len,
+		       ref_len);
+		return 1;
+	}
+
+	printf("%s: ok, %ld bytes\n", path, len);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int i, err = 0;
+
+	if (argc < 2 || argc % 2) {
+		printf("usage: %s <image> [<path> <original>]...\n", argv[0]);
+		return 1;
+	}
+
+	if (load(argv[1], image, sizeof(image)) <= 0) {
+		printf("cannot read %s\n", argv[1]);
+		return 1;
+	}
+
+	dev.blksz = 512;
+	dev.log2blksz = 9;
+	dev.lba = info.size;
+	dev.block_read = image_read;
+
+	for (i = 2; i < argc; i += 2)
+		err |= check(argv[i], argv[i + 1]);
+
+	printf(err ? "FAILED\n" : "PASSED\n");
+
+	return err;
+}
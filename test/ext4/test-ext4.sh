@@ -0,0 +1,94 @@
+#!/bin/sh
+#
+# Check the fs/ext4 read path on the host with files that have holes and
+# extent trees of depth 0 and 1
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+# Needs mkfs.ext4 with -d support and the fs/ext4 objects of a sandbox
+# build. To run this from the top of the source tree:
+#
+# make O=sandbox sandbox_config && make O=sandbox
+# ./test/ext4/test-ext4.sh sandbox
+
+HOSTCC=${HOSTCC:-cc}
+OBJ=${1:-sandbox}
+OUT=$(mktemp -d)
+SRC=${OUT}/src
+
+cleanup()
+{
+	rm -rf ${OUT}
+}
+trap cleanup EXIT
+
+fail()
+{
+	echo "Test failed: $1"
+	exit 1
+}
+
+# write 4 KiB of random data at block $2 of file $1
+put_block()
+{
+	dd if=/dev/urandom of=$1 bs=4096 seek=$2 count=1 conv=notrunc \
+		2>/dev/null
+}
+
+# extent tree depth of file $1 in the image
+depth()
+{
+	debugfs -R "stat $1" ${OUT}/ext4.img 2>/dev/null | \
+		grep -q "(ETB0)" && echo 1 || echo 0
+}
+
+[ -f ${OBJ}/fs/ext4/ext4_common.o ] || \
+	fail "no sandbox objects in ${OBJ}, see the top of $0"
+
+mkdir -p ${SRC}/dir
+
+# one large file, few extents
+dd if=/dev/urandom of=${SRC}/big bs=1024 count=6144 2>/dev/null
+echo "tail" >> ${SRC}/big
+
+# every other block, far more extents than fit into the inode
+for i in $(seq 0 99); do
+	put_block ${SRC}/sparse $((i * 2))
+done
+truncate -s +10000 ${SRC}/sparse
+
+# leading hole in front of a single extent
+put_block ${SRC}/dir/hole0 25
+put_block ${SRC}/dir/hole0 26
+
+# leading hole in front of an extent tree of depth 1
+for i in $(seq 0 39); do
+	put_block ${SRC}/dir/hole1 $((16 + i * 2))
+done
+
+echo "hello world" > ${SRC}/dir/small
+
+mkfs.ext4 -q -F -b 4096 -O ^64bit,^metadata_csum -d ${SRC} \
+	${OUT}/ext4.img 32M >/dev/null || fail "mkfs.ext4"
+
+[ $(depth /sparse) = 1 ] || fail "/sparse has no index block"
+[ $(depth /dir/hole0) = 0 ] || fail "/dir/hole0 has an index block"
+[ $(depth /dir/hole1) = 1 ] || fail "/dir/hole1 has no index block"
+
+# same flags as a sandbox build
+${HOSTCC} -Os -Wall -D__KERNEL__ -DCONFIG_SYS_TEXT_BASE=0 \
+	-DCONFIG_SANDBOX -D__SANDBOX__ -DCONFIG_ARCH_MAP_SYSMEM \
+	-DCONFIG_SYS_GENERIC_BOARD -fno-builtin -ffreestanding \
+	-nostdinc -isystem $(${HOSTCC} -print-file-name=include) \
+	-I${OBJ}/include -Iinclude -Iarch/sandbox/include \
+	-c test/ext4/ext4_test.c -o ${OUT}/ext4_test.o || exit 1
+${HOSTCC} -no-pie -o ${OUT}/ext4_test ${OUT}/ext4_test.o \
+	$(ls ${OBJ}/fs/ext4/*.o | grep -v built-in) \
+	${OBJ}/lib/ctype.o ${OBJ}/lib/div64.o || exit 1
+
+${OUT}/ext4_test ${OUT}/ext4.img \
+	/big ${SRC}/big \
+	/sparse ${SRC}/sparse \
+	/dir/hole0 ${SRC}/dir/hole0 \
+	/dir/hole1 ${SRC}/dir/hole1 \
+	/dir/small ${SRC}/dir/small
@@ -0,0 +1,277 @@
+/*
+ * Host-side check and benchmark of the lib/lzma decoder variants
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * Build and run through test-lzma.sh, which links lib/lzma/LzmaDec.c with
+ * and without CONFIG_LZMA_SPEED_OPT.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "LzmaDec.h"
+
+#define BENCH_MIN_TIME	1.0	/* seconds per variant and file */
+#define STREAM_CHUNK	4096	/* input chunk size of the streaming check */
+#define UNKNOWN_OUT_MAX	(64 * 1024 * 1024)
+
+#define UIMAGE_MAGIC	0x27051956
+#define UIMAGE_HDR_SIZE	64
+#define UIMAGE_COMP	31
+#define UIMAGE_LZMA	3
+
+#define LZMA_HDR_SIZE	(LZMA_PROPS_SIZE + 8)
+
+#define DECLARE_VARIANT(v)						\
+SRes LzmaDecode_##v(Byte *dest, SizeT *destLen, const Byte *src,	\
+		    SizeT *srcLen, const Byte *propData,		\
+		    unsigned propSize, ELzmaFinishMode finishMode,	\
+		    ELzmaStatus *status, ISzAlloc *alloc);		\
+SRes LzmaDec_AllocateProbs_##v(CLzmaDec *p, const Byte *props,		\
+			       unsigned propsSize, ISzAlloc *alloc);	\
+void LzmaDec_Init_##v(CLzmaDec *p);					\
+SRes LzmaDec_DecodeToDic_##v(CLzmaDec *p, SizeT dicLimit,		\
+			     const Byte *src, SizeT *srcLen,		\
+			     ELzmaFinishMode finishMode,		\
+			     ELzmaStatus *status);			\
+void LzmaDec_FreeProbs_##v(CLzmaDec *p, ISzAlloc *alloc);
+
+DECLARE_VARIANT(size)
+DECLARE_VARIANT(speed)
+
+#define VARIANT(v, name) {						\
+	name, LzmaDecode_##v, LzmaDec_AllocateProbs_##v, LzmaDec_Init_##v, \
+	LzmaDec_DecodeToDic_##v, LzmaDec_FreeProbs_##v }
+
+static const struct {
+	const char *name;
+	SRes (*decode)(Byte *, SizeT *, const Byte *, SizeT *, const Byte *,
+		       unsigned, ELzmaFinishMode, ELzmaStatus *, ISzAlloc *);
+	SRes (*alloc_probs)(CLzmaDec *, const Byte *, unsigned, ISzAlloc *);
+	void (*init)(CLzmaDec *);
+	SRes (*decode_to_dic)(CLzmaDec *, SizeT, const Byte *, SizeT *,
+			      ELzmaFinishMode, ELzmaStatus *);
+	void (*free_probs)(CLzmaDec *, ISzAlloc *);
+} variants[] = {
+	VARIANT(size, "stock"),
+	VARIANT(speed, "CONFIG_LZMA_SPEED_OPT"),
+};
+
+#define NUM_VARIANTS	(sizeof(variants) / sizeof(variants[0]))
+
+static void *bench_alloc(void *p, size_t size) { return malloc(size); }
+static void bench_free(void *p, void *address) { free(address); }
+static ISzAlloc g_alloc = { bench_alloc, bench_free };
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned char *read_file(const char *name, size_t *len)
+{
+	unsigned char *buf;
+	FILE *f;
+	long size;
+
+	f = fopen(name, "rb");
+	if (!f)
+		return NULL;
+
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	buf = malloc(size ? size : 1);
+	if (buf && fread(buf, 1, size, f) != (size_t)size) {
+		free(buf);
+		buf = NULL;
+	}
+	fclose(f);
+	*len = size;
+
+	return buf;
+}
+
+/* The way bootm calls the decoder, see lzmaBuffToBuffDecompress() */
+static SRes decode(unsigned v, const unsigned char *in, size_t in_len,
+		   unsigned char *out, size_t out_max, size_t *out_len)
+{
+	ELzmaStatus status;
+	SizeT dst_len = out_max;
+	SizeT src_len = in_len - LZMA_HDR_SIZE;
+	SRes res;
+
+	res = variants[v].decode(out, &dst_len, in + LZMA_HDR_SIZE, &src_len,
+				 in, LZMA_PROPS_SIZE, LZMA_FINISH_END,
+				 &status, &g_alloc);
+	*out_len = dst_len;
+
+	/* unknown size: stopping at the end mark is fine */
+	if (res == SZ_ERROR_DATA && status == LZMA_STATUS_FINISHED_WITH_MARK)
+		res = SZ_OK;
+
+	return res;
+}
+
+/* The way the SPL calls the decoder, input arrives in chunks */
+static SRes decode_stream(unsigned v, const unsigned char *in, size_t in_len,
+			  unsigned char *out, size_t out_max, size_t *out_len)
+{
+	const unsigned char *rp = in + LZMA_HDR_SIZE;
+	const unsigned char *end = in + in_len;
+	ELzmaStatus status;
+	CLzmaDec dec;
+	SizeT len;
+	SRes res;
+
+	LzmaDec_Construct(&dec);
+	res = variants[v].alloc_probs(&dec, in, LZMA_PROPS_SIZE, &g_alloc);
+	if (res != SZ_OK)
+		return res;
+
+	dec.dic = out;
+	dec.dicBufSize = out_max;
+	variants[v].init(&dec);
+
+	do {
+		len = end - rp < STREAM_CHUNK ? end - rp : STREAM_CHUNK;
+		res = variants[v].decode_to_dic(&dec, out_max, rp, &len,
+						LZMA_FINISH_ANY, &status);
+		rp += len;
+	} while (res == SZ_OK && rp < end && dec.dicPos < out_max &&
+		 status != LZMA_STATUS_FINISHED_WITH_MARK);
+
+	*out_len = dec.dicPos;
+	variants[v].free_probs(&dec, &g_alloc);
+
+	return res;
+}
+
+static int bench_file(const char *name)
+{
+	unsigned char *file, *in, *ref, *out;
+	size_t file_len, in_len, out_max, ref_len, out_len;
+	uint64_t size = 0;
+	double start, secs, best[NUM_VARIANTS];
+	unsigned v, i, rounds;
+	int err = 0;
+
+	file = read_file(name, &file_len);
+	if (!file) {
+		printf("%s: cannot read\n", name);
+		return 1;
+	}
+
+	in = file;
+	in_len = file_len;
+	if (in_len >= UIMAGE_HDR_SIZE &&
+	    (in[0] << 24 | in[1] << 16 | in[2] << 8 | in[3]) == UIMAGE_MAGIC) {
+		if (in[UIMAGE_COMP] != UIMAGE_LZMA) {
+			printf("%s: not an LZMA compressed uImage\n", name);
+			free(file);
+			return 1;
+		}
+		in += UIMAGE_HDR_SIZE;
+		in_len -= UIMAGE_HDR_SIZE;
+	}
+
+	if (in_len < LZMA_HDR_SIZE) {
+		printf("%s: too short\n", name);
+		free(file);
+		return 1;
+	}
+
+	for (i = 0; i < 8; i++)
+		size |= (uint64_t)in[LZMA_PROPS_SIZE + i] << (i * 8);
+	out_max = (size == (uint64_t)-1) ? UNKNOWN_OUT_MAX : size;
+
+	ref = malloc(out_max + 1);
+	out = malloc(out_max + 1);
+	if (!ref || !out) {
+		printf("%s: out of memory\n", name);
+		err = 1;
+		goto out;
+	}
+
+	/* the stock decoder is the reference */
+	if (decode(0, in, in_len, ref, out_max, &ref_len) != SZ_OK) {
+		printf("%s: decoding failed\n", name);
+		err = 1;
+		goto out;
+	}
+
+	for (v = 0; v < NUM_VARIANTS; v++) {
+		if (decode(v, in, in_len, out, out_max, &out_len) != SZ_OK ||
+		    out_len != ref_len || memcmp(out, ref, ref_len)) {
+			printf("%s: %s: output differs\n", name,
+			       variants[v].name);
+			err = 1;
+		}
+		memset(out, 0, ref_len);
+		if (decode_stream(v, in, in_len, out, out_max,
+				  &out_len) != SZ_OK ||
+		    out_len != ref_len || memcmp(out, ref, ref_len)) {
+			printf("%s: %s: streamed output differs\n", name,
+			       variants[v].name);
+			err = 1;
+		}
+	}
+	if (err)
+		goto out;
+
+	for (v = 0; v < NUM_VARIANTS; v++) {
+		best[v] = 1e9;
+		rounds = 0;
+		start = now();
+		do {
+			double t = now();
+
+			decode(v, in, in_len, out, out_max, &out_len);
+			t = now() - t;
+			if (t < best[v])
+				best[v] = t;
+			rounds++;
+		} while (now() - start < BENCH_MIN_TIME || rounds < 3);
+	}
+
+	printf("%s: %zu -> %zu bytes\n", name, in_len, ref_len);
+	for (v = 0; v < NUM_VARIANTS; v++) {
+		secs = best[v];
+		printf("  %-22s %8.1f MB/s  %7.1f ms  x%.2f\n",
+		       variants[v].name, ref_len / 1e6 / secs, secs * 1e3,
+		       best[0] / secs);
+	}
+
+out:
+	free(out);
+	free(ref);
+	free(file);
+
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	int i, err = 0;
+
+	if (argc < 2) {
+		printf("usage: %s <lzma file or LZMA uImage>...\n", argv[0]);
+		return 1;
+	}
+
+	for (i = 1; i < argc; i++)
+		err |= bench_file(argv[i]);
+
+	printf("check: %s\n", err ? "FAILED" : "ok");
+
+	return err;
+}
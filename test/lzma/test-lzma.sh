@@ -0,0 +1,48 @@
+#!/bin/sh
+#
+# Check and benchmark the lib/lzma decoder variants on the host
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+# To run this from the top of the source tree on some kernel images
+# (LZMA compressed uImages as built by OpenWrt, or raw .lzma files):
+#
+# ./test/lzma/test-lzma.sh bin/lantiq/openwrt-lantiq-*-uImage
+
+HOSTCC=${HOSTCC:-cc}
+OUT=$(mktemp -d)
+OBJS=
+SYMS="LzmaDecode LzmaDec_AllocateProbs LzmaDec_Allocate LzmaDec_Init
+	LzmaDec_InitDicAndState LzmaDec_DecodeToDic LzmaDec_DecodeToBuf
+	LzmaDec_FreeProbs LzmaDec_Free LzmaProps_Decode"
+
+cleanup()
+{
+	rm -rf ${OUT}
+}
+trap cleanup EXIT
+
+if [ $# -eq 0 ]; then
+	echo "usage: $0 <lzma file or LZMA uImage>..."
+	exit 1
+fi
+
+# same flags as lib/lzma/Makefile, the stock decoder is built for size
+for variant in size speed; do
+	OPT=-Os
+	DEFS=
+	for sym in ${SYMS}; do
+		DEFS="${DEFS} -D${sym}=${sym}_${variant}"
+	done
+	if [ ${variant} = speed ]; then
+		OPT=-O2
+		DEFS="${DEFS} -DCONFIG_LZMA_SPEED_OPT"
+	fi
+	${HOSTCC} ${OPT} -Wall -DUSE_HOSTCC -D_LZMA_PROB32 ${DEFS} \
+		-c lib/lzma/LzmaDec.c -o ${OUT}/LzmaDec_${variant}.o || exit 1
+	OBJS="${OBJS} ${OUT}/LzmaDec_${variant}.o"
+done
+
+${HOSTCC} -O2 -Wall -D_LZMA_PROB32 -Ilib/lzma -o ${OUT}/lzma_bench \
+	test/lzma/lzma_bench.c ${OBJS} || exit 1
+${OUT}/lzma_bench "$@"
@@ -0,0 +1,147 @@
+/*
+ * Host test for the C string functions in arch/mips/lib/string.c
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define USE_HOSTCC
+#define CONFIG_USE_ARCH_MEMCPY
+#define CONFIG_USE_ARCH_MEMSET
+
+#define memcpy		mips_memcpy
+#define memmove		mips_memmove
+#define memset		mips_memset
+#define mips_prefetch	test_prefetch
+
+static void test_prefetch(const void *p);
+
+#include "../../arch/mips/lib/string.c"
+
+#undef memcpy
+#undef memmove
+#undef memset
+
+#define LINE_SIZE	32
+#define MAX_LEN		300
+#define GUARD		64
+#define BUF_SIZE	(GUARD + MAX_LEN + 2 * GUARD)
+
+static const unsigned char *pref_start, *pref_end;
+static int failed;
+
+/* every prefetched cache line must be part of the source */
+static void test_prefetch(const void *p)
+{
+	unsigned long line = (unsigned long)p & ~(LINE_SIZE - 1UL);
+
+	if (line < (unsigned long)pref_start ||
+	    line + LINE_SIZE > (unsigned long)pref_end) {
+		printf("prefetch of %p outside source %p..%p\n", p,
+		       pref_start, pref_end);
+		failed = 1;
+	}
+}
+
+static void fill(unsigned char *buf, size_t len, unsigned int seed)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		buf[i] = (unsigned char)(seed + i * 7 + (i >> 8));
+}
+
+static void check(const char *name, const unsigned char *got,
+		  const unsigned char *want, size_t len, size_t a, size_t b)
+{
+	if (memcmp(got, want, len)) {
+		printf("%s: mismatch, len %zu, offsets %zu/%zu\n", name,
+		       len - 2 * GUARD, a, b);
+		failed = 1;
+	}
+}
+
+static void test_memcpy(void)
+{
+	static unsigned char src[BUF_SIZE] __attribute__((aligned(LINE_SIZE)));
+	static unsigned char dst[BUF_SIZE] __attribute__((aligned(LINE_SIZE)));
+	static unsigned char ref[BUF_SIZE];
+	size_t len, so, doff;
+
+	fill(src, sizeof(src), 1);
+
+	for (len = 0; len <= MAX_LEN; len++) {
+		for (so = 0; so < LINE_SIZE; so++) {
+			for (doff = 0; doff < 8; doff++) {
+				const unsigned char *s = src + GUARD + so;
+				unsigned char *d = dst + GUARD + doff;
+
+				fill(dst, sizeof(dst), 99);
+				memcpy(ref, dst, sizeof(ref));
+				memcpy(ref + GUARD + doff, s, len);
+
+				pref_start = s;
+				pref_end = s + len;
+				if (mips_memcpy(d, s, len) != d) {
+					printf("memcpy: wrong return value\n");
+					failed = 1;
+				}
+				check("memcpy", dst, ref, sizeof(dst), so, doff);
+			}
+		}
+	}
+}
+
+static void test_memmove(void)
+{
+	static unsigned char buf[BUF_SIZE];
+	static unsigned char ref[BUF_SIZE];
+	size_t len, so, doff;
+
+	for (len = 0; len <= MAX_LEN / 2; len++) {
+		for (so = 0; so < 2 * GUARD; so++) {
+			for (doff = 0; doff < 2 * GUARD; doff++) {
+				fill(buf, sizeof(buf), 5);
+				memcpy(ref, buf, sizeof(ref));
+				memmove(ref + doff, ref + so, len);
+
+				pref_start = buf + so;
+				pref_end = buf + so + len;
+				mips_memmove(buf + doff, buf + so, len);
+				check("memmove", buf, ref, sizeof(buf), so, doff);
+			}
+		}
+	}
+}
+
+static void test_memset(void)
+{
+	static unsigned char buf[BUF_SIZE];
+	static unsigned char ref[BUF_SIZE];
+	size_t len, off;
+
+	for (len = 0; len <= MAX_LEN; len++) {
+		for (off = 0; off < 8; off++) {
+			fill(buf, sizeof(buf), 3);
+			memcpy(ref, buf, sizeof(ref));
+			memset(ref + GUARD + off, 0xa5, len);
+
+			mips_memset(buf + GUARD + off, 0x1a5, len);
+			check("memset", buf, ref, sizeof(buf), off, 0);
+		}
+	}
+}
+
+int main(void)
+{
+	test_memcpy();
+	test_memmove();
+	test_memset();
+
+	printf("%s\n", failed ? "FAILED" : "OK");
+
+	return failed;
+}
@@ -0,0 +1,28 @@
+#!/bin/sh
+#
+# Check the C string functions in arch/mips/lib/string.c on the host
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+# To run this from the top of the source tree:
+#
+# ./test/mips_string/test-mips-string.sh
+
+HOSTCC=${HOSTCC:-cc}
+OUT=$(mktemp -d)
+
+cleanup()
+{
+	rm -rf ${OUT}
+}
+trap cleanup EXIT
+
+# same flags as arch/mips/lib/Makefile, keep loops from becoming calls
+for opt in -O0 -O2 -Os; do
+	${HOSTCC} ${opt} -Wall -U_FORTIFY_SOURCE \
+		-fno-tree-loop-distribute-patterns \
+		-o ${OUT}/mips_string_test \
+		test/mips_string/mips_string_test.c || exit 1
+	echo -n "${opt}: "
+	${OUT}/mips_string_test || exit 1
+done
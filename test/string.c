@@ -0,0 +1,238 @@
+/*
+ * Check and benchmark memcpy, memmove and memset, see 'test_string'
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <div64.h>
+#ifdef CONFIG_MIPS
+#include <asm/mipsregs.h>
+#endif
+
+/* Covers every head/tail combination of a 32 byte unrolled block */
+#define TEST_MAX_LEN		300
+#define TEST_MAX_ALIGN		8
+#define TEST_GUARD		64
+#define TEST_BUFFER_SIZE	(TEST_MAX_LEN + 2 * TEST_GUARD + TEST_MAX_ALIGN)
+
+#define BENCH_DEFAULT_SIZE	(64 * 1024)
+#define BENCH_DEFAULT_COUNT	16
+
+static u32 test_seed;
+
+static void test_fill(u8 *buf, size_t len)
+{
+	while (len--) {
+		test_seed = test_seed * 1103515245 + 12345;
+		*buf++ = test_seed >> 16;
+	}
+}
+
+static void ref_move(u8 *dst, const u8 *src, size_t len)
+{
+	size_t i;
+
+	if (dst <= src) {
+		for (i = 0; i < len; i++)
+			dst[i] = src[i];
+	} else {
+		for (i = len; i > 0; i--)
+			dst[i - 1] = src[i - 1];
+	}
+}
+
+static void ref_set(u8 *dst, int c, size_t len)
+{
+	while (len--)
+		*dst++ = c;
+}
+
+static int test_compare(const char *name, const u8 *buf, const u8 *ref,
+			int salign, int dalign, size_t len)
+{
+	int i;
+
+	for (i = 0; i < TEST_BUFFER_SIZE; i++) {
+		if (buf[i] != ref[i]) {
+			printf(" %s: src +%d dst +%d len %u: mismatch at %d\n",
+			       name, salign, dalign, (unsigned)len, i);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Check memcpy(), memmove() and memset() against a byte-wise reference
+ * for all source/destination alignments and lengths up to TEST_MAX_LEN,
+ * including overlapping moves in both directions. Bytes outside the
+ * destination must stay untouched.
+ */
+static int test_string_functions(void)
+{
+	u8 *src, *buf, *ref;
+	u8 *d, *s;
+	int salign, dalign, err = 0;
+	size_t len;
+
+	src = malloc(TEST_BUFFER_SIZE);
+	buf = malloc(TEST_BUFFER_SIZE);
+	ref = malloc(TEST_BUFFER_SIZE);
+	if (!src || !buf || !ref) {
+		puts(" out of memory\n");
+		err = 1;
+		goto out;
+	}
+
+	for (salign = 0; salign < TEST_MAX_ALIGN && !err; salign++) {
+		for (dalign = 0; dalign < TEST_MAX_ALIGN && !err; dalign++) {
+			for (len = 0; len <= TEST_MAX_LEN && !err; len++) {
+				test_fill(src, TEST_BUFFER_SIZE);
+				test_fill(buf, TEST_BUFFER_SIZE);
+				ref_move(ref, buf, TEST_BUFFER_SIZE);
+
+				d = buf + TEST_GUARD + dalign;
+				s = src + TEST_GUARD + salign;
+				ref_move(ref + (d - buf), s, len);
+				if (memcpy(d, s, len) != d)
+					err++;
+				err += test_compare("memcpy", buf, ref,
+						    salign, dalign, len);
+
+				/* overlapping, destination below source */
+				d = buf + TEST_GUARD / 2 + dalign;
+				s = buf + TEST_GUARD + salign;
+				ref_move(ref + (d - buf), ref + (s - buf), len);
+				if (memmove(d, s, len) != d)
+					err++;
+				err += test_compare("memmove down", buf, ref,
+						    salign, dalign, len);
+
+				/* overlapping, destination above source */
+				d = buf + TEST_GUARD + dalign;
+				s = buf + TEST_GUARD / 2 + salign;
+				ref_move(ref + (d - buf), ref + (s - buf), len);
+				if (memmove(d, s, len) != d)
+					err++;
+				err += test_compare("memmove up", buf, ref,
+						    salign, dalign, len);
+
+				d = buf + TEST_GUARD + dalign;
+				ref_set(ref + (d - buf), salign * 0x25, len);
+				if (memset(d, salign * 0x25, len) != d)
+					err++;
+				err += test_compare("memset", buf, ref,
+						    salign, dalign, len);
+			}
+		}
+	}
+
+out:
+	free(ref);
+	free(buf);
+	free(src);
+
+	return err;
+}
+
+static inline ulong bench_ticks(void)
+{
+#ifdef CONFIG_MIPS
+	/* CP0 count runs at CONFIG_SYS_MIPS_TIMER_FREQ */
+	return read_c0_count();
+#else
+	return get_ticks();
+#endif
+}
+
+static void bench_report(const char *name, ulong ticks, size_t size,
+			 ulong count)
+{
+	unsigned long long total = ticks;
+
+	/* ticks per KiB, averaged over all iterations */
+	total *= 1024;
+	do_div(total, size * count);
+
+	printf(" %-18s %10lu ticks, %6llu ticks/KiB\n", name, ticks, total);
+}
+
+static int bench_string_functions(size_t size, ulong count)
+{
+	u8 *src, *dst;
+	ulong i, start;
+
+	src = malloc(size + 8);
+	dst = malloc(size + 8);
+	if (!src || !dst) {
+		puts(" out of memory\n");
+		free(src);
+		free(dst);
+		return 1;
+	}
+
+	test_fill(src, size + 8);
+	printf("%u bytes x %lu\n", (unsigned)size, count);
+
+	start = bench_ticks();
+	for (i = 0; i < count; i++)
+		memcpy(dst, src, size);
+	bench_report("memcpy aligned", bench_ticks() - start, size, count);
+
+	start = bench_ticks();
+	for (i = 0; i < count; i++)
+		memcpy(dst, src + 1, size);
+	bench_report("memcpy unaligned", bench_ticks() - start, size, count);
+
+	start = bench_ticks();
+	for (i = 0; i < count; i++)
+		memmove(dst + 4, dst, size);
+	bench_report("memmove overlap", bench_ticks() - start, size, count);
+
+	start = bench_ticks();
+	for (i = 0; i < count; i++)
+		memset(dst, i, size);
+	bench_report("memset", bench_ticks() - start, size, count);
+
+	free(dst);
+	free(src);
+
+	return 0;
+}
+
+static int do_test_string(cmd_tbl_t *cmdtp, int flag, int argc,
+			  char * const argv[])
+{
+	size_t size = BENCH_DEFAULT_SIZE;
+	ulong count = BENCH_DEFAULT_COUNT;
+	int err;
+
+	if (argc > 1 && !strcmp(argv[1], "bench")) {
+		if (argc > 2)
+			size = simple_strtoul(argv[2], NULL, 16);
+		if (argc > 3)
+			count = simple_strtoul(argv[3], NULL, 10);
+		if (!size || !count)
+			return CMD_RET_USAGE;
+
+		return bench_string_functions(size, count);
+	}
+
+	test_seed = 1;
+	err = test_string_functions();
+	printf("test_string %s\n", err == 0 ? "ok" : "FAILED");
+
+	return err;
+}
+
+U_BOOT_CMD(
+	test_string,	4,	1,	do_test_string,
+	"Test and benchmark memcpy/memmove/memset",
+	"- check results for all alignments and lengths\n"
+	"test_string bench [size] [count] - measure cycles of the\n"
+	"    string functions on 'size' (hex) bytes, 'count' times"
+);